@@ -46,6 +46,16 @@ namespace POD
                    const double          tolerance);
 
 
+    /*
+     * The relative l2 difference between each row of solutions and the same
+     * row of reference (the absolute difference if the reference row is
+     * zero). This measures how far a trajectory, saved one time per row, drifts
+     * from a reference trajectory.
+     */
+    Vector<double> relative_drift(const FullMatrix<double> &solutions,
+                                  const FullMatrix<double> &reference);
+
+
     class TemporaryFileName
     {
     public:
@@ -0,0 +1,44 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute it, and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_extra_nnls_h
+#define dealii__rom_extra_nnls_h
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace extra
+  {
+    /*
+     * Approximately solve
+     *
+     * min ||matrix solution - rhs|| subject to solution >= 0
+     *
+     * with the active set method of Lawson and Hanson. Columns are added to
+     * the solution greedily, so the iteration stops early (with a sparse
+     * solution) once the residual is below tolerance*||rhs|| or once
+     * max_n_nonzeros columns are in use.
+     */
+    void nonnegative_least_squares(const FullMatrix<double> &matrix,
+                                   const Vector<double>     &rhs,
+                                   const double              tolerance,
+                                   const unsigned int        max_n_nonzeros,
+                                   Vector<double>           &solution);
+  }
+}
+#endif
@@ -0,0 +1,46 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute it, and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_extra_philox_h
+#define dealii__rom_extra_philox_h
+#include <array>
+#include <cstdint>
+
+namespace POD
+{
+  namespace extra
+  {
+    /*
+     * The Philox4x32-10 counter-based random number generator of Salmon,
+     * Moraes, Dror, and Shaw ("Parallel random numbers: as easy as 1, 2, 3",
+     * SC11). The output is a pure function of the counter and the key, so
+     * there is no state to share between threads and any entry of a stream
+     * may be computed directly.
+     */
+    typedef std::array<std::uint32_t, 4> PhiloxCounter;
+    typedef std::array<std::uint32_t, 2> PhiloxKey;
+
+    PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key);
+
+    /*
+     * Map an integer produced by philox4x32 to a double in (0, 1).
+     */
+    inline double philox_to_uniform(const std::uint32_t value)
+    {
+      return (double(value) + 0.5)/4294967296.0;
+    }
+  }
+}
+#endif
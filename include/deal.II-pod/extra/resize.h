@@ -25,13 +25,14 @@ namespace POD
   namespace extra
   {
     /*
-     * Resize a square matrix to be new_size x new_size.
+     * Resize a square matrix to be new_size x new_size. Entries in the leading
+     * block are kept and any new entries are zero.
      */
     void resize(FullMatrix<double> &matrix,
                 const unsigned int new_size);
 
     /*
-     * Resize a vector to have length new_size.
+     * Resize a vector to have length new_size. As above, new entries are zero.
      */
     void resize(Vector<double> &vector,
                 const unsigned int new_size);
@@ -0,0 +1,249 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_ns_fixed_size_h
+#define dealii__rom_ns_fixed_size_h
+#include <deal.II/base/exceptions.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ode/fixed_size.h>
+#include <deal.II-pod/ode/ode.h>
+#include <deal.II-pod/ns/ns.h>
+
+/*
+ * The numbers of POD vectors for which the fixed-size kernels below are
+ * instantiated. MACRO is called once with each size.
+ */
+#define POD_NS_FIXED_SIZES(MACRO)                                       \
+  MACRO(6) MACRO(8) MACRO(10) MACRO(12) MACRO(16) MACRO(20) MACRO(24)   \
+  MACRO(32) MACRO(40)
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    /*
+     * The same right hand side as PlainRHS (with full storage of the
+     * nonlinearity) for exactly n POD vectors. Every array has a compile-time
+     * size so the compiler is free to unroll all of the loops and keep the
+     * vectors in registers. The mass matrix is factorized (LU with partial
+     * pivoting) once in the constructor, or skipped entirely if it is the
+     * identity (see fold_inverse_mass_matrix).
+     *
+     * The operators take n^3 + 2 n^2 doubles, so objects of this class should
+     * live on the heap; the vectors passed to apply() are small enough for the
+     * stack.
+     */
+    template<int n>
+    class PlainRHSFixed : public ODE::OperatorBase<double>
+    {
+    public:
+      typedef std::array<double, n> VectorType;
+
+      PlainRHSFixed(const FullMatrix<double>              &linear_operator,
+                    const FullMatrix<double>              &mass_matrix,
+                    const std::vector<FullMatrix<double>> &nonlinear_operator,
+                    const Vector<double>                  &mean_contribution);
+
+      void apply(VectorType &dst, const VectorType &src) const;
+
+      virtual void apply(Vector<double> &dst, const Vector<double> &src) override;
+
+    private:
+      std::array<double, n*n> linear_operator;
+      std::array<double, n*n> factorized_mass_matrix;
+      std::array<int, n> pivots;
+      bool identity_mass_matrix;
+      std::array<double, n*n*n> nonlinear_operator;
+      VectorType mean_contribution;
+    };
+
+
+    template<int n>
+    using RungeKutta4Fixed = ODE::RungeKutta4Fixed<n, PlainRHSFixed<n>>;
+
+
+    /*
+     * Return true if the fixed-size kernels are instantiated for n_pod_dofs.
+     */
+    bool has_fixed_size_kernels(const unsigned int n_pod_dofs);
+
+
+    /*
+     * Set up RungeKutta4Fixed with PlainRHSFixed as its right hand side for the
+     * size of the given operators. The size must satisfy has_fixed_size_kernels.
+     */
+    std::unique_ptr<ODE::RungeKuttaBase<double>> create_fixed_size_runge_kutta_4
+    (const FullMatrix<double>              &linear_operator,
+     const FullMatrix<double>              &mass_matrix,
+     const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const Vector<double>                  &mean_contribution);
+
+
+    template<int n>
+    PlainRHSFixed<n>::PlainRHSFixed
+    (const FullMatrix<double>              &linear_operator,
+     const FullMatrix<double>              &mass_matrix,
+     const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const Vector<double>                  &mean_contribution)
+    {
+      AssertThrow(linear_operator.m() == n && linear_operator.n() == n,
+                  ExcDimensionMismatch(linear_operator.m(), n));
+      AssertThrow(mass_matrix.m() == n && mass_matrix.n() == n,
+                  ExcDimensionMismatch(mass_matrix.m(), n));
+      AssertThrow(nonlinear_operator.size() == n,
+                  ExcDimensionMismatch(nonlinear_operator.size(), n));
+      AssertThrow(mean_contribution.size() == n,
+                  ExcDimensionMismatch(mean_contribution.size(), n));
+
+      for (int i = 0; i < n; ++i)
+        {
+          AssertThrow(nonlinear_operator[i].m() == n
+                      && nonlinear_operator[i].n() == n,
+                      ExcDimensionMismatch(nonlinear_operator[i].m(), n));
+          this->mean_contribution[i] = mean_contribution[i];
+          for (int j = 0; j < n; ++j)
+            {
+              this->linear_operator[i*n + j] = linear_operator(i, j);
+              factorized_mass_matrix[i*n + j] = mass_matrix(i, j);
+              for (int k = 0; k < n; ++k)
+                {
+                  this->nonlinear_operator[(i*n + j)*n + k]
+                    = nonlinear_operator[i](j, k);
+                }
+            }
+        }
+
+      identity_mass_matrix = is_identity(mass_matrix);
+
+      // LU factorization with partial pivoting, stored in place
+      double *const lu = factorized_mass_matrix.data();
+      for (int j = 0; j < n; ++j)
+        {
+          int pivot = j;
+          for (int i = j + 1; i < n; ++i)
+            {
+              if (std::abs(lu[i*n + j]) > std::abs(lu[pivot*n + j]))
+                {
+                  pivot = i;
+                }
+            }
+          AssertThrow(lu[pivot*n + j] != 0.0,
+                      ExcMessage("The mass matrix is singular."));
+          pivots[j] = pivot;
+          if (pivot != j)
+            {
+              for (int k = 0; k < n; ++k)
+                {
+                  std::swap(lu[j*n + k], lu[pivot*n + k]);
+                }
+            }
+          for (int i = j + 1; i < n; ++i)
+            {
+              lu[i*n + j] /= lu[j*n + j];
+              for (int k = j + 1; k < n; ++k)
+                {
+                  lu[i*n + k] -= lu[i*n + j]*lu[j*n + k];
+                }
+            }
+        }
+    }
+
+
+    template<int n>
+    void PlainRHSFixed<n>::apply(VectorType &dst, const VectorType &src) const
+    {
+      for (int i = 0; i < n; ++i)
+        {
+          double value = 0.0;
+          for (int j = 0; j < n; ++j)
+            {
+              value += linear_operator[i*n + j]*src[j];
+            }
+          dst[i] = value + mean_contribution[i];
+        }
+
+      const double *row = nonlinear_operator.data();
+      for (int i = 0; i < n; ++i)
+        {
+          double value = 0.0;
+          for (int j = 0; j < n; ++j, row += n)
+            {
+              double row_value = 0.0;
+              for (int k = 0; k < n; ++k)
+                {
+                  row_value += row[k]*src[k];
+                }
+              value += src[j]*row_value;
+            }
+          dst[i] -= value;
+        }
+
+      if (identity_mass_matrix)
+        {
+          return;
+        }
+      // solve with the mass matrix: permute, then the unit lower and upper
+      // triangular solves.
+      const double *const lu = factorized_mass_matrix.data();
+      for (int i = 0; i < n; ++i)
+        {
+          std::swap(dst[i], dst[pivots[i]]);
+        }
+      for (int i = 1; i < n; ++i)
+        {
+          double value = dst[i];
+          for (int j = 0; j < i; ++j)
+            {
+              value -= lu[i*n + j]*dst[j];
+            }
+          dst[i] = value;
+        }
+      for (int i = n - 1; i >= 0; --i)
+        {
+          double value = dst[i];
+          for (int j = i + 1; j < n; ++j)
+            {
+              value -= lu[i*n + j]*dst[j];
+            }
+          dst[i] = value/lu[i*n + i];
+        }
+    }
+
+
+    template<int n>
+    void PlainRHSFixed<n>::apply(Vector<double> &dst, const Vector<double> &src)
+    {
+      Assert(src.size() == n, ExcDimensionMismatch(src.size(), n));
+      Assert(dst.size() == n, ExcDimensionMismatch(dst.size(), n));
+      VectorType src_values;
+      VectorType dst_values;
+      std::copy(src.begin(), src.end(), src_values.begin());
+      apply(dst_values, src_values);
+      std::copy(dst_values.begin(), dst_values.end(), dst.begin());
+    }
+  }
+}
+#endif
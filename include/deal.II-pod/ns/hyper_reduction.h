@@ -0,0 +1,339 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_hyper_reduction_h
+#define dealii__rom_hyper_reduction_h
+#include <deal.II/base/quadrature.h>
+#include <deal.II/base/work_stream.h>
+
+#include <deal.II/dofs/dof_handler.h>
+
+#include <deal.II/fe/fe_values.h>
+
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <string>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    /*
+     * A reduced quadrature rule for the quadratic (convective) term of the
+     * ROM, built by energy-conserving sampling and weighting (ECSW): the
+     * integral over the whole mesh is replaced by a weighted sum over the
+     * quadrature points of a few sampled cells. For each retained point p we
+     * store the value and gradient of every POD vector as
+     *
+     * values(p*dim + dim_n, pod_vector_n)
+     * gradients((p*dim + dim_n)*dim + derivative_n, pod_vector_n)
+     *
+     * and the product of the ECSW cell weight and JxW in weights(p).
+     */
+    class ReducedQuadrature
+    {
+    public:
+      ReducedQuadrature();
+      ReducedQuadrature(const unsigned int dim,
+                        const unsigned int n_pod_dofs,
+                        const unsigned int n_points);
+
+      unsigned int dimension() const;
+      unsigned int n_points() const;
+      unsigned int n_pod_dofs() const;
+
+      /*
+       * Only keep the first n_pod_dofs POD vectors.
+       */
+      void truncate(const unsigned int n_pod_dofs);
+
+      void load(const std::string &file_name_base);
+      void save(const std::string &file_name_base) const;
+
+      FullMatrix<double> values;
+      FullMatrix<double> gradients;
+      Vector<double>     weights;
+    };
+
+
+    /*
+     * The plain (unfiltered) ROM right hand side with the quadratic term
+     * evaluated with a ReducedQuadrature. Each evaluation of the quadratic
+     * term costs O(n_pod_dofs * n_points) instead of O(n_pod_dofs^3).
+     */
+    class HyperReducedRHS : public PlainRHS<double>
+    {
+    public:
+      HyperReducedRHS(const FullMatrix<double> linear_operator,
+                      const FullMatrix<double> mass_matrix,
+                      const ReducedQuadrature  reduced_quadrature,
+                      const Vector<double>     mean_contribution);
+      void apply(Vector<double> &dst, const Vector<double> &src) override;
+      void compute_jacobian(FullMatrix<double> &jacobian,
+                            const Vector<double> &src) override;
+      void apply_nonlinear_part(Vector<double> &dst,
+                                const Vector<double> &src) override;
+    protected:
+      /*
+       * Subtract the hyper reduced convection term evaluated at src from dst.
+       */
+      void subtract_convection(Vector<double> &dst, const Vector<double> &src);
+
+      const ReducedQuadrature reduced_quadrature;
+      Vector<double> point_values;
+      Vector<double> point_gradients;
+      Vector<double> point_convection;
+    };
+
+
+    namespace internal
+    {
+      template<int dim>
+      class ECSWScratchData
+      {
+      public:
+        ECSWScratchData(const FiniteElement<dim> &fe,
+                        const Quadrature<dim>    &quad,
+                        const unsigned int        n_pod_dofs,
+                        const unsigned int        n_snapshots) :
+          fe_values(fe, quad, update_values | update_gradients | update_JxW_values),
+          local_indices(fe.dofs_per_cell),
+          pod_values(n_pod_dofs, dim*quad.size()),
+          pod_gradients(n_pod_dofs, dim*dim*quad.size()),
+          snapshot_values(n_snapshots, dim*quad.size()),
+          snapshot_gradients(n_snapshots, dim*dim*quad.size()),
+          snapshot_convection(n_snapshots, dim*quad.size())
+        {}
+
+        ECSWScratchData(const ECSWScratchData<dim> &scratch_data) :
+          fe_values(scratch_data.fe_values.get_fe(),
+                    scratch_data.fe_values.get_quadrature(),
+                    scratch_data.fe_values.get_update_flags()),
+          local_indices(scratch_data.local_indices.size()),
+          pod_values(scratch_data.pod_values.m(), scratch_data.pod_values.n()),
+          pod_gradients(scratch_data.pod_gradients.m(),
+                        scratch_data.pod_gradients.n()),
+          snapshot_values(scratch_data.snapshot_values.m(),
+                          scratch_data.snapshot_values.n()),
+          snapshot_gradients(scratch_data.snapshot_gradients.m(),
+                             scratch_data.snapshot_gradients.n()),
+          snapshot_convection(scratch_data.snapshot_convection.m(),
+                              scratch_data.snapshot_convection.n())
+        {}
+
+        FEValues<dim> fe_values;
+        std::vector<types::global_dof_index> local_indices;
+        FullMatrix<double> pod_values;
+        FullMatrix<double> pod_gradients;
+        FullMatrix<double> snapshot_values;
+        FullMatrix<double> snapshot_gradients;
+        FullMatrix<double> snapshot_convection;
+      };
+
+
+      class ECSWCopyData
+      {
+      public:
+        ECSWCopyData(const unsigned int n_pod_dofs,
+                     const unsigned int n_snapshots) :
+          active_cell_index(numbers::invalid_unsigned_int),
+          local_contributions(n_snapshots, n_pod_dofs)
+        {}
+
+        unsigned int active_cell_index;
+        FullMatrix<double> local_contributions;
+      };
+    }
+
+
+    /*
+     * Compute the contribution of each active cell to the reduced quadratic
+     * term for a set of training states. Each row of coefficients holds the
+     * POD coefficients a of one training state u = sum_j a_j pod_vectors[j];
+     * then
+     *
+     * contributions(snapshot_n*n_pod_dofs + i, cell) = (pod_vectors[i], (u . grad) u)_cell.
+     *
+     * This is the ECSW training matrix: the sum of its columns is the exact
+     * quadratic term for every training state.
+     */
+    template<int dim>
+    void create_cell_nonlinearity_contributions
+    (const DoFHandler<dim>                  &dof_handler,
+     const Quadrature<dim>                  &quad,
+     const std::vector<BlockVector<double>> &pod_vectors,
+     const FullMatrix<double>               &coefficients,
+     FullMatrix<double>                     &contributions)
+    {
+      const unsigned int n_q_points = quad.size();
+      const unsigned int n_pod_dofs = pod_vectors.size();
+      const unsigned int n_snapshots = coefficients.m();
+      Assert(coefficients.n() == n_pod_dofs,
+             ExcDimensionMismatch(coefficients.n(), n_pod_dofs));
+      contributions.reinit(n_snapshots*n_pod_dofs,
+                           dof_handler.get_triangulation().n_active_cells());
+
+      internal::ECSWScratchData<dim> sample_scratch_data
+      (dof_handler.get_fe(), quad, n_pod_dofs, n_snapshots);
+      internal::ECSWCopyData sample_copy_data(n_pod_dofs, n_snapshots);
+
+      auto worker =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            internal::ECSWScratchData<dim>                       &scratch_data,
+            internal::ECSWCopyData                               &copy_data)
+      {
+        FEValues<dim> &fe_values = scratch_data.fe_values;
+        fe_values.reinit(cell);
+        cell->get_dof_indices(scratch_data.local_indices);
+        copy_data.active_cell_index = cell->active_cell_index();
+
+        internal::evaluate_pod_values
+        (fe_values, scratch_data.local_indices, pod_vectors,
+         scratch_data.pod_values);
+        internal::evaluate_pod_gradients
+        (fe_values, scratch_data.local_indices, pod_vectors,
+         scratch_data.pod_gradients);
+        coefficients.mmult(scratch_data.snapshot_values, scratch_data.pod_values);
+        coefficients.mmult(scratch_data.snapshot_gradients,
+                           scratch_data.pod_gradients);
+
+        for (unsigned int snapshot_n = 0; snapshot_n < n_snapshots; ++snapshot_n)
+          {
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                const double JxW = fe_values.JxW(q);
+                for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                  {
+                    double value = 0.0;
+                    for (unsigned int derivative_n = 0; derivative_n < dim;
+                         ++derivative_n)
+                      {
+                        value += scratch_data.snapshot_values
+                                 (snapshot_n, q*dim + derivative_n)
+                                 *scratch_data.snapshot_gradients
+                                 (snapshot_n, (q*dim + dim_n)*dim + derivative_n);
+                      }
+                    scratch_data.snapshot_convection(snapshot_n, q*dim + dim_n)
+                      = JxW*value;
+                  }
+              }
+          }
+        scratch_data.snapshot_convection.mTmult(copy_data.local_contributions,
+                                                scratch_data.pod_values);
+      };
+
+      auto copier = [&](const internal::ECSWCopyData &copy_data)
+      {
+        for (unsigned int snapshot_n = 0; snapshot_n < n_snapshots; ++snapshot_n)
+          {
+            for (unsigned int i = 0; i < n_pod_dofs; ++i)
+              {
+                contributions(snapshot_n*n_pod_dofs + i, copy_data.active_cell_index)
+                  = copy_data.local_contributions(snapshot_n, i);
+              }
+          }
+      };
+
+      WorkStream::run(dof_handler.begin_active(), dof_handler.end(), worker,
+                      copier, sample_scratch_data, sample_copy_data);
+    }
+
+
+    /*
+     * Build the reduced quadrature rule from the quadrature points of every
+     * active cell with a nonzero weight in cell_weights (indexed by active
+     * cell index).
+     */
+    template<int dim>
+    void create_reduced_quadrature
+    (const DoFHandler<dim>                  &dof_handler,
+     const Quadrature<dim>                  &quad,
+     const std::vector<BlockVector<double>> &pod_vectors,
+     const Vector<double>                   &cell_weights,
+     ReducedQuadrature                      &reduced_quadrature)
+    {
+      auto &fe = dof_handler.get_fe();
+      const unsigned int n_q_points = quad.size();
+      const unsigned int n_pod_dofs = pod_vectors.size();
+
+      unsigned int n_sampled_cells = 0;
+      for (const double weight : cell_weights)
+        {
+          if (weight > 0.0)
+            {
+              ++n_sampled_cells;
+            }
+        }
+      reduced_quadrature = ReducedQuadrature(dim, n_pod_dofs,
+                                             n_sampled_cells*n_q_points);
+
+      FEValues<dim> fe_values(fe, quad, update_values | update_gradients
+                              | update_JxW_values);
+      std::vector<types::global_dof_index> local_indices(fe.dofs_per_cell);
+      FullMatrix<double> pod_values(n_pod_dofs, dim*n_q_points);
+      FullMatrix<double> pod_gradients(n_pod_dofs, dim*dim*n_q_points);
+
+      unsigned int point_n = 0;
+      typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+      for (; cell != endc; ++cell)
+        {
+          const double cell_weight = cell_weights[cell->active_cell_index()];
+          if (cell_weight <= 0.0)
+            {
+              continue;
+            }
+          fe_values.reinit(cell);
+          cell->get_dof_indices(local_indices);
+          internal::evaluate_pod_values(fe_values, local_indices, pod_vectors,
+                                        pod_values);
+          internal::evaluate_pod_gradients(fe_values, local_indices, pod_vectors,
+                                           pod_gradients);
+
+          for (unsigned int q = 0; q < n_q_points; ++q, ++point_n)
+            {
+              reduced_quadrature.weights[point_n] = cell_weight*fe_values.JxW(q);
+              for (unsigned int pod_vector_n = 0; pod_vector_n < n_pod_dofs;
+                   ++pod_vector_n)
+                {
+                  for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                    {
+                      reduced_quadrature.values(point_n*dim + dim_n, pod_vector_n)
+                        = pod_values(pod_vector_n, q*dim + dim_n);
+                      for (unsigned int derivative_n = 0; derivative_n < dim;
+                           ++derivative_n)
+                        {
+                          reduced_quadrature.gradients
+                          ((point_n*dim + dim_n)*dim + derivative_n, pod_vector_n)
+                            = pod_gradients(pod_vector_n,
+                                            (q*dim + dim_n)*dim + derivative_n);
+                        }
+                    }
+                }
+            }
+        }
+    }
+  }
+}
+#endif
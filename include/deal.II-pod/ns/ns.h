@@ -17,13 +17,17 @@
  */
 #ifndef dealii__rom_ns_pod_h
 #define dealii__rom_ns_pod_h
+#include <deal.II/base/graph_coloring.h>
+#include <deal.II/base/types.h>
 #include <deal.II/base/quadrature.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/dofs/dof_handler.h>
 
 #include <deal.II/fe/fe_q.h>
 #include <deal.II/fe/fe_values.h>
 
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/tria_accessor.h>
 #include <deal.II/grid/tria_iterator.h>
 
@@ -36,13 +40,17 @@
 
 #include <deal.II/fe/fe_values.h>
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <limits>
-#include <random>
+#include <map>
 #include <vector>
 
 #include <deal.II-pod/ode/ode.h>
+#include <deal.II-pod/ns/quadratic_operator.h>
 
 using namespace dealii;
 namespace POD
@@ -51,26 +59,161 @@ namespace POD
 
   namespace NavierStokes
   {
-    class PlainRHS : public ODE::OperatorBase
+    /*
+     * Return true if every entry of matrix differs from the corresponding
+     * entry of the identity matrix by at most tolerance.
+     */
+    bool is_identity(const FullMatrix<double> &matrix,
+                     const double              tolerance = 0.0);
+
+
+    /*
+     * Replace each of the given operators A (the linear operator, the joint
+     * convection matrix, the mean contribution and every slice of the
+     * nonlinearity) by M^{-1} A and then set the mass matrix M to the identity
+     * matrix. The right hand side classes below detect an identity mass matrix
+     * and skip the linear solve, so after this the online evaluation is only
+     * matrix-vector products.
+     *
+     * If M is already the identity to within tolerance (which is the case for
+     * a basis that is orthonormal in the mass inner product) then M is simply
+     * replaced by the identity and the other operators are left alone.
+     */
+    void fold_inverse_mass_matrix
+    (FullMatrix<double>              &mass_matrix,
+     FullMatrix<double>              &linear_operator,
+     FullMatrix<double>              &joint_convection,
+     Vector<double>                  &mean_contribution,
+     std::vector<FullMatrix<double>> &nonlinear_operator,
+     const double                     tolerance = 1.0e-12);
+
+
+    /*
+     * The right hand side M^{-1} (L a + mean - N(a, a)) of the ROM. The state
+     * and the operators are stored with type Number while every sum, as well
+     * as the mass matrix solve, is done with type AccumulationNumber. Hence
+     *
+     * PlainRHS<double> is the usual ROM,
+     * PlainRHS<float> is a pure single precision ROM and
+     * PlainRHS<float, double> is a mixed precision ROM.
+     *
+     * The constructor always takes the double precision operators. Derived
+     * classes only exist for PlainRHS<double>.
+     */
+    template<typename Number, typename AccumulationNumber = Number>
+    class PlainRHS : public ODE::JacobianOperator<Number>,
+      public ODE::SplitOperator<Number>
     {
     public:
       PlainRHS();
+      /*
+       * If symmetric_nonlinearity is true then the nonlinearity is stored in
+       * symmetric form (see QuadraticOperator). Derived classes that apply it
+       * to two different vectors must use full storage.
+       */
       PlainRHS(const FullMatrix<double> linear_operator,
                const FullMatrix<double> mass_matrix,
                const std::vector<FullMatrix<double>> nonlinear_operator,
-               const Vector<double> mean_contribution);
-      void apply(Vector<double> &dst, const Vector<double> &src) override;
+               const Vector<double> mean_contribution,
+               const bool symmetric_nonlinearity = false);
+      void apply(Vector<Number> &dst, const Vector<Number> &src) override;
+      /*
+       * The Jacobian M^{-1} (L - sum_i e_i a^T (N_i + N_i^T)). Derived
+       * classes that change the nonlinearity override it.
+       */
+      void compute_jacobian(FullMatrix<Number> &jacobian,
+                            const Vector<Number> &src) override;
+
+      /*
+       * The linear part is M^{-1} L and the nonlinear part is the rest.
+       */
+      const FullMatrix<Number> &get_linear_part() const override;
+      void apply_nonlinear_part(Vector<Number> &dst,
+                                const Vector<Number> &src) override;
+    protected:
+      /*
+       * Replace matrix by M^{-1} matrix.
+       */
+      void apply_inverse_mass_matrix(FullMatrix<Number> &matrix);
+
+      const FullMatrix<Number> linear_operator;
+      FullMatrix<Number> linear_part;
+      LAPACKFullMatrix<AccumulationNumber> factorized_mass_matrix;
+      const QuadraticOperator<Number, AccumulationNumber> nonlinear_operator;
+      const Vector<AccumulationNumber> mean_contribution;
+      const unsigned int n_pod_dofs;
+      // if true then the mass matrix is skipped
+      const bool identity_mass_matrix;
+      mutable Vector<AccumulationNumber> temp;
+    };
+
+
+    /*
+     * PlainRHS<double> for the multirate integrator. With the slow
+     * coefficients s frozen, the fast rows of the right hand side are an
+     * affine function of the fast coefficients plus their quadratic self
+     * interaction, so freeze_slow_part stores the constant and linear terms
+     * and each call to apply_fast_part only uses the trailing block of the
+     * nonlinearity. The mass matrix must be the identity (e.g., after
+     * fold_inverse_mass_matrix).
+     */
+    class PartitionedPlainRHS : public PlainRHS<double>,
+      public ODE::PartitionedOperator<double>
+    {
+    public:
+      PartitionedPlainRHS(const FullMatrix<double> linear_operator,
+                          const FullMatrix<double> mass_matrix,
+                          const std::vector<FullMatrix<double>> nonlinear_operator,
+                          const Vector<double> mean_contribution,
+                          const bool symmetric_nonlinearity = false);
+      void freeze_slow_part(const Vector<double> &src,
+                            const unsigned int n_slow) override;
+      void apply_fast_part(Vector<double> &dst,
+                           const Vector<double> &src) override;
+    private:
+      // the frozen slow coefficients (padded with zeros) and their
+      // contribution to the fast rows
+      unsigned int n_slow_dofs;
+      Vector<double> slow_part;
+      Vector<double> fast_forcing;
+      FullMatrix<double> fast_linear_operator;
+    };
+
+
+    /*
+     * The same right hand side as PlainRHS, but for an ensemble of states
+     * stored as the columns of an n_pod_dofs x n_members matrix. Both the
+     * linear term and the nonlinearity are evaluated with matrix-matrix
+     * products (which deal.II hands to BLAS gemm for all but the smallest
+     * sizes): the nonlinearity is stored as the (r*r) x r matrix with rows
+     * N_i(j, :) so that
+     *
+     * N(u, u)_i = sum_j u_j (N_flat u)_{i*r + j}
+     *
+     * and only the final contraction is done by hand. The mass matrix is
+     * inverted once in the constructor (or skipped, if it is the identity).
+     */
+    class EnsemblePlainRHS : public ODE::EnsembleOperatorBase
+    {
+    public:
+      EnsemblePlainRHS(const FullMatrix<double> linear_operator,
+                       const FullMatrix<double> mass_matrix,
+                       const std::vector<FullMatrix<double>> nonlinear_operator,
+                       const Vector<double> mean_contribution);
+      void apply(FullMatrix<double> &dst, const FullMatrix<double> &src) override;
     protected:
       const FullMatrix<double> linear_operator;
-      LAPACKFullMatrix<double> factorized_mass_matrix;
-      const std::vector<FullMatrix<double>> nonlinear_operator;
+      const bool identity_mass_matrix;
+      FullMatrix<double> inverse_mass_matrix;
+      FullMatrix<double> flat_nonlinear_operator;
       const Vector<double> mean_contribution;
       const unsigned int n_pod_dofs;
-      mutable Vector<double> temp;
+      FullMatrix<double> nonlinear_products;
+      FullMatrix<double> temp;
     };
 
 
-    class PODDifferentialFilterRHS : public PlainRHS
+    class PODDifferentialFilterRHS : public PlainRHS<double>
     {
     public:
       PODDifferentialFilterRHS
@@ -82,9 +225,19 @@ namespace POD
        const Vector<double> mean_contribution,
        const double filter_radius);
       void apply(Vector<double> &dst, const Vector<double> &src) override;
+      /*
+       * The nonlinearity is N(F a, a) with the filter F = G^{-1} M, so the
+       * derivative of its first argument is multiplied by F.
+       */
+      void compute_jacobian(FullMatrix<double> &jacobian,
+                            const Vector<double> &src) override;
+      void apply_nonlinear_part(Vector<double> &dst,
+                                const Vector<double> &src) override;
     private:
       const FullMatrix<double> mass_matrix;
       LAPACKFullMatrix<double> factorized_filter_matrix;
+      // the filter F = G^{-1} M, only used by compute_jacobian
+      FullMatrix<double> filter_operator;
     };
 
 
@@ -94,23 +247,55 @@ namespace POD
      */
     namespace AD
     {
-      class FilterBase : public ODE::OperatorBase
+      class FilterBase : public ODE::OperatorBase<double>,
+        public ODE::StatefulOperator
       {
       public:
+        /*
+         * noise_stream and noise_substream make up the key of the Philox
+         * generator used for the noise: filters with different keys draw
+         * independent noise. The stream distinguishes runs; the substream
+         * distinguishes filters of one run (e.g., the filter of the right
+         * hand side and the filter applied to the output).
+         */
         FilterBase
         (const FullMatrix<double> mass_matrix,
          const FullMatrix<double> laplace_matrix,
          const FullMatrix<double> boundary_matrix,
          const double filter_radius,
-         const double noise_multiplier);
+         const double noise_multiplier,
+         const unsigned int noise_stream = 0,
+         const unsigned int noise_substream = 0);
         virtual void apply_inverse(Vector<double> &dst, const Vector<double> &src) = 0;
+
+        /*
+         * The dense matrix G = (M + d^2 S)^{-1}.
+         */
+        const FullMatrix<double> &get_filter_operator() const;
+
+        /*
+         * The state is the number of noise vectors drawn so far.
+         */
+        void save_state(Vector<double> &state) const override;
+        void load_state(const Vector<double> &state) override;
       protected:
+        /*
+         * Add noise_multiplier times a vector of uniform random numbers in (0,
+         * 1) to dst. Entry i of the noise is a pure function of the number of
+         * previous calls and of i (the counter) and of the key,
+         * so for RungeKutta4 the noise of stage s of step n is always the
+         * noise of evaluation 4 n + s, independently of threading.
+         */
+        void add_noise(Vector<double> &dst);
+
         const FullMatrix<double> mass_matrix;
         const FullMatrix<double> laplace_matrix;
         const FullMatrix<double> boundary_matrix;
 
         const double filter_radius;
         const double noise_multiplier;
+        const unsigned int noise_stream;
+        const unsigned int noise_substream;
 
         /*
          * In this terminology, the filter matrix is always (up to adding extra boundary terms)
@@ -120,18 +305,12 @@ namespace POD
         FullMatrix<double> filter_matrix;
 
         /*
-         * For applying the inverse of the filter matrix (i.e., G).
-         */
-        LAPACKFullMatrix<double> factorized_filter_matrix;
-
-        /*
-         * For applying the inverse of the mass matrix (usually M = I and this
-         * is just the identity function).
+         * The inverse of the filter matrix (i.e., G). Everything is r x r, so
+         * it is cheaper to store G than to do a solve at every evaluation.
          */
-        LAPACKFullMatrix<double> factorized_mass_matrix;
+        FullMatrix<double> filter_operator;
 
-        std::mt19937 generator;
-        std::uniform_real_distribution<double> distribution;
+        std::uint64_t n_noise_evaluations;
       };
 
 
@@ -144,14 +323,20 @@ namespace POD
          const FullMatrix<double> boundary_matrix,
          const double filter_radius,
          const double noise_multiplier,
-         const double lavrentiev_parameter);
+         const double lavrentiev_parameter,
+         const unsigned int noise_stream = 0,
+         const unsigned int noise_substream = 0);
 
         virtual void apply(Vector<double> &dst, const Vector<double> &src) override;
         virtual void apply_inverse(Vector<double> &dst, const Vector<double> &src) override;
       private:
         const double lavrentiev_parameter;
+
+        /*
+         * The composite operator (M + d^2 S)^{-1} (M + mu (M + d^2 S)) M.
+         */
+        FullMatrix<double> deconvolution_operator;
         Vector<double> work0;
-        Vector<double> work1;
       };
 
 
@@ -163,7 +348,8 @@ namespace POD
       };
 
 
-      class FilterRHS : public ODE::OperatorBase
+      class FilterRHS : public ODE::OperatorBase<double>,
+        public ODE::SplitOperator<double>, public ODE::StatefulOperator
       {
       public:
         FilterRHS
@@ -174,33 +360,49 @@ namespace POD
          const std::vector<FullMatrix<double>> nonlinear_operator,
          const Vector<double> mean_contribution,
          const double reynolds_n,
-         std::unique_ptr<FilterBase> ad_filter);
+         std::unique_ptr<FilterBase> ad_filter,
+         const bool symmetric_nonlinearity = false);
 
         void apply(Vector<double> &dst, const Vector<double> &src) override;
+
+        /*
+         * The linear part is the viscous term M^{-1} (B - S)/Re; everything
+         * that passes through the filter is treated as nonlinear.
+         */
+        const FullMatrix<double> &get_linear_part() const override;
+        void apply_nonlinear_part(Vector<double> &dst,
+                                  const Vector<double> &src) override;
+
+        /*
+         * The state is that of the filter.
+         */
+        void save_state(Vector<double> &state) const override;
+        void load_state(const Vector<double> &state) override;
       protected:
         void apply_filter(Vector<double> &dst, const Vector<double> &src);
 
-        const FullMatrix<double> mass_matrix;
-        const FullMatrix<double> boundary_matrix;
-        const FullMatrix<double> laplace_matrix;
         const FullMatrix<double> joint_convection_matrix;
-        const std::vector<FullMatrix<double>> nonlinear_operator;
+        const QuadraticOperator<double> nonlinear_operator;
         const Vector<double> mean_contribution;
         const double reynolds_n;
 
         mutable Vector<double> unfiltered_contribution;
-        mutable Vector<double> work1;
-        mutable Vector<double> work2;
         mutable Vector<double> approximately_deconvolved_solution;
 
         std::unique_ptr<FilterBase> filter;
 
-        LAPACKFullMatrix<double> factorized_mass_matrix;
+        /*
+         * The precomputed composite operators M^{-1} G M^{-1}, applied to the
+         * unfiltered contribution, and M^{-1} (B - S)/Re, applied to the
+         * filtered solution.
+         */
+        FullMatrix<double> filtered_inverse_mass_matrix;
+        FullMatrix<double> viscous_operator;
       };
     }
 
 
-    class L2ProjectionFilterRHS : public PlainRHS
+    class L2ProjectionFilterRHS : public PlainRHS<double>
     {
     public:
       L2ProjectionFilterRHS
@@ -211,6 +413,13 @@ namespace POD
        const Vector<double> mean_contribution,
        const unsigned int cutoff_n);
       void apply(Vector<double> &dst, const Vector<double> &src) override;
+      void compute_jacobian(FullMatrix<double> &jacobian,
+                            const Vector<double> &src) override;
+      /*
+       * The linear part includes the convection by the filtered solution.
+       */
+      void apply_nonlinear_part(Vector<double> &dst,
+                                const Vector<double> &src) override;
     private:
       const FullMatrix<double> joint_convection;
       FullMatrix<double> linear_operator_without_convection;
@@ -218,7 +427,13 @@ namespace POD
     };
 
 
-    class PostDifferentialFilter : public ODE::OperatorBase
+    /*
+     * The post filters are applied to the solution after each time step. Like
+     * PlainRHS they are instantiated for double and float and take the double
+     * precision operators.
+     */
+    template<typename Number>
+    class PostDifferentialFilter : public ODE::OperatorBase<Number>
     {
     public:
       PostDifferentialFilter
@@ -226,14 +441,15 @@ namespace POD
        const FullMatrix<double> &laplace_matrix,
        const FullMatrix<double> &boundary_matrix,
        const double filter_radius);
-      virtual void apply(Vector<double> &dst, const Vector<double> &src);
+      virtual void apply(Vector<Number> &dst, const Vector<Number> &src);
     private:
-      const FullMatrix<double> mass_matrix;
-      LAPACKFullMatrix<double> factorized_post_filter_matrix;
+      const FullMatrix<Number> mass_matrix;
+      LAPACKFullMatrix<Number> factorized_post_filter_matrix;
     };
 
 
-    class PostDifferentialFilterRelax : public ODE::OperatorBase
+    template<typename Number>
+    class PostDifferentialFilterRelax : public ODE::OperatorBase<Number>
     {
     public:
       PostDifferentialFilterRelax
@@ -242,18 +458,19 @@ namespace POD
        const FullMatrix<double> &boundary_matrix,
        const double filter_radius,
        const double relaxation_parameter);
-      virtual void apply(Vector<double> &dst, const Vector<double> &src);
+      virtual void apply(Vector<Number> &dst, const Vector<Number> &src);
     private:
-      double relaxation_parameter;
-      PostDifferentialFilter differential_filter;
+      Number relaxation_parameter;
+      PostDifferentialFilter<Number> differential_filter;
     };
 
 
-    class PostL2ProjectionFilter : public ODE::OperatorBase
+    template<typename Number>
+    class PostL2ProjectionFilter : public ODE::OperatorBase<Number>
     {
     public:
       PostL2ProjectionFilter(const unsigned int cutoff_n);
-      virtual void apply(Vector<double> &dst, const Vector<double> &src);
+      virtual void apply(Vector<Number> &dst, const Vector<Number> &src);
     private:
       const unsigned int cutoff_n;
     };
@@ -267,6 +484,368 @@ namespace POD
     = std::array<std::array<SparseMatrix<double>, static_cast<size_t>(dim)>,
     static_cast<size_t>(dim)>;
 
+
+    /*
+     * Active cells grouped into colors: no two cells of the same color share a
+     * degree of freedom, so the cells in a color may be assembled (including
+     * the scatter into the global matrix) concurrently.
+     */
+    template<int dim>
+    using ColoredCells
+    = std::vector<std::vector<typename DoFHandler<dim>::active_cell_iterator>>;
+
+
+    /*
+     * Color the active cells. If subdomain_id is given then only the cells
+     * with that subdomain id are colored, so that each process of a
+     * distributed assembly only visits the cells it owns.
+     */
+    template<int dim>
+    ColoredCells<dim> color_cells
+    (const DoFHandler<dim>      &dof_handler,
+     const types::subdomain_id   subdomain_id = numbers::invalid_subdomain_id)
+    {
+      typedef typename DoFHandler<dim>::active_cell_iterator CellIterator;
+      const unsigned int dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
+      std::function<std::vector<types::global_dof_index>(const CellIterator &)>
+      get_conflict_indices = [dofs_per_cell](const CellIterator &cell)
+      {
+        std::vector<types::global_dof_index> local_indices(dofs_per_cell);
+        cell->get_dof_indices(local_indices);
+        return local_indices;
+      };
+
+      CellIterator cell = dof_handler.begin_active(),
+                   endc = dof_handler.end();
+      ColoredCells<dim> colored_cells
+        = GraphColoring::make_graph_coloring(cell, endc, get_conflict_indices);
+      if (subdomain_id != numbers::invalid_subdomain_id)
+        {
+          // any subset of a color is still a valid color
+          for (auto &color : colored_cells)
+            {
+              color.erase(std::remove_if(color.begin(), color.end(),
+                                         [subdomain_id](const CellIterator &cell)
+              {
+                return cell->subdomain_id() != subdomain_id;
+              }), color.end());
+            }
+          colored_cells.erase
+          (std::remove_if(colored_cells.begin(), colored_cells.end(),
+                          [](const std::vector<CellIterator> &color)
+          {
+            return color.empty();
+          }), colored_cells.end());
+        }
+      return colored_cells;
+    }
+
+
+    /*
+     * Active cells with a given subdomain id, or all active cells if the
+     * subdomain id is numbers::invalid_subdomain_id. Used to restrict the
+     * WorkStream loops that assemble reduced quantities directly.
+     */
+    template<int dim>
+    using OwnedCellIterator
+    = FilteredIterator<typename DoFHandler<dim>::active_cell_iterator>;
+
+
+    namespace internal
+    {
+      class IsOwnedBy
+      {
+      public:
+        IsOwnedBy(const types::subdomain_id subdomain_id) :
+          subdomain_id(subdomain_id)
+        {}
+
+        template<typename Iterator>
+        bool operator()(const Iterator &cell) const
+        {
+          return subdomain_id == numbers::invalid_subdomain_id
+                 || cell->subdomain_id() == subdomain_id;
+        }
+
+      private:
+        types::subdomain_id subdomain_id;
+      };
+    }
+
+
+    template<int dim>
+    OwnedCellIterator<dim> begin_owned_active
+    (const DoFHandler<dim>     &dof_handler,
+     const types::subdomain_id  subdomain_id)
+    {
+      return OwnedCellIterator<dim>(internal::IsOwnedBy(subdomain_id),
+                                    dof_handler.begin_active());
+    }
+
+
+    template<int dim>
+    OwnedCellIterator<dim> end_owned_active
+    (const DoFHandler<dim>     &dof_handler,
+     const types::subdomain_id  subdomain_id)
+    {
+      return OwnedCellIterator<dim>(internal::IsOwnedBy(subdomain_id),
+                                    typename DoFHandler<dim>::active_cell_iterator
+                                    (dof_handler.end()));
+    }
+
+
+    namespace internal
+    {
+      /*
+       * Per-thread scratch space for the WorkStream based assembly
+       * functions. point_values is a buffer for values of some field at the
+       * quadrature points whose layout is decided by the caller.
+       */
+      template<int dim>
+      class AssemblyScratchData
+      {
+      public:
+        AssemblyScratchData(const FiniteElement<dim> &fe,
+                            const Quadrature<dim>    &quad,
+                            const UpdateFlags         update_flags,
+                            const unsigned int        n_point_values) :
+          fe_values(fe, quad, update_flags),
+          point_values(n_point_values)
+        {}
+
+        AssemblyScratchData(const AssemblyScratchData<dim> &scratch_data) :
+          fe_values(scratch_data.fe_values.get_fe(),
+                    scratch_data.fe_values.get_quadrature(),
+                    scratch_data.fe_values.get_update_flags()),
+          point_values(scratch_data.point_values.size())
+        {}
+
+        FEValues<dim> fe_values;
+        std::vector<double> point_values;
+      };
+
+
+      /*
+       * Thread-local cell matrices and the global indices they are scattered
+       * into.
+       */
+      class AssemblyCopyData
+      {
+      public:
+        AssemblyCopyData(const unsigned int dofs_per_cell,
+                         const unsigned int n_cell_matrices) :
+          local_indices(dofs_per_cell),
+          cell_matrices(n_cell_matrices,
+                        FullMatrix<double>(dofs_per_cell, dofs_per_cell))
+        {}
+
+        std::vector<types::global_dof_index> local_indices;
+        std::vector<FullMatrix<double>> cell_matrices;
+      };
+
+
+      /*
+       * Per-thread scratch space for assembly functions that produce reduced
+       * (i.e., POD) matrices directly. The value matrices store the values of
+       * each POD vector at the quadrature points as
+       *
+       * pod_values(pod_vector_n, q*dim + dim_n).
+       */
+      template<int dim>
+      class ReducedAssemblyScratchData
+      {
+      public:
+        ReducedAssemblyScratchData(const FiniteElement<dim> &fe,
+                                   const Quadrature<dim>    &quad,
+                                   const UpdateFlags         update_flags,
+                                   const unsigned int        n_pod_dofs,
+                                   const unsigned int        n_filtered_pod_dofs,
+                                   const unsigned int        n_point_values) :
+          fe_values(fe, quad, update_flags),
+          local_indices(fe.dofs_per_cell),
+          point_values(n_point_values),
+          pod_values(n_pod_dofs, dim*quad.size()),
+          filtered_pod_values(n_filtered_pod_dofs, dim*quad.size()),
+          weighted_values(n_filtered_pod_dofs, dim*quad.size())
+        {}
+
+        ReducedAssemblyScratchData(const ReducedAssemblyScratchData<dim> &scratch_data) :
+          fe_values(scratch_data.fe_values.get_fe(),
+                    scratch_data.fe_values.get_quadrature(),
+                    scratch_data.fe_values.get_update_flags()),
+          local_indices(scratch_data.local_indices.size()),
+          point_values(scratch_data.point_values.size()),
+          pod_values(scratch_data.pod_values.m(), scratch_data.pod_values.n()),
+          filtered_pod_values(scratch_data.filtered_pod_values.m(),
+                              scratch_data.filtered_pod_values.n()),
+          weighted_values(scratch_data.weighted_values.m(),
+                          scratch_data.weighted_values.n())
+        {}
+
+        FEValues<dim> fe_values;
+        std::vector<types::global_dof_index> local_indices;
+        std::vector<double> point_values;
+        FullMatrix<double> pod_values;
+        FullMatrix<double> filtered_pod_values;
+        FullMatrix<double> weighted_values;
+      };
+
+
+      /*
+       * A single cell's contribution to a reduced matrix.
+       */
+      class ReducedAssemblyCopyData
+      {
+      public:
+        ReducedAssemblyCopyData(const unsigned int n_rows,
+                                const unsigned int n_columns) :
+          local_matrix(n_rows, n_columns)
+        {}
+
+        FullMatrix<double> local_matrix;
+      };
+
+
+      /*
+       * Evaluate each POD vector at the quadrature points of the cell on which
+       * fe_values was last reinitialized. See ReducedAssemblyScratchData for
+       * the layout of values.
+       */
+      template<int dim>
+      void evaluate_pod_values
+      (const FEValues<dim>                        &fe_values,
+       const std::vector<types::global_dof_index> &local_indices,
+       const std::vector<BlockVector<double>>     &pod_vectors,
+       FullMatrix<double>                         &values)
+      {
+        const unsigned int dofs_per_cell = local_indices.size();
+        const unsigned int n_q_points = fe_values.n_quadrature_points;
+        values = 0.0;
+        for (unsigned int pod_vector_n = 0; pod_vector_n < pod_vectors.size();
+             ++pod_vector_n)
+          {
+            for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+              {
+                const Vector<double> &block = pod_vectors[pod_vector_n].block(dim_n);
+                for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                  {
+                    const double coefficient = block[local_indices[i]];
+                    for (unsigned int q = 0; q < n_q_points; ++q)
+                      {
+                        values(pod_vector_n, q*dim + dim_n)
+                          += coefficient*fe_values.shape_value(i, q);
+                      }
+                  }
+              }
+          }
+      }
+
+
+      /*
+       * Evaluate the gradient of each POD vector at the quadrature points of
+       * the cell on which fe_values was last reinitialized, stored as
+       *
+       * gradients(pod_vector_n, (q*dim + dim_n)*dim + derivative_n).
+       */
+      template<int dim>
+      void evaluate_pod_gradients
+      (const FEValues<dim>                        &fe_values,
+       const std::vector<types::global_dof_index> &local_indices,
+       const std::vector<BlockVector<double>>     &pod_vectors,
+       FullMatrix<double>                         &gradients)
+      {
+        const unsigned int dofs_per_cell = local_indices.size();
+        const unsigned int n_q_points = fe_values.n_quadrature_points;
+        gradients = 0.0;
+        for (unsigned int pod_vector_n = 0; pod_vector_n < pod_vectors.size();
+             ++pod_vector_n)
+          {
+            for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+              {
+                const Vector<double> &block = pod_vectors[pod_vector_n].block(dim_n);
+                for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                  {
+                    const double coefficient = block[local_indices[i]];
+                    for (unsigned int q = 0; q < n_q_points; ++q)
+                      {
+                        for (unsigned int derivative_n = 0; derivative_n < dim;
+                             ++derivative_n)
+                          {
+                            gradients(pod_vector_n, (q*dim + dim_n)*dim + derivative_n)
+                              += coefficient*fe_values.shape_grad(i, q)[derivative_n];
+                          }
+                      }
+                  }
+              }
+          }
+      }
+
+
+      /*
+       * Per-thread scratch space for create_reduced_nonlinearity_block. The
+       * test and filtered values use the layout of
+       * ReducedAssemblyScratchData and the trial gradients the layout of
+       * evaluate_pod_gradients.
+       */
+      template<int dim>
+      class NonlinearityBlockScratchData
+      {
+      public:
+        NonlinearityBlockScratchData(const FiniteElement<dim> &fe,
+                                     const Quadrature<dim>    &quad,
+                                     const unsigned int        n_test_dofs,
+                                     const unsigned int        n_filtered_dofs,
+                                     const unsigned int        n_trial_dofs) :
+          fe_values(fe, quad, update_values | update_gradients | update_JxW_values),
+          local_indices(fe.dofs_per_cell),
+          test_values(n_test_dofs, dim*quad.size()),
+          filtered_values(n_filtered_dofs, dim*quad.size()),
+          trial_gradients(n_trial_dofs, dim*dim*quad.size()),
+          weighted_values(n_trial_dofs, dim*quad.size()),
+          local_slice(n_test_dofs, n_trial_dofs)
+        {}
+
+        NonlinearityBlockScratchData(const NonlinearityBlockScratchData<dim> &scratch_data) :
+          fe_values(scratch_data.fe_values.get_fe(),
+                    scratch_data.fe_values.get_quadrature(),
+                    scratch_data.fe_values.get_update_flags()),
+          local_indices(scratch_data.local_indices.size()),
+          test_values(scratch_data.test_values.m(), scratch_data.test_values.n()),
+          filtered_values(scratch_data.filtered_values.m(),
+                          scratch_data.filtered_values.n()),
+          trial_gradients(scratch_data.trial_gradients.m(),
+                          scratch_data.trial_gradients.n()),
+          weighted_values(scratch_data.weighted_values.m(),
+                          scratch_data.weighted_values.n()),
+          local_slice(scratch_data.local_slice.m(), scratch_data.local_slice.n())
+        {}
+
+        FEValues<dim> fe_values;
+        std::vector<types::global_dof_index> local_indices;
+        FullMatrix<double> test_values;
+        FullMatrix<double> filtered_values;
+        FullMatrix<double> trial_gradients;
+        FullMatrix<double> weighted_values;
+        FullMatrix<double> local_slice;
+      };
+
+
+      /*
+       * A single cell's contribution to a block of the reduced nonlinearity.
+       */
+      class NonlinearityBlockCopyData
+      {
+      public:
+        NonlinearityBlockCopyData(const unsigned int n_test_dofs,
+                                  const unsigned int n_filtered_dofs,
+                                  const unsigned int n_trial_dofs) :
+          local_block(n_test_dofs, FullMatrix<double>(n_filtered_dofs, n_trial_dofs))
+        {}
+
+        std::vector<FullMatrix<double>> local_block;
+      };
+    }
+
     template<int dim>
     double trilinearity_term(
       const Quadrature<dim>     &quad,
@@ -348,135 +927,173 @@ namespace POD
     (const DoFHandler<dim>     &dof_handler,
      const Quadrature<dim>     &quad,
      const BlockVector<double> &solution,
-     ArrayArray<dim> &gradient)
+     ArrayArray<dim>           &gradient)
+    {
+      create_gradient_linearization
+      (dof_handler, color_cells(dof_handler), quad, solution, gradient);
+    }
+
+
+    template<int dim>
+    void create_gradient_linearization
+    (const DoFHandler<dim>     &dof_handler,
+     const ColoredCells<dim>   &colored_cells,
+     const Quadrature<dim>     &quad,
+     const BlockVector<double> &solution,
+     ArrayArray<dim>           &gradient)
     {
       auto &fe = dof_handler.get_fe();
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
-      FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-      FEValues<dim> fe_values(fe, quad, update_values | update_gradients
-                              | update_JxW_values);
-
-      std::vector<types::global_dof_index> local_indices(dofs_per_cell);
-      Vector<double> local_gradient_values(quad.size());
+      const unsigned int n_q_points = quad.size();
+
+      // The copy data stores one cell matrix for each (row, derivative) pair
+      // in row-major order.
+      internal::AssemblyScratchData<dim> sample_scratch_data
+      (fe, quad, update_values | update_gradients | update_JxW_values,
+       n_q_points);
+      internal::AssemblyCopyData sample_copy_data(dofs_per_cell, dim*dim);
+
+      auto worker =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            internal::AssemblyScratchData<dim>                   &scratch_data,
+            internal::AssemblyCopyData                           &copy_data)
+      {
+        FEValues<dim> &fe_values = scratch_data.fe_values;
+        std::vector<double> &local_gradient_values = scratch_data.point_values;
+        fe_values.reinit(cell);
+        cell->get_dof_indices(copy_data.local_indices);
+
+        for (unsigned int row_n = 0; row_n < dim; ++row_n)
+          {
+            for (unsigned int derivative_n = 0; derivative_n < dim; ++derivative_n)
+              {
+                // evaluate the derivative of the row component of the solution.
+                FullMatrix<double> &cell_matrix
+                  = copy_data.cell_matrices[row_n*dim + derivative_n];
+                cell_matrix = 0.0;
+                std::fill(local_gradient_values.begin(),
+                          local_gradient_values.end(), 0.0);
+                for (unsigned int q = 0; q < n_q_points; ++q)
+                  {
+                    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                      {
+                        local_gradient_values[q] +=
+                          solution.block(row_n)[copy_data.local_indices[i]]
+                          *fe_values.shape_grad(i, q)[derivative_n];
+                      }
+                    const double weight = local_gradient_values[q]*fe_values.JxW(q);
+                    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                      {
+                        const double test_value = fe_values.shape_value(i, q)*weight;
+                        for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                          {
+                            cell_matrix(i, j) += test_value*fe_values.shape_value(j, q);
+                          }
+                      }
+                  }
+              }
+          }
+      };
 
-      typename DoFHandler<dim>::active_cell_iterator
-      cell = dof_handler.begin_active(),
-      endc = dof_handler.end();
+      auto copier = [&](const internal::AssemblyCopyData &copy_data)
+      {
+        for (unsigned int row_n = 0; row_n < dim; ++row_n)
+          {
+            for (unsigned int derivative_n = 0; derivative_n < dim; ++derivative_n)
+              {
+                gradient[row_n][derivative_n].add
+                (copy_data.local_indices,
+                 copy_data.cell_matrices[row_n*dim + derivative_n]);
+              }
+          }
+      };
 
-      for (; cell != endc; ++cell)
-        {
-          fe_values.reinit(cell);
-          cell->get_dof_indices(local_indices);
+      WorkStream::run(colored_cells, worker, copier, sample_scratch_data,
+                      sample_copy_data);
+    }
 
-          for (unsigned int row_n = 0; row_n < gradient.size(); ++row_n)
-            {
-              for (unsigned int derivative_n = 0; derivative_n < gradient[0].size();
-                   ++derivative_n)
-                {
-                  // evaluate the derivative of the row component of the solution.
-                  cell_matrix = 0.0;
-                  local_gradient_values = 0.0;
-                  for (unsigned int q = 0; q < quad.size(); ++q)
-                    {
-                      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                        {
-                          local_gradient_values[q] +=
-                            solution.block(row_n)[local_indices[i]]
-                            *fe_values.shape_grad(i, q)[derivative_n];
-                        }
-                      for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                        {
-                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                            {
-                              cell_matrix(i, j) += fe_values.shape_value(i, q)
-                                                   *fe_values.shape_value(j, q)
-                                                   *local_gradient_values[q]
-                                                   *fe_values.JxW(q);
-                            }
-                        }
-                    }
 
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                        {
-                          gradient[row_n][derivative_n].add
-                          (local_indices[i], local_indices[j], cell_matrix(i, j));
-                        }
-                    }
-                }
-            }
-        }
+    template<int dim>
+    void create_advective_linearization(const DoFHandler<dim>     &dof_handler,
+                                        const Quadrature<dim>     &quad,
+                                        const BlockVector<double> &solution,
+                                        SparseMatrix<double>      &advection)
+    {
+      create_advective_linearization
+      (dof_handler, color_cells(dof_handler), quad, solution, advection);
     }
 
 
     template<int dim>
     void create_advective_linearization(const DoFHandler<dim>     &dof_handler,
+                                        const ColoredCells<dim>   &colored_cells,
                                         const Quadrature<dim>     &quad,
                                         const BlockVector<double> &solution,
                                         SparseMatrix<double>      &advection)
     {
       auto &fe = dof_handler.get_fe();
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
-      FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-      FEValues<dim> fe_values(fe, quad, update_values | update_gradients
-                              | update_JxW_values);
-
-      std::vector<types::global_dof_index> local_indices(dofs_per_cell);
-      std::array<Vector<double>, dim> local_advection_values;
-      for (auto &vector : local_advection_values)
-        {
-          vector.reinit(quad.size());
-        }
-
-      typename DoFHandler<dim>::active_cell_iterator
-      cell = dof_handler.begin_active(),
-      endc = dof_handler.end();
-
-      for (; cell != endc; ++cell)
-        {
-          fe_values.reinit(cell);
-          cell_matrix = 0.0;
-          cell->get_dof_indices(local_indices);
-          for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
-            {
-              local_advection_values[dim_n] = 0.0;
-              for (unsigned int q = 0; q < quad.size(); ++q)
-                {
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                    {
-                      local_advection_values[dim_n][q] +=
-                        fe_values.shape_value(i, q)
-                        *solution.block(dim_n)[local_indices[i]];
-                    }
-                }
-            }
+      const unsigned int n_q_points = quad.size();
+
+      // The point values are the advecting field, stored as
+      // point_values[dim_n*n_q_points + q].
+      internal::AssemblyScratchData<dim> sample_scratch_data
+      (fe, quad, update_values | update_gradients | update_JxW_values,
+       dim*n_q_points);
+      internal::AssemblyCopyData sample_copy_data(dofs_per_cell, 1);
+
+      auto worker =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            internal::AssemblyScratchData<dim>                   &scratch_data,
+            internal::AssemblyCopyData                           &copy_data)
+      {
+        FEValues<dim> &fe_values = scratch_data.fe_values;
+        std::vector<double> &local_advection_values = scratch_data.point_values;
+        FullMatrix<double> &cell_matrix = copy_data.cell_matrices[0];
+        fe_values.reinit(cell);
+        cell_matrix = 0.0;
+        cell->get_dof_indices(copy_data.local_indices);
+
+        std::fill(local_advection_values.begin(), local_advection_values.end(),
+                  0.0);
+        for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+          {
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                  {
+                    local_advection_values[dim_n*n_q_points + q] +=
+                      fe_values.shape_value(i, q)
+                      *solution.block(dim_n)[copy_data.local_indices[i]];
+                  }
+              }
+          }
+
+        for (unsigned int q = 0; q < n_q_points; ++q)
+          {
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                const double test_value = fe_values.shape_value(i, q)*fe_values.JxW(q);
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                  {
+                    for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                      {
+                        cell_matrix(i, j) += test_value
+                                             *local_advection_values[dim_n*n_q_points + q]
+                                             *fe_values.shape_grad(j, q)[dim_n];
+                      }
+                  }
+              }
+          }
+      };
 
-          for (unsigned int q = 0; q < quad.size(); ++q)
-            {
-              for (unsigned int i = 0; i < dofs_per_cell; ++i)
-                {
-                  for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                    {
-                      for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
-                        {
-                          cell_matrix(i, j) += fe_values.shape_value(i, q)
-                                               *local_advection_values[dim_n][q]
-                                               *fe_values.shape_grad(j, q)[dim_n]
-                                               *fe_values.JxW(q);
-                        }
-                    }
-                }
-            }
+      auto copier = [&](const internal::AssemblyCopyData &copy_data)
+      {
+        advection.add(copy_data.local_indices, copy_data.cell_matrices[0]);
+      };
 
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            {
-              for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                {
-                  advection.add(local_indices[i], local_indices[j], cell_matrix(i, j));
-                }
-            }
-        }
+      WorkStream::run(colored_cells, worker, copier, sample_scratch_data,
+                      sample_copy_data);
     }
 
     template<int dim>
@@ -499,7 +1116,8 @@ namespace POD
      const Quadrature<dim>                  &quad,
      const std::vector<BlockVector<double>> &pod_vectors,
      const std::vector<BlockVector<double>> &filtered_pod_vectors,
-     std::vector<FullMatrix<double>>        &nonlinear_operator)
+     std::vector<FullMatrix<double>>        &nonlinear_operator,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
     {
       const unsigned int n_pod_dofs = pod_vectors.size();
       const unsigned int n_dofs = pod_vectors.at(0).block(0).size();
@@ -509,23 +1127,277 @@ namespace POD
           nonlinear_operator.emplace_back(n_pod_dofs);
         }
 
-      #pragma omp parallel for
+      // Each linearization is assembled in parallel, so reuse one matrix (and
+      // one coloring) rather than allocating a matrix per thread.
+      const ColoredCells<dim> colored_cells = color_cells(dof_handler,
+                                                          subdomain_id);
+      SparseMatrix<double> full_advection(sparsity_pattern);
+
+      // If only some cells are assembled then the linearizations are zero
+      // outside of the degrees of freedom on those cells, so the inner
+      // products only need to run over them.
+      const bool is_partial = subdomain_id != numbers::invalid_subdomain_id;
+      std::vector<types::global_dof_index> owned_dofs;
+      if (is_partial)
+        {
+          std::vector<types::global_dof_index> local_indices
+            (dof_handler.get_fe().dofs_per_cell);
+          for (const auto &color : colored_cells)
+            {
+              for (const auto &cell : color)
+                {
+                  cell->get_dof_indices(local_indices);
+                  owned_dofs.insert(owned_dofs.end(), local_indices.begin(),
+                                    local_indices.end());
+                }
+            }
+          std::sort(owned_dofs.begin(), owned_dofs.end());
+          owned_dofs.erase(std::unique(owned_dofs.begin(), owned_dofs.end()),
+                           owned_dofs.end());
+        }
       for (unsigned int j = 0; j < n_pod_dofs; ++j)
         {
-          BlockVector<double> temp(dim, n_dofs);
-          SparseMatrix<double> full_advection(sparsity_pattern);
+          full_advection = 0.0;
           create_advective_linearization
-          (dof_handler, quad, filtered_pod_vectors.at(j), full_advection);
-          for (unsigned int k = 0; k < n_pod_dofs; ++k)
+          (dof_handler, colored_cells, quad, filtered_pod_vectors.at(j),
+           full_advection);
+
+          #pragma omp parallel
+          {
+            BlockVector<double> temp(dim, n_dofs);
+            #pragma omp for
+            for (unsigned int k = 0; k < n_pod_dofs; ++k)
+              {
+                for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                  {
+                    full_advection.vmult(temp.block(dim_n),
+                                         pod_vectors.at(k).block(dim_n));
+                  }
+                for (unsigned int i = 0; i < n_pod_dofs; ++i)
+                  {
+                    if (is_partial)
+                      {
+                        double value = 0.0;
+                        for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                          {
+                            const Vector<double> &pod_block
+                              = pod_vectors.at(i).block(dim_n);
+                            const Vector<double> &temp_block = temp.block(dim_n);
+                            for (const auto dof : owned_dofs)
+                              {
+                                value += pod_block[dof]*temp_block[dof];
+                              }
+                          }
+                        nonlinear_operator[i](j, k) = value;
+                      }
+                    else
+                      {
+                        nonlinear_operator[i](j, k) = pod_vectors.at(i)*temp;
+                      }
+                  }
+              }
+          }
+        }
+    }
+
+
+    /*
+     * Compute a block of the reduced nonlinearity
+     *
+     * block[i](j, k) = (test_vectors[i], (filtered_vectors[j] . grad) trial_vectors[k])
+     *
+     * by quadrature: each vector is evaluated once per quadrature point and
+     * no global matrices are assembled. This is more expensive per entry than
+     * create_reduced_nonlinearity, which assembles one advective
+     * linearization per j, but it computes exactly the requested entries.
+     */
+    template<int dim>
+    void create_reduced_nonlinearity_block
+    (const DoFHandler<dim>                  &dof_handler,
+     const Quadrature<dim>                  &quad,
+     const std::vector<BlockVector<double>> &test_vectors,
+     const std::vector<BlockVector<double>> &filtered_vectors,
+     const std::vector<BlockVector<double>> &trial_vectors,
+     std::vector<FullMatrix<double>>        &block,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
+    {
+      const unsigned int n_q_points = quad.size();
+      const unsigned int n_test_dofs = test_vectors.size();
+      const unsigned int n_filtered_dofs = filtered_vectors.size();
+      const unsigned int n_trial_dofs = trial_vectors.size();
+      block.resize(0);
+      for (unsigned int i = 0; i < n_test_dofs; ++i)
+        {
+          block.emplace_back(n_filtered_dofs, n_trial_dofs);
+        }
+
+      internal::NonlinearityBlockScratchData<dim> sample_scratch_data
+      (dof_handler.get_fe(), quad, n_test_dofs, n_filtered_dofs, n_trial_dofs);
+      internal::NonlinearityBlockCopyData sample_copy_data
+      (n_test_dofs, n_filtered_dofs, n_trial_dofs);
+
+      auto worker =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            internal::NonlinearityBlockScratchData<dim>          &scratch_data,
+            internal::NonlinearityBlockCopyData                  &copy_data)
+      {
+        FEValues<dim> &fe_values = scratch_data.fe_values;
+        fe_values.reinit(cell);
+        cell->get_dof_indices(scratch_data.local_indices);
+
+        internal::evaluate_pod_values
+        (fe_values, scratch_data.local_indices, test_vectors,
+         scratch_data.test_values);
+        internal::evaluate_pod_values
+        (fe_values, scratch_data.local_indices, filtered_vectors,
+         scratch_data.filtered_values);
+        internal::evaluate_pod_gradients
+        (fe_values, scratch_data.local_indices, trial_vectors,
+         scratch_data.trial_gradients);
+
+        for (unsigned int j = 0; j < n_filtered_dofs; ++j)
+          {
+            // weighted_values(k, q*dim + dim_n) = JxW (psi_j . grad) phi_{k, dim_n}
+            for (unsigned int k = 0; k < n_trial_dofs; ++k)
+              {
+                for (unsigned int q = 0; q < n_q_points; ++q)
+                  {
+                    const double JxW = fe_values.JxW(q);
+                    for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+                      {
+                        double value = 0.0;
+                        for (unsigned int derivative_n = 0; derivative_n < dim;
+                             ++derivative_n)
+                          {
+                            value += scratch_data.filtered_values
+                                     (j, q*dim + derivative_n)
+                                     *scratch_data.trial_gradients
+                                     (k, (q*dim + dim_n)*dim + derivative_n);
+                          }
+                        scratch_data.weighted_values(k, q*dim + dim_n) = JxW*value;
+                      }
+                  }
+              }
+
+            scratch_data.test_values.mTmult(scratch_data.local_slice,
+                                            scratch_data.weighted_values);
+            for (unsigned int i = 0; i < n_test_dofs; ++i)
+              {
+                for (unsigned int k = 0; k < n_trial_dofs; ++k)
+                  {
+                    copy_data.local_block[i](j, k) = scratch_data.local_slice(i, k);
+                  }
+              }
+          }
+      };
+
+      auto copier = [&](const internal::NonlinearityBlockCopyData &copy_data)
+      {
+        for (unsigned int i = 0; i < n_test_dofs; ++i)
+          {
+            block[i].add(1.0, copy_data.local_block[i]);
+          }
+      };
+
+      WorkStream::run(begin_owned_active(dof_handler, subdomain_id),
+                      end_owned_active(dof_handler, subdomain_id), worker,
+                      copier, sample_scratch_data, sample_copy_data);
+    }
+
+
+    /*
+     * Extend a reduced nonlinearity computed with the first
+     * nonlinear_operator.size() POD vectors to all of them. Only the entries
+     * with at least one new index are computed, in three blocks:
+     *
+     * 1. every i, new j, every k;
+     * 2. every i, old j, new k;
+     * 3. new i, old j, old k.
+     */
+    template<int dim>
+    void extend_reduced_nonlinearity
+    (const DoFHandler<dim>                  &dof_handler,
+     const Quadrature<dim>                  &quad,
+     const std::vector<BlockVector<double>> &pod_vectors,
+     const std::vector<BlockVector<double>> &filtered_pod_vectors,
+     std::vector<FullMatrix<double>>        &nonlinear_operator,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
+    {
+      const unsigned int n_pod_dofs = pod_vectors.size();
+      const unsigned int n_old_pod_dofs = nonlinear_operator.size();
+      AssertThrow(n_old_pod_dofs <= n_pod_dofs,
+                  ExcMessage("The reduced nonlinearity is larger than the POD "
+                             "basis."));
+      if (n_old_pod_dofs == n_pod_dofs)
+        {
+          return;
+        }
+
+      const std::vector<BlockVector<double>> old_pod_vectors
+        (pod_vectors.begin(), pod_vectors.begin() + n_old_pod_dofs);
+      const std::vector<BlockVector<double>> new_pod_vectors
+        (pod_vectors.begin() + n_old_pod_dofs, pod_vectors.end());
+      const std::vector<BlockVector<double>> old_filtered_pod_vectors
+        (filtered_pod_vectors.begin(),
+         filtered_pod_vectors.begin() + n_old_pod_dofs);
+      const std::vector<BlockVector<double>> new_filtered_pod_vectors
+        (filtered_pod_vectors.begin() + n_old_pod_dofs,
+         filtered_pod_vectors.end());
+
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          if (i < n_old_pod_dofs)
             {
-              for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+              FullMatrix<double> old_slice;
+              old_slice.swap(nonlinear_operator[i]);
+              nonlinear_operator[i].reinit(n_pod_dofs, n_pod_dofs);
+              nonlinear_operator[i].fill(old_slice);
+            }
+          else
+            {
+              nonlinear_operator.emplace_back(n_pod_dofs);
+            }
+        }
+
+      std::vector<FullMatrix<double>> block;
+      create_reduced_nonlinearity_block
+      (dof_handler, quad, pod_vectors, new_filtered_pod_vectors, pod_vectors,
+       block, subdomain_id);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          for (unsigned int j = n_old_pod_dofs; j < n_pod_dofs; ++j)
+            {
+              for (unsigned int k = 0; k < n_pod_dofs; ++k)
                 {
-                  full_advection.vmult(temp.block(dim_n),
-                                       pod_vectors.at(k).block(dim_n));
+                  nonlinear_operator[i](j, k) = block[i](j - n_old_pod_dofs, k);
                 }
-              for (unsigned int i = 0; i < n_pod_dofs; ++i)
+            }
+        }
+
+      create_reduced_nonlinearity_block
+      (dof_handler, quad, pod_vectors, old_filtered_pod_vectors,
+       new_pod_vectors, block, subdomain_id);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          for (unsigned int j = 0; j < n_old_pod_dofs; ++j)
+            {
+              for (unsigned int k = n_old_pod_dofs; k < n_pod_dofs; ++k)
+                {
+                  nonlinear_operator[i](j, k) = block[i](j, k - n_old_pod_dofs);
+                }
+            }
+        }
+
+      create_reduced_nonlinearity_block
+      (dof_handler, quad, new_pod_vectors, old_filtered_pod_vectors,
+       old_pod_vectors, block, subdomain_id);
+      for (unsigned int i = n_old_pod_dofs; i < n_pod_dofs; ++i)
+        {
+          for (unsigned int j = 0; j < n_old_pod_dofs; ++j)
+            {
+              for (unsigned int k = 0; k < n_old_pod_dofs; ++k)
                 {
-                  nonlinear_operator[i](j, k) = pod_vectors.at(i)*temp;
+                  nonlinear_operator[i](j, k) = block[i - n_old_pod_dofs](j, k);
                 }
             }
         }
@@ -540,11 +1412,13 @@ namespace POD
      BlockVector<double>              &filtered_solution,
      BlockVector<double>              &solution,
      std::vector<BlockVector<double>> &pod_vectors,
-     Vector<double>                   &contribution)
+     Vector<double>                   &contribution,
+     const types::subdomain_id         subdomain_id = numbers::invalid_subdomain_id)
     {
       SparseMatrix<double> full_advection(sparsity_pattern);
       create_advective_linearization
-      (dof_handler, quad, filtered_solution, full_advection);
+      (dof_handler, color_cells(dof_handler, subdomain_id), quad,
+       filtered_solution, full_advection);
       contribution.reinit(pod_vectors.size());
 
       BlockVector<double> right_vector(dim, pod_vectors.at(0).block(0).size());
@@ -570,10 +1444,13 @@ namespace POD
      const Quadrature<dim>                  &quad,
      const BlockVector<double>              &solution,
      const std::vector<BlockVector<double>> &pod_vectors,
-     FullMatrix<double>                     &advection)
+     FullMatrix<double>                     &advection,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
     {
       SparseMatrix<double> full_advection(sparsity_pattern);
-      create_advective_linearization(dof_handler, quad, solution, full_advection);
+      create_advective_linearization
+      (dof_handler, color_cells(dof_handler, subdomain_id), quad, solution,
+       full_advection);
       advection.reinit(pod_vectors.size(), pod_vectors.size());
 
       BlockVector<double> temp(dim, pod_vectors.at(0).block(0).size());
@@ -596,70 +1473,284 @@ namespace POD
     template<int dim>
     void create_reduced_gradient_linearization
     (const DoFHandler<dim>                  &dof_handler,
-     const SparsityPattern                  &sparsity_pattern,
      const Quadrature<dim>                  &quad,
      const BlockVector<double>              &solution,
      const std::vector<BlockVector<double>> &pod_vectors,
      FullMatrix<double>                     &gradient)
     {
       create_reduced_gradient_linearization
-      (dof_handler, sparsity_pattern, quad, solution, pod_vectors,
-       pod_vectors, gradient);
+      (dof_handler, quad, solution, pod_vectors, pod_vectors, gradient);
     }
 
 
+    /*
+     * Compute the reduced gradient linearization
+     *
+     * gradient(i, j) = (pod_vectors[i], (filtered_pod_vectors[j] . grad) solution)
+     *
+     * in a single pass over the cells. The gradient of the solution is
+     * evaluated once per quadrature point and the POD vectors are contracted
+     * against it directly, so none of the dim x dim global gradient matrices
+     * are ever assembled. The two sets of POD vectors need not be the same
+     * size, in which case gradient is rectangular.
+     *
+     * If subdomain_id is given then only the cells with that subdomain id are
+     * integrated over: summing the results over every subdomain gives the
+     * full matrix. The same holds for the other reduced assembly functions
+     * that take a subdomain id.
+     */
     template<int dim>
     void create_reduced_gradient_linearization
     (const DoFHandler<dim>                  &dof_handler,
-     const SparsityPattern                  &sparsity_pattern,
      const Quadrature<dim>                  &quad,
      const BlockVector<double>              &solution,
      const std::vector<BlockVector<double>> &pod_vectors,
      const std::vector<BlockVector<double>> &filtered_pod_vectors,
-     FullMatrix<double>                     &gradient)
+     FullMatrix<double>                     &gradient,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
     {
-      ArrayArray<dim> gradient_matrices;
-      for (auto &row : gradient_matrices)
+      auto &fe = dof_handler.get_fe();
+      const unsigned int dofs_per_cell = fe.dofs_per_cell;
+      const unsigned int n_q_points = quad.size();
+      const unsigned int n_pod_dofs = pod_vectors.size();
+      const unsigned int n_filtered_pod_dofs = filtered_pod_vectors.size();
+      const bool filtered_vectors_are_distinct
+        = &pod_vectors != &filtered_pod_vectors;
+      gradient.reinit(n_pod_dofs, n_filtered_pod_dofs);
+
+      // The point values are the gradient of the solution, stored as
+      // point_values[(q*dim + row_n)*dim + derivative_n].
+      internal::ReducedAssemblyScratchData<dim> sample_scratch_data
+      (fe, quad, update_values | update_gradients | update_JxW_values,
+       n_pod_dofs, n_filtered_pod_dofs, dim*dim*n_q_points);
+      internal::ReducedAssemblyCopyData sample_copy_data(n_pod_dofs,
+                                                         n_filtered_pod_dofs);
+
+      auto worker =
+        [&](const typename DoFHandler<dim>::active_cell_iterator &cell,
+            internal::ReducedAssemblyScratchData<dim>            &scratch_data,
+            internal::ReducedAssemblyCopyData                    &copy_data)
+      {
+        FEValues<dim> &fe_values = scratch_data.fe_values;
+        std::vector<double> &local_gradient_values = scratch_data.point_values;
+        fe_values.reinit(cell);
+        cell->get_dof_indices(scratch_data.local_indices);
+
+        std::fill(local_gradient_values.begin(), local_gradient_values.end(),
+                  0.0);
+        for (unsigned int row_n = 0; row_n < dim; ++row_n)
+          {
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+              {
+                const double coefficient
+                  = solution.block(row_n)[scratch_data.local_indices[i]];
+                for (unsigned int q = 0; q < n_q_points; ++q)
+                  {
+                    for (unsigned int derivative_n = 0; derivative_n < dim;
+                         ++derivative_n)
+                      {
+                        local_gradient_values[(q*dim + row_n)*dim + derivative_n]
+                          += coefficient*fe_values.shape_grad(i, q)[derivative_n];
+                      }
+                  }
+              }
+          }
+
+        internal::evaluate_pod_values
+        (fe_values, scratch_data.local_indices, pod_vectors,
+         scratch_data.pod_values);
+        if (filtered_vectors_are_distinct)
+          {
+            internal::evaluate_pod_values
+            (fe_values, scratch_data.local_indices, filtered_pod_vectors,
+             scratch_data.filtered_pod_values);
+          }
+        const FullMatrix<double> &filtered_values = filtered_vectors_are_distinct
+                                                    ? scratch_data.filtered_pod_values
+                                                    : scratch_data.pod_values;
+
+        // weighted_values(j, q*dim + row_n) = JxW (psi_j . grad) u_{row_n}
+        for (unsigned int j = 0; j < n_filtered_pod_dofs; ++j)
+          {
+            for (unsigned int q = 0; q < n_q_points; ++q)
+              {
+                const double JxW = fe_values.JxW(q);
+                for (unsigned int row_n = 0; row_n < dim; ++row_n)
+                  {
+                    double value = 0.0;
+                    for (unsigned int derivative_n = 0; derivative_n < dim;
+                         ++derivative_n)
+                      {
+                        value += local_gradient_values[(q*dim + row_n)*dim + derivative_n]
+                                 *filtered_values(j, q*dim + derivative_n);
+                      }
+                    scratch_data.weighted_values(j, q*dim + row_n) = JxW*value;
+                  }
+              }
+          }
+
+        scratch_data.pod_values.mTmult(copy_data.local_matrix,
+                                       scratch_data.weighted_values);
+      };
+
+      auto copier = [&](const internal::ReducedAssemblyCopyData &copy_data)
+      {
+        gradient.add(1.0, copy_data.local_matrix);
+      };
+
+      WorkStream::run(begin_owned_active(dof_handler, subdomain_id),
+                      end_owned_active(dof_handler, subdomain_id), worker,
+                      copier, sample_scratch_data, sample_copy_data);
+    }
+
+
+    /*
+     * Extend a reduced gradient linearization computed with the first
+     * gradient.m() POD vectors to all of them: the new columns are computed
+     * for every row and the new rows only for the old columns.
+     */
+    template<int dim>
+    void extend_reduced_gradient_linearization
+    (const DoFHandler<dim>                  &dof_handler,
+     const Quadrature<dim>                  &quad,
+     const BlockVector<double>              &solution,
+     const std::vector<BlockVector<double>> &pod_vectors,
+     const std::vector<BlockVector<double>> &filtered_pod_vectors,
+     FullMatrix<double>                     &gradient,
+     const types::subdomain_id               subdomain_id = numbers::invalid_subdomain_id)
+    {
+      const unsigned int n_pod_dofs = pod_vectors.size();
+      const unsigned int n_old_pod_dofs = gradient.m();
+      AssertThrow(n_old_pod_dofs <= n_pod_dofs,
+                  ExcMessage("The reduced matrix is larger than the POD basis."));
+      if (n_old_pod_dofs == n_pod_dofs)
         {
-          for (auto &matrix : row)
-            {
-              matrix.reinit(sparsity_pattern);
-            }
+          return;
         }
-      create_gradient_linearization(dof_handler, quad, solution,
-                                    gradient_matrices);
-      gradient.reinit(pod_vectors.size(), pod_vectors.size());
 
-      BlockVector<double> temp(dim, pod_vectors.at(0).block(0).size());
-      for (unsigned int j = 0; j < pod_vectors.size(); ++j)
+      const std::vector<BlockVector<double>> new_pod_vectors
+        (pod_vectors.begin() + n_old_pod_dofs, pod_vectors.end());
+      const std::vector<BlockVector<double>> old_filtered_pod_vectors
+        (filtered_pod_vectors.begin(),
+         filtered_pod_vectors.begin() + n_old_pod_dofs);
+      const std::vector<BlockVector<double>> new_filtered_pod_vectors
+        (filtered_pod_vectors.begin() + n_old_pod_dofs,
+         filtered_pod_vectors.end());
+
+      FullMatrix<double> old_gradient;
+      old_gradient.swap(gradient);
+      gradient.reinit(n_pod_dofs, n_pod_dofs);
+      gradient.fill(old_gradient);
+
+      FullMatrix<double> new_columns;
+      create_reduced_gradient_linearization
+      (dof_handler, quad, solution, pod_vectors, new_filtered_pod_vectors,
+       new_columns, subdomain_id);
+      gradient.fill(new_columns, 0, n_old_pod_dofs);
+
+      FullMatrix<double> new_rows;
+      create_reduced_gradient_linearization
+      (dof_handler, quad, solution, new_pod_vectors, old_filtered_pod_vectors,
+       new_rows, subdomain_id);
+      gradient.fill(new_rows, n_old_pod_dofs, 0);
+    }
+
+
+    /*
+     * The boundary faces of a mesh, stored as (cell, face number) pairs and
+     * grouped by boundary id. This lets boundary integrals visit only the
+     * faces they need instead of checking every face of every cell. The index
+     * refers to the cells of the DoFHandler it was built from, so it must be
+     * rebuilt if the triangulation or DoFHandler changes.
+     */
+    template<int dim>
+    class BoundaryFaceIndex
+    {
+    public:
+      typedef std::pair<typename DoFHandler<dim>::active_cell_iterator,
+              unsigned int> CellFace;
+
+      BoundaryFaceIndex(const DoFHandler<dim> &dof_handler);
+
+      const std::vector<CellFace> &faces(const types::boundary_id boundary_id) const;
+
+      std::vector<types::boundary_id> get_boundary_ids() const;
+
+    private:
+      std::map<types::boundary_id, std::vector<CellFace>> boundary_faces;
+      const std::vector<CellFace> no_faces;
+    };
+
+
+    template<int dim>
+    BoundaryFaceIndex<dim>::BoundaryFaceIndex(const DoFHandler<dim> &dof_handler)
+    {
+      typename DoFHandler<dim>::active_cell_iterator
+      cell = dof_handler.begin_active(),
+      endc = dof_handler.end();
+
+      for (; cell != endc; ++cell)
         {
-          temp = 0.0;
-          auto &rhs_vector = filtered_pod_vectors.at(j);
-          for (unsigned int row_n = 0; row_n < gradient_matrices.size();
-               ++row_n)
+          if (!cell->at_boundary())
             {
-              for (unsigned int column_n = 0;
-                   column_n < gradient_matrices[0].size();
-                   ++column_n)
-                {
-                  gradient_matrices[row_n][column_n].vmult_add
-                  (temp.block(row_n), rhs_vector.block(column_n));
-                }
+              continue;
             }
-          for (unsigned int i = 0; i < pod_vectors.size(); ++i)
+          for (unsigned int face_n = 0; face_n < GeometryInfo<dim>::faces_per_cell;
+               ++face_n)
             {
-              auto &lhs_vector = pod_vectors.at(i);
-              gradient(i, j) = lhs_vector * temp;
+              if (cell->face(face_n)->at_boundary())
+                {
+                  boundary_faces[cell->face(face_n)->boundary_id()].emplace_back
+                  (cell, face_n);
+                }
             }
         }
     }
 
 
+    template<int dim>
+    const std::vector<typename BoundaryFaceIndex<dim>::CellFace> &
+    BoundaryFaceIndex<dim>::faces(const types::boundary_id boundary_id) const
+    {
+      const auto faces_it = boundary_faces.find(boundary_id);
+      if (faces_it == boundary_faces.end())
+        {
+          return no_faces;
+        }
+      return faces_it->second;
+    }
+
+
+    template<int dim>
+    std::vector<types::boundary_id> BoundaryFaceIndex<dim>::get_boundary_ids() const
+    {
+      std::vector<types::boundary_id> boundary_ids;
+      for (const auto &pair : boundary_faces)
+        {
+          boundary_ids.push_back(pair.first);
+        }
+      return boundary_ids;
+    }
+
+
     template<int dim>
     void create_boundary_matrix(const DoFHandler<dim> &dof_handler,
                                 const Quadrature<dim - 1> &face_quad,
                                 const unsigned int outflow_label,
                                 SparseMatrix<double> &boundary_matrix)
+    {
+      const BoundaryFaceIndex<dim> boundary_face_index(dof_handler);
+      create_boundary_matrix(dof_handler, boundary_face_index, face_quad,
+                             outflow_label, boundary_matrix);
+    }
+
+
+    template<int dim>
+    void create_boundary_matrix(const DoFHandler<dim> &dof_handler,
+                                const BoundaryFaceIndex<dim> &boundary_face_index,
+                                const Quadrature<dim - 1> &face_quad,
+                                const unsigned int outflow_label,
+                                SparseMatrix<double> &boundary_matrix)
     {
       auto &fe = dof_handler.get_fe();
       const unsigned int dofs_per_cell = fe.dofs_per_cell;
@@ -668,50 +1759,32 @@ namespace POD
       FEFaceValues<dim> fe_face_values(fe, face_quad, update_values |
                                        update_gradients | update_JxW_values);
 
-      typename DoFHandler<dim>::active_cell_iterator
-      cell = dof_handler.begin_active(),
-      endc = dof_handler.end();
-
-      for (; cell != endc; ++cell)
+      for (const auto &cell_face : boundary_face_index.faces(outflow_label))
         {
+          const auto &cell = cell_face.first;
+          const unsigned int face_n = cell_face.second;
           cell_matrix = 0;
           cell->get_dof_indices(local_indices);
-
-          for (unsigned int face_n = 0; face_n < GeometryInfo<dim>::faces_per_cell;
-               ++face_n)
+          fe_face_values.reinit(cell, face_n);
+          for (unsigned int i = 0; i < dofs_per_cell; ++i)
             {
-              if (cell->face(face_n)->at_boundary()
-                  && cell->face(face_n)->boundary_id() == outflow_label)
+              // Note that even if the jth basis function does not have
+              // support on a face then its derivative may have support.
+              if (fe.has_support_on_face(i, face_n))
                 {
-                  fe_face_values.reinit(cell, face_n);
-                  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                  for (unsigned int j = 0; j < dofs_per_cell; ++j)
                     {
-                      // Note that even if the jth basis function does not have
-                      // support on a face then its derivative may have support.
-                      if (fe.has_support_on_face(i, face_n))
+                      for (unsigned int q = 0; q < face_quad.size(); ++q)
                         {
-                          for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                            {
-                              for (unsigned int q = 0; q < face_quad.size(); ++q)
-                                {
-                                  cell_matrix(i, j) +=
-                                    fe_face_values.shape_value(i, q) *
-                                    fe_face_values.shape_grad(j, q)[0] *
-                                    fe_face_values.JxW(q);
-                                }
-                            }
+                          cell_matrix(i, j) +=
+                            fe_face_values.shape_value(i, q) *
+                            fe_face_values.shape_grad(j, q)[0] *
+                            fe_face_values.JxW(q);
                         }
                     }
                 }
             }
-          for (unsigned int i = 0; i < dofs_per_cell; ++i)
-            {
-              for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                {
-                  boundary_matrix.add(local_indices[i], local_indices[j],
-                                      cell_matrix(i, j));
-                }
-            }
+          boundary_matrix.add(local_indices, cell_matrix);
         }
     }
   }
@@ -0,0 +1,141 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_quadratic_operator_h
+#define dealii__rom_quadratic_operator_h
+#include <deal.II/base/aligned_vector.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    /*
+     * The quadratic term of the ROM, i.e., the 3-tensor N with
+     *
+     * N(i, j, k) = nonlinear_operator[i](j, k),
+     *
+     * stored in one contiguous, aligned buffer at i*r*r + j*r + k. Each
+     * evaluation streams through the buffer exactly once, so the hardware
+     * prefetcher sees a single sequential read and the (short) input vectors
+     * stay in the first level cache.
+     *
+     * If the operator is only ever applied to one vector (i.e., a = b below)
+     * then it may be stored in symmetric form: since
+     *
+     * a^T N_i a = a^T ((N_i + N_i^T)/2) a,
+     *
+     * only the upper triangle of N_i + N_i^T (with the diagonal of N_i) is
+     * kept, which halves both the storage and the number of flops.
+     *
+     * The entries are stored with type Number while the sums are accumulated
+     * with type AccumulationNumber, so QuadraticOperator<float, double> halves
+     * the memory traffic but keeps double precision sums. It is instantiated
+     * for <double>, <float> and <float, double>.
+     */
+    template<typename Number, typename AccumulationNumber = Number>
+    class QuadraticOperator
+    {
+    public:
+      enum class Storage
+      {
+        full,
+        symmetric
+      };
+
+      QuadraticOperator();
+      QuadraticOperator(const std::vector<FullMatrix<double>> &nonlinear_operator,
+                        const Storage storage = Storage::full);
+
+      unsigned int size() const;
+      Storage get_storage() const;
+
+      /*
+       * dst(i) += factor * a^T N_i b. Only available for full storage.
+       */
+      void vmult_add(Vector<AccumulationNumber> &dst,
+                     const Vector<Number>       &a,
+                     const Vector<Number>       &b,
+                     const AccumulationNumber    factor = 1.0) const;
+
+      /*
+       * dst(i) += factor * a^T N_i a.
+       */
+      void vmult_add(Vector<AccumulationNumber> &dst,
+                     const Vector<Number>       &a,
+                     const AccumulationNumber    factor = 1.0) const;
+
+      /*
+       * dst(i) += factor * a^T N_i b, where a is treated as zero past its
+       * first n_leading entries (which are not read). This only touches the
+       * first n_leading rows of each slice, so it costs r * r * n_leading
+       * instead of r^3 flops. Only available for full storage.
+       */
+      void vmult_add_leading(Vector<AccumulationNumber> &dst,
+                             const Vector<Number>       &a,
+                             const Vector<Number>       &b,
+                             const unsigned int          n_leading,
+                             const AccumulationNumber    factor = 1.0) const;
+
+      /*
+       * dst(i) += factor * a^T N_i a for i >= n_leading, where a is treated
+       * as zero before entry n_leading (the leading entries of a and dst are
+       * not used). This only touches the trailing block of each trailing
+       * slice, so it costs (r - n_leading)^3 flops.
+       */
+      void vmult_add_trailing(Vector<AccumulationNumber> &dst,
+                              const Vector<Number>       &a,
+                              const unsigned int          n_leading,
+                              const AccumulationNumber    factor = 1.0) const;
+
+      /*
+       * dst += factor * the derivative of a -> (a^T N_i a)_i, i.e., row i of
+       * dst gets factor * a^T (N_i + N_i^T).
+       */
+      void jacobian_add(FullMatrix<Number>   &dst,
+                        const Vector<Number> &a,
+                        const Number          factor = 1.0) const;
+
+      /*
+       * dst += factor * the derivative of a -> (a^T N_i b)_i, i.e., row i of
+       * dst gets factor * (N_i b)^T. Only available for full storage.
+       */
+      void left_jacobian_add(FullMatrix<Number>   &dst,
+                             const Vector<Number> &b,
+                             const Number          factor = 1.0) const;
+
+      /*
+       * dst += factor * the derivative of b -> (a^T N_i b)_i, i.e., row i of
+       * dst gets factor * a^T N_i. Only available for full storage.
+       */
+      void right_jacobian_add(FullMatrix<Number>   &dst,
+                              const Vector<Number> &a,
+                              const Number          factor = 1.0) const;
+
+    private:
+      unsigned int n_pod_dofs;
+      Storage storage;
+      AlignedVector<Number> values;
+    };
+  }
+}
+#endif
@@ -0,0 +1,119 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_ode_fixed_size_h
+#define dealii__rom_ode_fixed_size_h
+#include <deal.II/lac/vector.h>
+
+#include <array>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace ODE
+  {
+    /*
+     * The classical fourth order Runge-Kutta method for systems whose size n is
+     * known at compile time. The stages live in std::arrays and the right hand
+     * side is called through RHS::apply(std::array &, const std::array &),
+     * which is not virtual, so the whole step may be inlined and unrolled.
+     *
+     * RHS must also derive from OperatorBase: it is owned by RungeKuttaBase
+     * like any other right hand side.
+     */
+    template<int n, typename RHS>
+    class RungeKutta4Fixed : public RungeKuttaBase<double>
+    {
+    public:
+      typedef std::array<double, n> VectorType;
+
+      RungeKutta4Fixed(std::unique_ptr<RHS> rhs_function);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+      void step(const double time_step, const VectorType &src, VectorType &dst);
+
+    private:
+      // rhs_function, but with its actual type
+      RHS *fixed_rhs_function;
+
+      VectorType temp;
+      VectorType step_1;
+      VectorType step_2;
+      VectorType step_3;
+      VectorType step_4;
+      VectorType src_values;
+      VectorType dst_values;
+    };
+
+
+    template<int n, typename RHS>
+    RungeKutta4Fixed<n, RHS>::RungeKutta4Fixed(std::unique_ptr<RHS> rhs_function)
+      : RungeKuttaBase<double>(nullptr),
+        fixed_rhs_function {rhs_function.get()}
+    {
+      this->rhs_function = std::move(rhs_function);
+      this->n_dofs = n;
+    }
+
+
+    template<int n, typename RHS>
+    void RungeKutta4Fixed<n, RHS>::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      Assert(src.size() == n, ExcDimensionMismatch(src.size(), n));
+      Assert(dst.size() == n, ExcDimensionMismatch(dst.size(), n));
+      std::copy(src.begin(), src.end(), src_values.begin());
+      step(time_step, src_values, dst_values);
+      std::copy(dst_values.begin(), dst_values.end(), dst.begin());
+    }
+
+
+    template<int n, typename RHS>
+    void RungeKutta4Fixed<n, RHS>::step
+    (const double time_step, const VectorType &src, VectorType &dst)
+    {
+      fixed_rhs_function->apply(step_1, src);
+      for (int i = 0; i < n; ++i)
+        {
+          temp[i] = src[i] + 0.5*time_step*step_1[i];
+        }
+      fixed_rhs_function->apply(step_2, temp);
+      for (int i = 0; i < n; ++i)
+        {
+          temp[i] = src[i] + 0.5*time_step*step_2[i];
+        }
+      fixed_rhs_function->apply(step_3, temp);
+      for (int i = 0; i < n; ++i)
+        {
+          temp[i] = src[i] + time_step*step_3[i];
+        }
+      fixed_rhs_function->apply(step_4, temp);
+
+      for (int i = 0; i < n; ++i)
+        {
+          dst[i] = src[i] + time_step/6.0*step_1[i] + time_step/3.0*step_2[i]
+                   + time_step/3.0*step_3[i] + time_step/6.0*step_4[i];
+        }
+    }
+  }
+}
+#endif
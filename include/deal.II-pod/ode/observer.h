@@ -0,0 +1,178 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_ode_observer_h
+#define dealii__rom_ode_observer_h
+#include <deal.II/base/thread_management.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace ODE
+  {
+    /*
+     * Something (an output writer, a running statistic, a monitor) that looks
+     * at the solution after every interval-th time step. If the observer is
+     * asynchronous then observe is called on another thread with a copy of
+     * the solution, so the time loop does not wait for it; the calls for one
+     * observer never overlap and are made in order.
+     */
+    class StepObserver
+    {
+    public:
+      StepObserver(const unsigned int interval = 1,
+                   const bool asynchronous = false);
+      virtual ~StepObserver() = default;
+
+      /*
+       * Called after step step_n (counting from zero) when step_n is a
+       * multiple of the interval.
+       */
+      virtual void observe(const unsigned int step_n, const double time,
+                           const Vector<double> &solution) = 0;
+
+      /*
+       * Return true to stop the time loop. For asynchronous observers this is
+       * only checked once their previous observation has finished, so the
+       * loop may run on for up to interval steps.
+       */
+      virtual bool stop_requested() const;
+
+      unsigned int get_interval() const;
+      bool is_asynchronous() const;
+
+    protected:
+      const unsigned int interval;
+      const bool asynchronous;
+    };
+
+
+    /*
+     * A StepObserver that calls a function.
+     */
+    class FunctionStepObserver : public StepObserver
+    {
+    public:
+      typedef std::function<void (const unsigned int, const double,
+                                  const Vector<double> &)> FunctionType;
+
+      FunctionStepObserver(const FunctionType &function,
+                           const unsigned int interval = 1,
+                           const bool asynchronous = false);
+
+      virtual void observe(const unsigned int step_n, const double time,
+                           const Vector<double> &solution) override;
+
+    protected:
+      const FunctionType function;
+    };
+
+
+    /*
+     * A cheap check for blow up: requests a stop once the solution a has an
+     * entry that is not finite, once its energy a^T M a exceeds max_energy,
+     * or once one of its entries exceeds max_coefficient in absolute value.
+     * A threshold of zero disables that check.
+     */
+    class DivergenceMonitor : public StepObserver
+    {
+    public:
+      DivergenceMonitor(const FullMatrix<double> &mass_matrix,
+                        const double max_energy,
+                        const double max_coefficient,
+                        const unsigned int interval = 1);
+
+      virtual void observe(const unsigned int step_n, const double time,
+                           const Vector<double> &solution) override;
+
+      virtual bool stop_requested() const override;
+
+      /*
+       * Print why and when the solution diverged, along with the thresholds.
+       */
+      void print_diagnostics(std::ostream &out) const;
+
+    protected:
+      const FullMatrix<double> mass_matrix;
+      const double max_energy;
+      const double max_coefficient;
+      Vector<double> mass_solution;
+
+      // the values from the last observation and the reason for stopping, if
+      // there is one.
+      unsigned int last_step_n;
+      double last_time;
+      double energy;
+      double largest_coefficient;
+      std::string reason;
+    };
+
+
+    /*
+     * The observers of one time loop. The observers are not owned and must
+     * outlive this object (or the last call to finish). All observers must be
+     * added before the first call to notify.
+     */
+    class StepObserverList
+    {
+    public:
+      ~StepObserverList();
+
+      void add(StepObserver &observer);
+
+      /*
+       * Notify the observers that are due after step step_n. Returns true if
+       * any observer requested that the time loop stop.
+       */
+      bool notify(const unsigned int step_n, const double time,
+                  const Vector<double> &solution);
+
+      /*
+       * Wait for all asynchronous observations to finish. Returns true if any
+       * observer requested that the time loop stop.
+       */
+      bool finish();
+
+    protected:
+      struct Entry
+      {
+        StepObserver *observer;
+        // the solution copied for and the task running the last asynchronous
+        // observation.
+        Vector<double> solution;
+        Threads::Task<> task;
+        bool task_running;
+      };
+
+      /*
+       * Wait for the last observation of entry, if there is one.
+       */
+      void join(Entry &entry);
+
+      std::vector<Entry> entries;
+    };
+  }
+}
+#endif
@@ -17,9 +17,13 @@
  */
 #ifndef dealii__rom_ode_pod_h
 #define dealii__rom_ode_pod_h
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/lapack_full_matrix.h>
 #include <deal.II/lac/vector.h>
 
+#include <limits>
 #include <memory>
+#include <vector>
 
 namespace POD
 {
@@ -27,60 +31,597 @@ namespace POD
 
   namespace ODE
   {
+    /*
+     * A set of scratch vectors that are allocated once and then reused, so
+     * that applying an operator or taking a time step does not touch the heap.
+     * Vectors are accessed by index; each class documents which indices it
+     * uses.
+     */
+    template<typename Number>
+    class Workspace
+    {
+    public:
+      /*
+       * Make sure that there are at least n_vectors vectors and that the
+       * first n_vectors of them have the given size. This only allocates if
+       * either the number or the size of the vectors grows.
+       */
+      void reserve(const unsigned int n_vectors, const unsigned int size);
+
+      Vector<Number> &operator[](const unsigned int n);
+      const Vector<Number> &operator[](const unsigned int n) const;
+
+      unsigned int n_vectors() const;
+
+    private:
+      std::vector<Vector<Number>> vectors;
+    };
+
+
+    /*
+     * The classes below are templated on the type of the state vector. Most
+     * of them are only instantiated for double; Workspace, EmptyOperator,
+     * RungeKuttaBase, RungeKutta4 and RungeKutta4PostFilter are also
+     * instantiated for float so that a ROM may be integrated in single
+     * precision.
+     */
+    template<typename Number>
     class OperatorBase
     {
     public:
-      virtual void apply(Vector<double> &dst, const Vector<double> &src) = 0;
+      virtual void apply(Vector<Number> &dst, const Vector<Number> &src) = 0;
       virtual ~OperatorBase() = default;
+    protected:
+      Workspace<Number> workspace;
+    };
+
+    /*
+     * An operator that can also compute its derivative. This is required by
+     * the implicit integrators below.
+     */
+    template<typename Number>
+    class JacobianOperator : public OperatorBase<Number>
+    {
+    public:
+      /*
+       * Set jacobian to the derivative of apply at src.
+       */
+      virtual void compute_jacobian(FullMatrix<Number> &jacobian,
+                                    const Vector<Number> &src) = 0;
+    };
+
+    /*
+     * Interface for right hand sides of the form
+     *
+     * f(y) = A y + g(y)
+     *
+     * with a constant matrix A. The IMEX integrators below treat A y
+     * implicitly and g(y) explicitly.
+     */
+    template<typename Number>
+    class SplitOperator
+    {
+    public:
+      virtual const FullMatrix<Number> &get_linear_part() const = 0;
+
+      /*
+       * Set dst to g(src).
+       */
+      virtual void apply_nonlinear_part(Vector<Number> &dst,
+                                        const Vector<Number> &src) = 0;
+
+      virtual ~SplitOperator() = default;
+    };
+
+
+    /*
+     * Interface for right hand sides whose components are split into the
+     * first n_slow (slow) and the remaining (fast) components. The multirate
+     * integrator below evaluates the fast components many times with the slow
+     * ones held fixed, so implementations may precompute everything that
+     * only depends on the slow components.
+     */
+    template<typename Number>
+    class PartitionedOperator
+    {
+    public:
+      /*
+       * Hold the first n_slow components at those of src in subsequent calls
+       * to apply_fast_part.
+       */
+      virtual void freeze_slow_part(const Vector<Number> &src,
+                                    const unsigned int n_slow) = 0;
+
+      /*
+       * Set the fast components of dst to those of f(y), where y has the
+       * frozen slow components and the fast components of src. The slow
+       * components of src are not read and those of dst are not written.
+       */
+      virtual void apply_fast_part(Vector<Number> &dst,
+                                   const Vector<Number> &src) = 0;
+
+      virtual ~PartitionedOperator() = default;
+    };
+
+
+    /*
+     * Interface for right hand sides whose result depends on more than their
+     * argument, e.g., on the counter of a random number generator. The state
+     * is stored in a vector so that it can be written to a checkpoint.
+     */
+    class StatefulOperator
+    {
+    public:
+      virtual void save_state(Vector<double> &state) const = 0;
+      virtual void load_state(const Vector<double> &state) = 0;
+
+      virtual ~StatefulOperator() = default;
     };
 
     // Empty object, so that we may instantiate things without null pointers. It
     // is not quite a null object since EmptyOperator::apply throws an exception.
-    class EmptyOperator : public OperatorBase
+    template<typename Number>
+    class EmptyOperator : public OperatorBase<Number>
     {
-      virtual void apply(Vector<double> &dst, const Vector<double> &src) override;
+      virtual void apply(Vector<Number> &dst, const Vector<Number> &src) override;
     };
 
 
+    template<typename Number>
     class RungeKuttaBase
     {
     public:
-      RungeKuttaBase(std::unique_ptr<OperatorBase> rhs_function);
+      RungeKuttaBase(std::unique_ptr<OperatorBase<Number>> rhs_function);
       virtual void step
-      (double time_step, const Vector<double> &src, Vector<double> &dst) = 0;
+      (double time_step, const Vector<Number> &src, Vector<Number> &dst) = 0;
+
+      /*
+       * Copy everything (other than its arguments) that the next call to step
+       * depends on into state, so that the integration can be restarted by
+       * calling load_state on a new integrator. By default this is the state
+       * of the right hand side, if it is a StatefulOperator. Cached
+       * factorizations are not part of the state: they only change results
+       * within the solver tolerances.
+       */
+      virtual void save_state(Vector<double> &state) const;
+      virtual void load_state(const Vector<double> &state);
+
       virtual ~RungeKuttaBase() = default;
     protected:
-      std::unique_ptr<OperatorBase> rhs_function;
+      std::unique_ptr<OperatorBase<Number>> rhs_function;
       unsigned int n_dofs;
+      Workspace<Number> workspace;
     };
 
 
-    class RungeKutta4 : public RungeKuttaBase
+    template<typename Number>
+    class RungeKutta4 : public RungeKuttaBase<Number>
     {
     public:
       RungeKutta4();
-      RungeKutta4(std::unique_ptr<OperatorBase> rhs_function);
+      RungeKutta4(std::unique_ptr<OperatorBase<Number>> rhs_function);
+      void step(double time_step, const Vector<Number> &src,
+                Vector<Number> &dst) override;
+    protected:
+      // the temporary vector and the four stages live in workspace[0] through
+      // workspace[4].
+      static constexpr unsigned int n_workspace_vectors = 5;
+    };
+
+
+    template<typename Number>
+    class RungeKutta4PostFilter : public RungeKutta4<Number>
+    {
+    public:
+      RungeKutta4PostFilter
+      (std::unique_ptr<OperatorBase<Number>> rhs_function,
+       std::unique_ptr<OperatorBase<Number>> filter_function);
+      void step
+      (double time_step, const Vector<Number> &src, Vector<Number> &dst) override;
+    protected:
+      std::unique_ptr<OperatorBase<Number>> filter_function;
+    };
+
+
+    /*
+     * Explicit Runge-Kutta schemes in Williamson's 2N-storage form: each
+     * stage does
+     *
+     * du = a_i du + h f(u)
+     * u  = u + b_i du
+     *
+     * in a single sweep, so a step only touches the solution, one register,
+     * and the output of the right hand side. Williamson3 is the third order
+     * three stage scheme of Williamson (Journal of Computational Physics,
+     * 1980) and CarpenterKennedy4 is the fourth order five stage scheme
+     * RK4(3)5[2N] of Carpenter and Kennedy (NASA TM-109112, 1994), whose
+     * stability region extends further along the real and imaginary axes
+     * than that of the classical RK4.
+     */
+    enum class LowStorageScheme
+    {
+      Williamson3,
+      CarpenterKennedy4
+    };
+
+
+    class LowStorageRungeKutta : public RungeKuttaBase<double>
+    {
+    public:
+      LowStorageRungeKutta(std::unique_ptr<OperatorBase<double>> rhs_function,
+                           const LowStorageScheme scheme);
       void step(double time_step, const Vector<double> &src,
                 Vector<double> &dst) override;
+    protected:
+      std::vector<double> register_coefficients;
+      std::vector<double> solution_coefficients;
+
+      // workspace[0] is the register du and workspace[1] is f(u).
+      static constexpr unsigned int n_workspace_vectors = 2;
+    };
+
+
+    /*
+     * A slow-fast partitioned multirate method for a PartitionedOperator. Each
+     * step of size h
+     *
+     * 1. advances the slow components with one RK4 step while the fast
+     *    components are held at their values at the start of the step, and
+     * 2. advances the fast components with n_substeps RK4 steps of size
+     *    h/n_substeps while the slow components are held at the average of
+     *    their old and new values.
+     *
+     * Hence only the fast components are sub-stepped and everything that
+     * couples them to the slow components is evaluated once per step. The
+     * method is second order in the slow-to-fast coupling but only first
+     * order in the fast-to-slow coupling, so it is meant for systems whose
+     * fast components have small amplitude (like the trailing POD modes).
+     */
+    class MultirateRungeKutta : public RungeKuttaBase<double>
+    {
+    public:
+      /*
+       * rhs_function must also be a PartitionedOperator.
+       */
+      MultirateRungeKutta(std::unique_ptr<OperatorBase<double>> rhs_function,
+                          const unsigned int n_slow,
+                          const unsigned int n_substeps);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+    protected:
+      PartitionedOperator<double> *partitioned_function;
+      const unsigned int n_slow;
+      const unsigned int n_substeps;
+
+      // workspace[0] is the stage value, workspace[1] through workspace[4]
+      // are the stage derivatives, and workspace[5] is the new solution.
+      static constexpr unsigned int n_workspace_vectors = 6;
+    };
+
+
+    /*
+     * The embedded Runge-Kutta pair of Dormand and Prince (DOPRI5): the
+     * solution is advanced with the fifth order method and the step size is
+     * chosen so that the difference from the fourth order solution is
+     * below the given tolerances. The last stage of an accepted step is the
+     * first stage of the next one (first same as last) and each accepted
+     * step provides a continuous fourth order interpolant (dense output), so
+     * the solution may be sampled at arbitrary times without shortening the
+     * steps.
+     *
+     * The integrator may be used in two ways: either call initialize and then
+     * advance and interpolate, or use step, which advances the given vector
+     * by exactly time_step with as many internal steps as are necessary.
+     */
+    class DormandPrince54 : public RungeKuttaBase<double>
+    {
+    public:
+      DormandPrince54(std::unique_ptr<OperatorBase<double>> rhs_function,
+                      const double absolute_tolerance,
+                      const double relative_tolerance);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+      /*
+       * Set the current time and solution. initial_time_step is the size of
+       * the first attempted step.
+       */
+      void initialize(const double time, const Vector<double> &initial_condition,
+                      const double initial_time_step);
+
+      /*
+       * Take one accepted step, which will not go past maximum_time.
+       * Rejected steps are retried with a smaller step size.
+       */
+      void advance(const double maximum_time
+                   = std::numeric_limits<double>::infinity());
+
+      /*
+       * Evaluate the dense output of the last accepted step, i.e., time must
+       * be between get_previous_time() and get_time().
+       */
+      void interpolate(const double time, Vector<double> &dst);
+
+      double get_time() const;
+      double get_previous_time() const;
+      const Vector<double> &get_solution();
+
+      unsigned int n_accepted_steps() const;
+      unsigned int n_rejected_steps() const;
+
+    protected:
+      const double absolute_tolerance;
+      const double relative_tolerance;
+
+      double time;
+      double previous_time;
+      double next_time_step;
+
+      unsigned int accepted_step_count;
+      unsigned int rejected_step_count;
+
+      // workspace[0] is the argument of the stages, workspace[1] through
+      // workspace[7] are the seven stages, workspace[8] is the solution,
+      // workspace[9] is the trial solution, workspace[10] is the previous
+      // solution and workspace[11] through workspace[14] are the
+      // coefficients of the dense output.
+      static constexpr unsigned int n_workspace_vectors = 15;
+    };
+
+
+    /*
+     * Base class of the implicit integrators. Each step requires the solution
+     * of the nonlinear system
+     *
+     * y - factor f(y) = rhs,
+     *
+     * which is done with a simplified Newton method: the Jacobian of f and
+     * the LU factorization of I - factor J are kept between iterations and
+     * between steps and are only recomputed when the iteration stops
+     * converging (or, for the factorization, when factor changes).
+     */
+    class ImplicitIntegratorBase : public RungeKuttaBase<double>
+    {
+    public:
+      /*
+       * The Newton iteration stops when the l2 norm of the update is less
+       * than newton_tolerance times max(1, |y|).
+       */
+      ImplicitIntegratorBase(std::unique_ptr<JacobianOperator<double>> rhs_function,
+                             const double newton_tolerance,
+                             const unsigned int max_newton_iterations);
+
+      unsigned int n_jacobian_evaluations() const;
+      unsigned int n_newton_iterations() const;
+
+    protected:
+      /*
+       * Solve y - factor f(y) = rhs for y. y should contain an initial guess.
+       */
+      void solve(const double factor, const Vector<double> &rhs,
+                 Vector<double> &y);
+
+      // workspace[0] through workspace[2] are used by solve.
+      static constexpr unsigned int n_newton_workspace_vectors = 3;
+
     private:
-      Vector<double> temp;
-      Vector<double> step_1;
-      Vector<double> step_2;
-      Vector<double> step_3;
-      Vector<double> step_4;
+      void update_jacobian(const Vector<double> &src);
+      void factorize(const double factor);
+
+      JacobianOperator<double> *jacobian_operator;
+      const double newton_tolerance;
+      const unsigned int max_newton_iterations;
+
+      FullMatrix<double> jacobian;
+      FullMatrix<double> newton_matrix;
+      LAPACKFullMatrix<double> factorized_newton_matrix;
+      // factor used in the current factorization, or zero if there is none.
+      double factorized_factor;
+
+      unsigned int jacobian_evaluation_count;
+      unsigned int newton_iteration_count;
     };
 
 
-    class RungeKutta4PostFilter : public RungeKutta4
+    /*
+     * The (second order, A-stable) trapezoidal rule
+     *
+     * y_{n + 1} - h/2 f(y_{n + 1}) = y_n + h/2 f(y_n).
+     */
+    class CrankNicolson : public ImplicitIntegratorBase
     {
     public:
-      RungeKutta4PostFilter
-      (std::unique_ptr<OperatorBase> rhs_function,
-       std::unique_ptr<OperatorBase> filter_function);
-      void step
-      (double time_step, const Vector<double> &src, Vector<double> &dst) override;
+      CrankNicolson(std::unique_ptr<JacobianOperator<double>> rhs_function,
+                    const double newton_tolerance = 1.0e-10,
+                    const unsigned int max_newton_iterations = 10);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+    protected:
+      // workspace[3] is the right hand side of the nonlinear system and
+      // workspace[4] is the new solution.
+      static constexpr unsigned int n_workspace_vectors
+        = n_newton_workspace_vectors + 2;
+    };
+
+
+    /*
+     * The (second order, L-stable) backward differentiation formula
+     *
+     * y_{n + 1} - 2h/3 f(y_{n + 1}) = 4/3 y_n - 1/3 y_{n - 1}
+     *
+     * with a constant time step. The previous solution is stored, so step
+     * should be called with the output of the last call; if it is not (or
+     * if the time step changes) then a Crank-Nicolson step restarts the
+     * method.
+     */
+    class BDF2 : public CrankNicolson
+    {
+    public:
+      BDF2(std::unique_ptr<JacobianOperator<double>> rhs_function,
+           const double newton_tolerance = 1.0e-10,
+           const unsigned int max_newton_iterations = 10);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+      /*
+       * The state also contains the last two solutions, so that a restarted
+       * integration continues with BDF2 steps.
+       */
+      void save_state(Vector<double> &state) const override;
+      void load_state(const Vector<double> &state) override;
+
+    protected:
+      // workspace[5] is the solution at the start of the last step and
+      // workspace[6] is the solution at its end.
+      static constexpr unsigned int n_bdf_workspace_vectors
+        = CrankNicolson::n_workspace_vectors + 2;
+
+      double previous_time_step;
+    };
+
+
+    /*
+     * Implicit-explicit schemes of Ascher, Ruuth, and Spiteri (Applied
+     * Numerical Mathematics, 1997): ARS222 is second order with two
+     * implicit stages and ARS443 is third order with four. Both are
+     * L-stable and singly diagonally implicit, so every stage solves a
+     * system with the same matrix.
+     */
+    enum class IMEXScheme
+    {
+      ARS222,
+      ARS443
+    };
+
+
+    /*
+     * Additive Runge-Kutta integrator for a SplitOperator: the linear part is
+     * treated implicitly and the nonlinear part explicitly. The LU
+     * factorization of I - h gamma A is computed the first time a time step
+     * h is used and kept until the time step changes.
+     */
+    class IMEXRungeKutta : public RungeKuttaBase<double>
+    {
+    public:
+      /*
+       * rhs_function must also be a SplitOperator. If filter_function is not
+       * null then it is applied to the result of each step, like
+       * RungeKutta4PostFilter.
+       */
+      IMEXRungeKutta(std::unique_ptr<OperatorBase<double>> rhs_function,
+                     const IMEXScheme scheme,
+                     std::unique_ptr<OperatorBase<double>> filter_function
+                     = std::unique_ptr<OperatorBase<double>>());
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
     protected:
-      std::unique_ptr<OperatorBase> filter_function;
+      SplitOperator<double> *split_function;
+      std::unique_ptr<OperatorBase<double>> filter_function;
+
+      // the Butcher tableaux, including the explicit first stage
+      unsigned int n_stages;
+      FullMatrix<double> explicit_coefficients;
+      FullMatrix<double> implicit_coefficients;
+      Vector<double> explicit_weights;
+      Vector<double> implicit_weights;
+      double diagonal_coefficient;
+
+      // time step of the current factorization, or zero if there is none.
+      double factorized_time_step;
+      LAPACKFullMatrix<double> factorized_stage_matrix;
+
+      // workspace[0] is the stage value, workspace[1] is the unfiltered
+      // solution, and the next 2*n_stages vectors are the explicit and then
+      // the implicit stage derivatives.
+      static constexpr unsigned int n_fixed_workspace_vectors = 2;
+    };
+
+
+    /*
+     * The fourth order exponential time differencing scheme of Cox and
+     * Matthews (Journal of Computational Physics, 2002) for a SplitOperator
+     * y' = A y + g(y). The linear part is integrated exactly, so the time
+     * step is only limited by the nonlinear part.
+     *
+     * The matrix functions exp(hA), phi_k(hA) and phi_1(hA/2) are computed
+     * (with a Pade approximant and scaling and squaring) the first time a
+     * time step h is used and kept until the time step changes. Each step
+     * then costs four evaluations of the nonlinear part and a handful of
+     * dense matrix-vector products.
+     */
+    class ETDRungeKutta4 : public RungeKuttaBase<double>
+    {
+    public:
+      /*
+       * rhs_function must also be a SplitOperator.
+       */
+      ETDRungeKutta4(std::unique_ptr<OperatorBase<double>> rhs_function);
+
+      void step(double time_step, const Vector<double> &src,
+                Vector<double> &dst) override;
+
+    protected:
+      /*
+       * Compute the operators below for the time step h.
+       */
+      void compute_operators(const double time_step);
+
+      SplitOperator<double> *split_function;
+
+      // time step of the current operators, or zero if there are none.
+      double operator_time_step;
+      // exp(hA) and exp(hA/2)
+      FullMatrix<double> exponential;
+      FullMatrix<double> half_exponential;
+      // h/2 phi_1(hA/2)
+      FullMatrix<double> half_step_operator;
+      // the weights of g(y_n), g(a) + g(b), and g(c) in the final update.
+      FullMatrix<double> first_weight;
+      FullMatrix<double> middle_weight;
+      FullMatrix<double> last_weight;
+
+      // workspace[0] is exp(hA/2) y_n, workspace[1] through workspace[3] are
+      // the stage values a, b and c, workspace[4] through workspace[7] are
+      // g at y_n, a, b and c, and workspace[8] is a temporary.
+      static constexpr unsigned int n_workspace_vectors = 9;
+    };
+
+
+    /*
+     * Right hand sides for an ensemble of trajectories of the same system. Each
+     * column of src (and dst) is the state of one member of the ensemble, so
+     * the operators may be applied to every member at once with matrix-matrix
+     * products.
+     */
+    class EnsembleOperatorBase
+    {
+    public:
+      virtual void apply(FullMatrix<double> &dst, const FullMatrix<double> &src) = 0;
+      virtual ~EnsembleOperatorBase() = default;
+    };
+
+
+    class EnsembleRungeKutta4
+    {
+    public:
+      EnsembleRungeKutta4(std::unique_ptr<EnsembleOperatorBase> rhs_function);
+      void step(double time_step, const FullMatrix<double> &src,
+                FullMatrix<double> &dst);
+    private:
+      std::unique_ptr<EnsembleOperatorBase> rhs_function;
+      FullMatrix<double> temp;
+      FullMatrix<double> step_1;
+      FullMatrix<double> step_2;
+      FullMatrix<double> step_3;
+      FullMatrix<double> step_4;
     };
   }
 }
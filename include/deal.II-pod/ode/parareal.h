@@ -0,0 +1,108 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute
+ * it, and/or modify it under the terms of the GNU Lesser General
+ * Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#ifndef dealii__rom_ode_parareal_h
+#define dealii__rom_ode_parareal_h
+#include <deal.II/lac/vector.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ode/ode.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace ODE
+  {
+    /*
+     * The parareal method of Lions, Maday, and Turinici (Comptes Rendus de
+     * l'Academie des Sciences, 2001). The time interval is split into slices;
+     * each iteration advances every slice with the (expensive) fine integrator
+     * in parallel and then corrects the slice boundary values serially with
+     * the (cheap) coarse integrator:
+     *
+     * U_{n + 1}^{k + 1} = G(U_n^{k + 1}) + F(U_n^k) - G(U_n^k).
+     *
+     * The iteration stops when no boundary value changes by more than the
+     * given relative tolerance (in the max norm). After k iterations the
+     * first k slices agree with the serial fine solution, so at most n_slices
+     * iterations are done.
+     *
+     * Every slice has its own fine integrator, so the integrators need not be
+     * thread safe. The fine sweeps are run as deal.II tasks, so the number of
+     * threads is controlled by MultithreadInfo.
+     */
+    class Parareal
+    {
+    public:
+      typedef std::function<std::unique_ptr<RungeKuttaBase<double>>()>
+      IntegratorFactory;
+
+      /*
+       * The coarse integrator takes steps of (about) coarse_time_step, but
+       * always at least one per slice.
+       */
+      Parareal(const IntegratorFactory &create_coarse_integrator,
+               const double             coarse_time_step,
+               const IntegratorFactory &create_fine_integrator,
+               const unsigned int       n_slices,
+               const double             tolerance = 1.0e-8,
+               const unsigned int       max_iterations = 20);
+
+      /*
+       * Advance initial_condition by n_steps steps of the fine integrator
+       * with size time_step and put the result in dst. The solutions after
+       * steps 1, 1 + output_interval, 1 + 2*output_interval, ... are stored
+       * in outputs.
+       */
+      void run(const double                 time_step,
+               const unsigned int           n_steps,
+               const unsigned int           output_interval,
+               const Vector<double>        &initial_condition,
+               Vector<double>              &dst,
+               std::vector<Vector<double>> &outputs);
+
+      unsigned int n_iterations() const;
+
+    protected:
+      void coarse_propagate(const unsigned int slice_n, const Vector<double> &src,
+                            Vector<double> &dst);
+      void fine_propagate(const unsigned int slice_n, const Vector<double> &src,
+                          Vector<double> &dst);
+
+      const IntegratorFactory create_fine_integrator;
+      std::unique_ptr<RungeKuttaBase<double>> coarse_integrator;
+      std::vector<std::unique_ptr<RungeKuttaBase<double>>> fine_integrators;
+      const double coarse_time_step;
+      const unsigned int max_n_slices;
+      const double tolerance;
+      const unsigned int max_iterations;
+
+      // the settings of the current run. Slice n consists of the fine steps
+      // slice_begin[n] through slice_begin[n + 1] - 1.
+      double time_step;
+      unsigned int output_interval;
+      std::vector<unsigned int> slice_begin;
+      std::vector<std::vector<Vector<double>>> slice_outputs;
+
+      unsigned int n_done_iterations;
+    };
+  }
+}
+#endif
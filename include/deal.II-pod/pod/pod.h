@@ -112,6 +112,22 @@ namespace POD
                              const std::vector<unsigned int>        &dims,
                              FullMatrix<double>                     &rom_matrix);
 
+  /*
+   * Extend a reduced matrix computed with the first rom_matrix.m() POD vectors
+   * to all of them: only the new rows and columns are computed, which costs
+   * two sparse matrix-vector products per new POD vector instead of one per
+   * POD vector.
+   */
+  void extend_reduced_matrix(const std::vector<BlockVector<double>> &pod_vectors,
+                             const SparseMatrix<double>             &full_matrix,
+                             FullMatrix<double>                     &rom_matrix);
+
+
+  void extend_reduced_matrix(const std::vector<BlockVector<double>> &pod_vectors,
+                             const SparseMatrix<double>             &full_matrix,
+                             const std::vector<unsigned int>        &dims,
+                             FullMatrix<double>                     &rom_matrix);
+
   template<int dim>
   void create_dof_handler_from_triangulation_file
   (const std::string  &file_name,
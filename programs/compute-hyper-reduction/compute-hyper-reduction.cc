@@ -0,0 +1,237 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute it, and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/numerics/matrix_tools.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <deal.II-pod/extra/extra.h>
+#include <deal.II-pod/extra/nnls.h>
+#include <deal.II-pod/h5/h5.h>
+#include <deal.II-pod/ns/hyper_reduction.h>
+#include <deal.II-pod/pod/pod.h>
+
+#include "parameters.h"
+
+namespace HyperReduction
+{
+  using namespace dealii;
+  using namespace POD;
+
+  template<int dim>
+  class ComputeHyperReduction
+  {
+  public:
+    ComputeHyperReduction(const Parameters &parameters);
+    void run();
+  private:
+    void load_pod_vectors();
+    void project_training_snapshots();
+    void compute_cell_weights();
+    void save_reduced_quadrature();
+
+    const Parameters parameters;
+
+    FE_Q<dim> fe;
+    QGauss<dim> quad;
+    Triangulation<dim> triangulation;
+    SparsityPattern sparsity_pattern;
+    DoFHandler<dim> dof_handler;
+
+    std::vector<BlockVector<double>> pod_vectors;
+    BlockVector<double> mean_vector;
+
+    FullMatrix<double> training_coefficients;
+    Vector<double> cell_weights;
+  };
+
+
+  template<int dim>
+  ComputeHyperReduction<dim>::ComputeHyperReduction(const Parameters &params)
+    :
+    parameters(params),
+    fe(params.fe_order),
+    // this is the quadrature rule compute-pod-matrices uses for the
+    // nonlinearity.
+    quad(2*(params.fe_order + 1))
+  {
+    POD::create_dof_handler_from_triangulation_file
+    (parameters.triangulation_file_name, parameters.renumber, fe, dof_handler,
+     triangulation);
+
+    DynamicSparsityPattern d_sparsity(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, d_sparsity);
+    sparsity_pattern.copy_from(d_sparsity);
+  }
+
+
+
+  template<int dim>
+  void
+  ComputeHyperReduction<dim>::load_pod_vectors()
+  {
+    POD::load_pod_basis("pod-vector*.h5", "mean-vector.h5", mean_vector,
+                        pod_vectors);
+    AssertThrow(pod_vectors.size() >= parameters.n_pod_vectors,
+                ExcMessage("The number of specified POD vectors exceeds the "
+                           "number of POD vectors found in the current directory."));
+    pod_vectors.resize(parameters.n_pod_vectors);
+  }
+
+
+
+  template<int dim>
+  void
+  ComputeHyperReduction<dim>::project_training_snapshots()
+  {
+    const std::vector<std::string> snapshot_file_names
+      = extra::expand_file_names(parameters.snapshot_glob);
+    AssertThrow(snapshot_file_names.size() > 0,
+                ExcMessage("No snapshots match the glob " + parameters.snapshot_glob));
+    const unsigned int n_snapshots
+      = std::min<unsigned int>(parameters.n_training_snapshots,
+                               snapshot_file_names.size());
+
+    SparseMatrix<double> full_mass_matrix(sparsity_pattern);
+    MatrixCreator::create_mass_matrix(dof_handler, quad, full_mass_matrix);
+
+    // The POD basis is orthonormal in the mass matrix inner product, so the
+    // coefficients of a snapshot are just its inner products with the POD
+    // vectors.
+    training_coefficients.reinit(n_snapshots, pod_vectors.size());
+    const unsigned int n_dofs = mean_vector.block(0).size();
+    Vector<double> temp(n_dofs);
+    for (unsigned int snapshot_n = 0; snapshot_n < n_snapshots; ++snapshot_n)
+      {
+        const unsigned int file_n = n_snapshots == 1 ? 0 :
+                                    (snapshot_n*(snapshot_file_names.size() - 1))
+                                    /(n_snapshots - 1);
+        BlockVector<double> snapshot;
+        H5::load_block_vector(snapshot_file_names[file_n], snapshot);
+        snapshot -= mean_vector;
+        for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+          {
+            full_mass_matrix.vmult(temp, snapshot.block(dim_n));
+            for (unsigned int pod_vector_n = 0; pod_vector_n < pod_vectors.size();
+                 ++pod_vector_n)
+              {
+                training_coefficients(snapshot_n, pod_vector_n)
+                  += temp*pod_vectors[pod_vector_n].block(dim_n);
+              }
+          }
+      }
+  }
+
+
+
+  template<int dim>
+  void
+  ComputeHyperReduction<dim>::compute_cell_weights()
+  {
+    FullMatrix<double> contributions;
+    POD::NavierStokes::create_cell_nonlinearity_contributions
+    (dof_handler, quad, pod_vectors, training_coefficients, contributions);
+
+    // With all weights equal to one the reduced quadrature rule is exact.
+    Vector<double> ones(contributions.n());
+    ones = 1.0;
+    Vector<double> exact_nonlinearity(contributions.m());
+    contributions.vmult(exact_nonlinearity, ones);
+
+    extra::nonnegative_least_squares
+    (contributions, exact_nonlinearity, parameters.tolerance,
+     parameters.max_n_cells, cell_weights);
+
+    Vector<double> residual(contributions.m());
+    contributions.vmult(residual, cell_weights);
+    residual -= exact_nonlinearity;
+    unsigned int n_sampled_cells = 0;
+    for (const double weight : cell_weights)
+      {
+        if (weight > 0.0)
+          {
+            ++n_sampled_cells;
+          }
+      }
+    std::cout << "sampled " << n_sampled_cells << " of " << cell_weights.size()
+              << " cells; relative training error: "
+              << residual.l2_norm()/exact_nonlinearity.l2_norm() << std::endl;
+  }
+
+
+
+  template<int dim>
+  void
+  ComputeHyperReduction<dim>::save_reduced_quadrature()
+  {
+    POD::NavierStokes::ReducedQuadrature reduced_quadrature;
+    POD::NavierStokes::create_reduced_quadrature
+    (dof_handler, quad, pod_vectors, cell_weights, reduced_quadrature);
+    reduced_quadrature.save("rom-hyper-reduction");
+  }
+
+
+
+  template<int dim>
+  void
+  ComputeHyperReduction<dim>::run()
+  {
+    load_pod_vectors();
+    project_training_snapshots();
+    compute_cell_weights();
+    save_reduced_quadrature();
+  }
+}
+
+
+
+int main(int argc, char **argv)
+{
+  using namespace POD;
+  Utilities::MPI::MPI_InitFinalize mpi_initialization
+  (argc, argv, numbers::invalid_unsigned_int);
+  {
+    HyperReduction::Parameters parameters;
+    parameters.read_data("parameters.prm");
+    if (parameters.dimension == 2)
+      {
+        HyperReduction::ComputeHyperReduction<2> hyper_reduction(parameters);
+        hyper_reduction.run();
+      }
+    else
+      {
+        HyperReduction::ComputeHyperReduction<3> hyper_reduction(parameters);
+        hyper_reduction.run();
+      }
+  }
+}
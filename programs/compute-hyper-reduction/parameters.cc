@@ -0,0 +1,81 @@
+#include "parameters.h"
+
+namespace HyperReduction
+{
+  void Parameters::configure_parameter_handler
+  (ParameterHandler &parameter_handler) const
+  {
+    parameter_handler.enter_subsection("DNS");
+    {
+      parameter_handler.declare_entry
+        ("dimension", "3", Patterns::Integer(2), "Dimension of the data.");
+      parameter_handler.declare_entry
+        ("fe_order", "2", Patterns::Integer(1), "Order of the finite element.");
+      parameter_handler.declare_entry
+        ("renumber", "false", Patterns::Bool(), "Whether or not to renumber "
+         "the nodes with Cuthill-McKee.");
+      parameter_handler.declare_entry
+        ("triangulation_file_name", "triangulation.txt", Patterns::Anything(),
+         "Name of the Triangulation file.");
+    }
+    parameter_handler.leave_subsection();
+
+    parameter_handler.enter_subsection("ROM");
+    {
+      parameter_handler.declare_entry
+        ("n_pod_vectors", "1", Patterns::Integer(1), "Number of POD vectors to use.");
+    }
+    parameter_handler.leave_subsection();
+
+    parameter_handler.enter_subsection("Hyper Reduction");
+    {
+      parameter_handler.declare_entry
+        ("snapshot_glob", "snapshot-*.h5", Patterns::Anything(), "Glob matching "
+         "the snapshots used to train the reduced quadrature rule.");
+      parameter_handler.declare_entry
+        ("n_training_snapshots", "20", Patterns::Integer(1), "Number of "
+         "(evenly spaced) snapshots used for training.");
+      parameter_handler.declare_entry
+        ("tolerance", "1.0e-4", Patterns::Double(0.0), "Relative tolerance for "
+         "the nonnegative least squares fit of the cell weights.");
+      parameter_handler.declare_entry
+        ("max_n_cells", "1000", Patterns::Integer(1), "Maximum number of cells "
+         "in the reduced quadrature rule.");
+    }
+    parameter_handler.leave_subsection();
+  }
+
+  void Parameters::read_data(const std::string &file_name)
+  {
+    ParameterHandler parameter_handler;
+    {
+      std::ifstream file(file_name);
+      configure_parameter_handler(parameter_handler);
+      parameter_handler.parse_input(file);
+    }
+
+    parameter_handler.enter_subsection("DNS");
+    {
+      dimension = parameter_handler.get_integer("dimension");
+      fe_order = parameter_handler.get_integer("fe_order");
+      renumber = parameter_handler.get_bool("renumber");
+      triangulation_file_name = parameter_handler.get("triangulation_file_name");
+    }
+    parameter_handler.leave_subsection();
+
+    parameter_handler.enter_subsection("ROM");
+    {
+      n_pod_vectors = parameter_handler.get_integer("n_pod_vectors");
+    }
+    parameter_handler.leave_subsection();
+
+    parameter_handler.enter_subsection("Hyper Reduction");
+    {
+      snapshot_glob = parameter_handler.get("snapshot_glob");
+      n_training_snapshots = parameter_handler.get_integer("n_training_snapshots");
+      tolerance = parameter_handler.get_double("tolerance");
+      max_n_cells = parameter_handler.get_integer("max_n_cells");
+    }
+    parameter_handler.leave_subsection();
+  }
+}
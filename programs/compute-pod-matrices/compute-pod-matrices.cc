@@ -1,6 +1,9 @@
+#include <deal.II/base/conditional_ostream.h>
+#include <deal.II/base/mpi.h>
 #include <deal.II/base/utilities.h>
 #include <deal.II/base/quadrature_lib.h>
 
+#include <deal.II/lac/constraint_matrix.h>
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/sparse_matrix.h>
@@ -8,6 +11,7 @@
 
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/grid_in.h>
+#include <deal.II/grid/grid_tools.h>
 
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/dofs/dof_tools.h>
@@ -16,6 +20,9 @@
 
 #include <deal.II/numerics/matrix_tools.h>
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
 #include <string>
 #include <memory>
 #include <vector>
@@ -23,6 +30,7 @@
 #include <deal.II-pod/ns/filter.h>
 #include <deal.II-pod/ns/ns.h>
 #include <deal.II-pod/extra/extra.h>
+#include <deal.II-pod/extra/resize.h>
 #include <deal.II-pod/pod/pod.h>
 #include <deal.II-pod/h5/h5.h>
 
@@ -40,7 +48,12 @@ namespace ComputePOD
     ComputePODMatrices(const Parameters &parameters);
     void run();
   private:
+    void partition_cells();
     void load_pod_vectors();
+    void load_existing_rom_components();
+    void check_existing_vector(const std::string    &file_name,
+                               const Vector<double> &vector) const;
+    double get_filter_radius() const;
 
     void setup_mass_matrix();
     void setup_laplace_matrix();
@@ -49,15 +62,32 @@ namespace ComputePOD
     void setup_gradient_linearization_matrix();
     void setup_nonlinearity();
 
+    const SparsityPattern &get_owned_sparsity_pattern() const;
+    void sum_over_processes(FullMatrix<double> &matrix) const;
+    void sum_over_processes(Vector<double> &vector) const;
+
     void save_rom_components();
 
     const Parameters parameters;
 
+    // Each process assembles the cell integrals (the advective and gradient
+    // linearizations and the nonlinearity) over the cells whose subdomain id
+    // is its rank. The partial reduced quantities are then summed. The
+    // remaining components are cheap and are computed on the first process.
+    const unsigned int n_mpi_processes;
+    const unsigned int this_mpi_process;
+    types::subdomain_id owned_subdomain;
+    ConditionalOStream pcout;
+
     FE_Q<dim> fe;
     QGauss<dim> quad;
     Triangulation<dim> triangulation;
     SparsityPattern sparsity_pattern;
+    // coupling between the degrees of freedom on the owned cells: only set up
+    // if there is more than one process.
+    SparsityPattern owned_sparsity_pattern;
     DoFHandler<dim> dof_handler;
+    std::unique_ptr<POD::NavierStokes::BoundaryFaceIndex<dim>> boundary_face_index;
 
     // for Leray models: otherwise, these point to the unfiltered versions
     std::shared_ptr<std::vector<BlockVector<double>>> filtered_pod_vectors;
@@ -66,6 +96,9 @@ namespace ComputePOD
     std::shared_ptr<std::vector<BlockVector<double>>> pod_vectors;
     std::shared_ptr<BlockVector<double>> mean_vector;
     unsigned int n_dofs;
+    // number of POD vectors used to compute the ROM components loaded by
+    // load_existing_rom_components: zero if everything is computed anew.
+    unsigned int n_existing_pod_vectors;
 
     FullMatrix<double> mass_matrix;
     FullMatrix<double> laplace_matrix;
@@ -85,12 +118,17 @@ namespace ComputePOD
   (const Parameters &params)
     :
     parameters(params),
+    n_mpi_processes {Utilities::MPI::n_mpi_processes(MPI_COMM_WORLD)},
+    this_mpi_process {Utilities::MPI::this_mpi_process(MPI_COMM_WORLD)},
+    owned_subdomain {numbers::invalid_subdomain_id},
+    pcout(std::cout, this_mpi_process == 0),
     fe(params.fe_order),
     quad(params.fe_order + 2),
     filtered_pod_vectors {std::make_shared<std::vector<BlockVector<double>>>()},
     filtered_mean_vector {std::make_shared<BlockVector<double>>()},
     pod_vectors {std::make_shared<std::vector<BlockVector<double>>>()},
-    mean_vector {std::make_shared<BlockVector<double>>()}
+    mean_vector {std::make_shared<BlockVector<double>>()},
+    n_existing_pod_vectors {0}
   {
     POD::create_dof_handler_from_triangulation_file
     (parameters.triangulation_file_name, parameters.renumber, fe, dof_handler,
@@ -99,6 +137,86 @@ namespace ComputePOD
     DynamicSparsityPattern d_sparsity(dof_handler.n_dofs());
     DoFTools::make_sparsity_pattern(dof_handler, d_sparsity);
     sparsity_pattern.copy_from(d_sparsity);
+
+    boundary_face_index = std::unique_ptr<POD::NavierStokes::BoundaryFaceIndex<dim>>
+      (new POD::NavierStokes::BoundaryFaceIndex<dim>(dof_handler));
+
+    partition_cells();
+  }
+
+
+
+  template<int dim>
+  void
+  ComputePODMatrices<dim>::partition_cells()
+  {
+    if (n_mpi_processes == 1)
+      {
+        return;
+      }
+
+    // Every process reads the same triangulation and computes the same
+    // partition, so no communication is needed.
+#ifdef DEAL_II_WITH_METIS
+    GridTools::partition_triangulation(n_mpi_processes, triangulation);
+#else
+    const unsigned int n_active_cells = triangulation.n_active_cells();
+    typename DoFHandler<dim>::active_cell_iterator
+    cell = dof_handler.begin_active(),
+    endc = dof_handler.end();
+    for (; cell != endc; ++cell)
+      {
+        cell->set_subdomain_id
+        (static_cast<unsigned long>(cell->active_cell_index())*n_mpi_processes
+         /n_active_cells);
+      }
+#endif
+    owned_subdomain = this_mpi_process;
+
+    DynamicSparsityPattern d_sparsity(dof_handler.n_dofs());
+    DoFTools::make_sparsity_pattern(dof_handler, d_sparsity, ConstraintMatrix(),
+                                    true, owned_subdomain);
+    owned_sparsity_pattern.copy_from(d_sparsity);
+  }
+
+
+
+  template<int dim>
+  const SparsityPattern &
+  ComputePODMatrices<dim>::get_owned_sparsity_pattern() const
+  {
+    return n_mpi_processes == 1 ? sparsity_pattern : owned_sparsity_pattern;
+  }
+
+
+
+  template<int dim>
+  void
+  ComputePODMatrices<dim>::sum_over_processes(FullMatrix<double> &matrix) const
+  {
+    if (n_mpi_processes == 1 || matrix.m()*matrix.n() == 0)
+      {
+        return;
+      }
+    const int ierr = MPI_Allreduce(MPI_IN_PLACE, &matrix(0, 0),
+                                   matrix.m()*matrix.n(), MPI_DOUBLE, MPI_SUM,
+                                   MPI_COMM_WORLD);
+    AssertThrow(ierr == MPI_SUCCESS, ExcInternalError());
+  }
+
+
+
+  template<int dim>
+  void
+  ComputePODMatrices<dim>::sum_over_processes(Vector<double> &vector) const
+  {
+    if (n_mpi_processes == 1 || vector.size() == 0)
+      {
+        return;
+      }
+    const int ierr = MPI_Allreduce(MPI_IN_PLACE, vector.begin(), vector.size(),
+                                   MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    AssertThrow(ierr == MPI_SUCCESS, ExcInternalError());
   }
 
 
@@ -121,8 +239,7 @@ namespace ComputePOD
     // This is an abuse of notation to save duplication: if the POD vectors are
     // not filtered, then simply assign the filtered pod vectors pointer to
     // point to the unfiltered ones.
-    if (parameters.use_leray_regularization
-        && parameters.filter_radius != 0.0)
+    if (get_filter_radius() != 0.0)
       {
         std::shared_ptr<SparseMatrix<double>> full_mass_matrix
           {new SparseMatrix<double>};
@@ -134,7 +251,8 @@ namespace ComputePOD
         MatrixCreator::create_laplace_matrix
           (dof_handler, quad, full_laplace_matrix);
         POD::NavierStokes::create_boundary_matrix
-          (dof_handler, face_quad, parameters.outflow_label, full_boundary_matrix);
+          (dof_handler, *boundary_face_index, face_quad, parameters.outflow_label,
+           full_boundary_matrix);
 
         Leray::LerayFilter filter
           (parameters.filter_radius, full_mass_matrix, full_boundary_matrix,
@@ -143,12 +261,41 @@ namespace ComputePOD
         // TODO support not filtering the mean
         filter.apply(*filtered_mean_vector, *mean_vector);
 
+        // Each filter application is a global solve, so distribute the POD
+        // vectors over the processes and then send each filtered vector to
+        // every other process.
         filtered_pod_vectors->resize(pod_vectors->size());
         for (unsigned int pod_vector_n = 0; pod_vector_n < pod_vectors->size();
              ++pod_vector_n)
           {
-            filter.apply(filtered_pod_vectors->at(pod_vector_n),
-                         pod_vectors->at(pod_vector_n));
+            if (pod_vector_n % n_mpi_processes == this_mpi_process)
+              {
+                filter.apply(filtered_pod_vectors->at(pod_vector_n),
+                             pod_vectors->at(pod_vector_n));
+              }
+            else
+              {
+                filtered_pod_vectors->at(pod_vector_n).reinit
+                (pod_vectors->at(pod_vector_n));
+              }
+          }
+        if (n_mpi_processes > 1)
+          {
+            for (unsigned int pod_vector_n = 0; pod_vector_n < pod_vectors->size();
+                 ++pod_vector_n)
+              {
+                BlockVector<double> &filtered_pod_vector
+                  = filtered_pod_vectors->at(pod_vector_n);
+                for (unsigned int dim_n = 0; dim_n < filtered_pod_vector.n_blocks();
+                     ++dim_n)
+                  {
+                    const int ierr = MPI_Bcast
+                      (filtered_pod_vector.block(dim_n).begin(),
+                       filtered_pod_vector.block(dim_n).size(), MPI_DOUBLE,
+                       pod_vector_n % n_mpi_processes, MPI_COMM_WORLD);
+                    AssertThrow(ierr == MPI_SUCCESS, ExcInternalError());
+                  }
+              }
           }
       }
     else
@@ -160,6 +307,122 @@ namespace ComputePOD
 
 
 
+  template<int dim>
+  void
+  ComputePODMatrices<dim>::load_existing_rom_components()
+  {
+    if (!parameters.extend_existing_matrices)
+      {
+        return;
+      }
+    AssertThrow(!parameters.test_output,
+                ExcMessage("Testing the output is not compatible with extending "
+                           "existing ROM components."));
+    if (!std::ifstream("rom-mass-matrix.h5"))
+      {
+        pcout << "No existing ROM components were found: computing every "
+              << "entry." << std::endl;
+        return;
+      }
+
+    H5::load_full_matrix("rom-mass-matrix.h5", mass_matrix);
+    const unsigned int n_old_pod_vectors = mass_matrix.m();
+    if (n_old_pod_vectors >= pod_vectors->size())
+      {
+        pcout << "The existing ROM components were computed with "
+              << n_old_pod_vectors << " POD vectors, which is not fewer "
+              << "than the " << pod_vectors->size() << " requested: "
+              << "computing every entry." << std::endl;
+        return;
+      }
+
+    // The filtered POD vectors only enter the gradient linearization and the
+    // nonlinearity, which the prefix checks below do not cover: compare the
+    // filter settings directly.
+    AssertThrow(std::ifstream("rom-filter-settings.h5"),
+                ExcMessage("The existing ROM components do not record their "
+                           "filter settings: rerun with "
+                           "extend_existing_matrices = false."));
+    Vector<double> filter_settings;
+    H5::load_vector("rom-filter-settings.h5", filter_settings);
+    AssertThrow(filter_settings.size() == 2,
+                ExcMessage("The file rom-filter-settings.h5 is corrupt."));
+    const double existing_filter_radius
+      = filter_settings[0] != 0.0 ? filter_settings[1] : 0.0;
+    AssertThrow(existing_filter_radius == get_filter_radius(),
+                ExcMessage("The existing ROM components were computed with a "
+                           "different Leray filter: rerun with "
+                           "extend_existing_matrices = false."));
+
+    H5::load_full_matrix("rom-laplace-matrix.h5", laplace_matrix);
+    H5::load_full_matrix("rom-boundary-matrix.h5", boundary_matrix);
+    H5::load_full_matrix("rom-gradient-matrix.h5", gradient_matrix);
+    H5::load_full_matrix("rom-advection-matrix.h5", advection_matrix);
+    H5::load_full_matrices("rom-nonlinearity.h5", nonlinearity);
+    for (const FullMatrix<double> *matrix :
+         {&laplace_matrix, &boundary_matrix, &gradient_matrix, &advection_matrix})
+      {
+        AssertThrow(matrix->m() == n_old_pod_vectors
+                    && matrix->n() == n_old_pod_vectors,
+                    ExcMessage("The existing ROM matrices do not have the same "
+                               "size."));
+      }
+    AssertThrow(nonlinearity.size() == n_old_pod_vectors,
+                ExcMessage("The existing ROM nonlinearity does not match the "
+                           "existing ROM matrices."));
+
+    // The cell integrals are summed over the processes, so only count the
+    // existing entries once.
+    if (this_mpi_process != 0)
+      {
+        gradient_matrix = 0.0;
+        advection_matrix = 0.0;
+        for (auto &slice : nonlinearity)
+          {
+            slice = 0.0;
+          }
+      }
+
+    n_existing_pod_vectors = n_old_pod_vectors;
+    pcout << "Extending the existing ROM components from "
+          << n_existing_pod_vectors << " to " << pod_vectors->size()
+          << " POD vectors." << std::endl;
+  }
+
+
+
+  template<int dim>
+  void
+  ComputePODMatrices<dim>::check_existing_vector
+  (const std::string    &file_name,
+   const Vector<double> &vector) const
+  {
+    // The vectors are cheap to compute in full, so use them to check that the
+    // existing components were computed from a prefix of the current basis.
+    Vector<double> existing_vector;
+    H5::load_vector(file_name, existing_vector);
+    Vector<double> leading_entries(vector);
+    extra::resize(leading_entries, n_existing_pod_vectors);
+    const double tolerance = 1e-10*std::max(1.0, existing_vector.linfty_norm());
+    AssertThrow(extra::are_equal(existing_vector, leading_entries, tolerance),
+                ExcMessage("The existing ROM components in " + file_name
+                           + " were not computed from a prefix of the current "
+                           "POD basis: rerun with extend_existing_matrices = "
+                           "false."));
+  }
+
+
+
+  template<int dim>
+  double
+  ComputePODMatrices<dim>::get_filter_radius() const
+  {
+    // zero if the POD vectors are not filtered
+    return parameters.use_leray_regularization ? parameters.filter_radius : 0.0;
+  }
+
+
+
   template<int dim>
   void
   ComputePODMatrices<dim>::setup_mass_matrix()
@@ -168,7 +431,14 @@ namespace ComputePOD
     // condition here too.
     SparseMatrix<double> full_mass_matrix(sparsity_pattern);
     MatrixCreator::create_mass_matrix(dof_handler, quad, full_mass_matrix);
-    POD::create_reduced_matrix(*pod_vectors, full_mass_matrix, mass_matrix);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::create_reduced_matrix(*pod_vectors, full_mass_matrix, mass_matrix);
+      }
+    else
+      {
+        POD::extend_reduced_matrix(*pod_vectors, full_mass_matrix, mass_matrix);
+      }
 
     BlockVector<double> centered_initial;
     // TODO replace hardcoded string with a parameter value
@@ -186,6 +456,10 @@ namespace ComputePOD
               temp * pod_vectors->at(pod_vector_n).block(dim_n);
           }
       }
+    if (n_existing_pod_vectors != 0)
+      {
+        check_existing_vector("rom-initial-condition.h5", initial);
+      }
   }
 
 
@@ -198,7 +472,16 @@ namespace ComputePOD
     // the relevant part from the mean contribution.
     SparseMatrix<double> full_laplace_matrix(sparsity_pattern);
     MatrixCreator::create_laplace_matrix(dof_handler, quad, full_laplace_matrix);
-    POD::create_reduced_matrix(*pod_vectors, full_laplace_matrix, laplace_matrix);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::create_reduced_matrix(*pod_vectors, full_laplace_matrix,
+                                   laplace_matrix);
+      }
+    else
+      {
+        POD::extend_reduced_matrix(*pod_vectors, full_laplace_matrix,
+                                   laplace_matrix);
+      }
 
     for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
       {
@@ -223,11 +506,20 @@ namespace ComputePOD
     SparseMatrix<double> full_boundary_matrix(sparsity_pattern);
     QGauss<dim - 1> face_quad(fe.degree + 2);
     POD::NavierStokes::create_boundary_matrix
-      (dof_handler, face_quad, parameters.outflow_label, full_boundary_matrix);
+      (dof_handler, *boundary_face_index, face_quad, parameters.outflow_label,
+       full_boundary_matrix);
 
     std::vector<unsigned int> dims {0};
-    POD::create_reduced_matrix(*pod_vectors, full_boundary_matrix, dims,
-                               boundary_matrix);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::create_reduced_matrix(*pod_vectors, full_boundary_matrix, dims,
+                                   boundary_matrix);
+      }
+    else
+      {
+        POD::extend_reduced_matrix(*pod_vectors, full_boundary_matrix, dims,
+                                   boundary_matrix);
+      }
 
     Vector<double> temp(n_dofs);
     full_boundary_matrix.vmult(temp, mean_vector->block(0));
@@ -245,9 +537,21 @@ namespace ComputePOD
   ComputePODMatrices<dim>::setup_advective_linearization_matrix()
   {
     QGauss<dim> higher_quadrature(2*(parameters.fe_order + 1));
-    POD::NavierStokes::create_reduced_advective_linearization
-    (dof_handler, sparsity_pattern, higher_quadrature, *filtered_mean_vector,
-     *pod_vectors, advection_matrix);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::NavierStokes::create_reduced_advective_linearization
+        (dof_handler, get_owned_sparsity_pattern(), higher_quadrature,
+         *filtered_mean_vector, *pod_vectors, advection_matrix, owned_subdomain);
+      }
+    else
+      {
+        SparseMatrix<double> full_advection(get_owned_sparsity_pattern());
+        POD::NavierStokes::create_advective_linearization
+        (dof_handler, POD::NavierStokes::color_cells(dof_handler, owned_subdomain),
+         higher_quadrature, *filtered_mean_vector, full_advection);
+        POD::extend_reduced_matrix(*pod_vectors, full_advection, advection_matrix);
+      }
+    sum_over_processes(advection_matrix);
   }
 
 
@@ -257,9 +561,19 @@ namespace ComputePOD
   ComputePODMatrices<dim>::setup_gradient_linearization_matrix()
   {
     QGauss<dim> higher_quadrature(2*(parameters.fe_order + 1));
-    POD::NavierStokes::create_reduced_gradient_linearization
-    (dof_handler, sparsity_pattern, higher_quadrature, *mean_vector, *pod_vectors,
-     *filtered_pod_vectors, gradient_matrix);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::NavierStokes::create_reduced_gradient_linearization
+        (dof_handler, higher_quadrature, *mean_vector, *pod_vectors,
+         *filtered_pod_vectors, gradient_matrix, owned_subdomain);
+      }
+    else
+      {
+        POD::NavierStokes::extend_reduced_gradient_linearization
+        (dof_handler, higher_quadrature, *mean_vector, *pod_vectors,
+         *filtered_pod_vectors, gradient_matrix, owned_subdomain);
+      }
+    sum_over_processes(gradient_matrix);
   }
 
 
@@ -272,13 +586,31 @@ namespace ComputePOD
 
     Vector<double> nonlinear_contribution(pod_vectors->size());
     POD::NavierStokes::create_nonlinear_centered_contribution
-      (dof_handler, sparsity_pattern, higher_quadrature, *mean_vector,
-       *mean_vector, *pod_vectors, nonlinear_contribution);
+      (dof_handler, get_owned_sparsity_pattern(), higher_quadrature, *mean_vector,
+       *mean_vector, *pod_vectors, nonlinear_contribution, owned_subdomain);
+    sum_over_processes(nonlinear_contribution);
     mean_contribution.add(-1.0, nonlinear_contribution);
+    if (n_existing_pod_vectors != 0 && this_mpi_process == 0)
+      {
+        check_existing_vector("rom-mean-contribution.h5", mean_contribution);
+      }
 
-    POD::NavierStokes::create_reduced_nonlinearity
-    (dof_handler, sparsity_pattern, higher_quadrature, *pod_vectors,
-     *filtered_pod_vectors, nonlinearity);
+    if (n_existing_pod_vectors == 0)
+      {
+        POD::NavierStokes::create_reduced_nonlinearity
+        (dof_handler, get_owned_sparsity_pattern(), higher_quadrature,
+         *pod_vectors, *filtered_pod_vectors, nonlinearity, owned_subdomain);
+      }
+    else
+      {
+        POD::NavierStokes::extend_reduced_nonlinearity
+        (dof_handler, higher_quadrature, *pod_vectors, *filtered_pod_vectors,
+         nonlinearity, owned_subdomain);
+      }
+    for (auto &slice : nonlinearity)
+      {
+        sum_over_processes(slice);
+      }
   }
 
 
@@ -289,14 +621,11 @@ namespace ComputePOD
   {
     if (parameters.test_output)
       {
-        // For some reason the debug build computes slightly (!!!) different
-        // values than the release build, so compare it with a higher
+        // The linearizations are assembled by colors of cells in parallel, so
+        // the order in which cell contributions are summed differs from a
+        // serial cell loop (and from the debug build): compare with a small
         // tolerance.
-#ifdef DEBUG
         constexpr double tolerance {1e-13};
-#else
-        constexpr double tolerance {0.0};
-#endif
 #define TEST_MATRIX(EXP)                                                                \
         {                                                                               \
           FullMatrix<double> test_##EXP;                                                \
@@ -345,6 +674,11 @@ namespace ComputePOD
         H5::save_vector("rom-mean-contribution.h5", mean_contribution);
         H5::save_vector("rom-initial-condition.h5", initial);
         H5::save_full_matrices("rom-nonlinearity.h5", nonlinearity);
+
+        Vector<double> filter_settings(2);
+        filter_settings[0] = parameters.use_leray_regularization;
+        filter_settings[1] = parameters.filter_radius;
+        H5::save_vector("rom-filter-settings.h5", filter_settings);
       }
   }
 
@@ -355,13 +689,20 @@ namespace ComputePOD
   ComputePODMatrices<dim>::run()
   {
     load_pod_vectors();
-    setup_mass_matrix();
-    setup_laplace_matrix();
-    setup_boundary_matrix();
+    load_existing_rom_components();
+    if (this_mpi_process == 0)
+      {
+        setup_mass_matrix();
+        setup_laplace_matrix();
+        setup_boundary_matrix();
+      }
     setup_advective_linearization_matrix();
     setup_gradient_linearization_matrix();
     setup_nonlinearity();
-    save_rom_components();
+    if (this_mpi_process == 0)
+      {
+        save_rom_components();
+      }
   }
 }
 
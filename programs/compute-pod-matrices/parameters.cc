@@ -38,6 +38,12 @@ namespace ComputePOD
       parameter_handler.declare_entry
         ("filter_radius", "0.0", Patterns::Double(), "Radius of the differential"
          " filter.");
+      parameter_handler.declare_entry
+        ("extend_existing_matrices", "false", Patterns::Bool(), "Whether or "
+         "not to reuse the ROM matrices in the current directory, computed "
+         "with fewer POD vectors of the same basis, and only compute the new "
+         "rows, columns, and tensor slices. The Leray filter settings must match "
+         "the ones recorded in rom-filter-settings.h5.");
     }
     parameter_handler.leave_subsection();
 
@@ -76,6 +82,8 @@ namespace ComputePOD
       use_leray_regularization =
         parameter_handler.get_bool("use_leray_regularization");
       n_pod_vectors = parameter_handler.get_integer("n_pod_vectors");
+      extend_existing_matrices =
+        parameter_handler.get_bool("extend_existing_matrices");
     }
     parameter_handler.leave_subsection();
 
@@ -40,6 +40,7 @@ namespace ComputePOD
     bool use_leray_regularization;
     unsigned int n_pod_vectors;
     double filter_radius;
+    bool extend_existing_matrices;
 
     bool test_output;
 
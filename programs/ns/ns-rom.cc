@@ -14,12 +14,22 @@
  * Author: David Wells, Virginia Tech, 2014
  *         David Wells, Rensselaer Polytechnic Institute, 2015
  */
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/utilities.h>
+
 #include <deal.II/lac/vector.h>
 #include <deal.II/lac/full_matrix.h>
 
 #include <boost/math/special_functions/round.hpp>
 
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -28,7 +38,10 @@
 
 #include <deal.II-pod/h5/h5.h>
 #include <deal.II-pod/ode/ode.h>
+#include <deal.II-pod/ode/observer.h>
+#include <deal.II-pod/ode/parareal.h>
 #include <deal.II-pod/ns/filter.h>
+#include <deal.II-pod/ns/hyper_reduction.h>
 #include <deal.II-pod/ns/ns.h>
 #include <deal.II-pod/pod/pod.h>
 
@@ -41,6 +54,18 @@ namespace NavierStokes
   using namespace dealii;
   using namespace POD;
 
+  /*
+   * Thrown when a divergence monitor stops a run. ns-rom exits with status 2
+   * in this case, so that drivers can tell it apart from other errors.
+   */
+  DeclException1(ExcDiverged, std::string, << arg1 << " diverged.");
+
+  /*
+   * Thrown when a run stops at checkpoint_stop_step. ns-rom exits with status
+   * 3 in this case: running it again resumes from the checkpoint.
+   */
+  DeclException1(ExcStopped, std::string, << arg1 << " stopped at a checkpoint.");
+
   template<int dim>
   class ROM
   {
@@ -50,24 +75,69 @@ namespace NavierStokes
 
   private:
     void setup_reduced_system();
+    FullMatrix<double> create_linear_operator(const double reynolds_n) const;
+
+    /*
+     * Integrate the ROM set up by run_parameters and return the output file
+     * name and the saved POD coefficients. This only reads the members of this
+     * class, so several configurations may be integrated at once.
+     */
+    std::pair<std::string, FullMatrix<double>> integrate
+    (const POD::NavierStokes::Parameters &run_parameters) const;
+
+    /*
+     * Same as integrate, but with the state stored in type Number and sums
+     * accumulated in type AccumulationNumber. The returned coefficients are
+     * converted back to double precision.
+     */
+    template<typename Number, typename AccumulationNumber>
+    FullMatrix<double> integrate_reduced_precision
+    (const POD::NavierStokes::Parameters &run_parameters) const;
+
+    /*
+     * Call either integrate or integrate_reduced_precision, depending on the
+     * requested precision. The output file name is prefixed with the
+     * precision if it is not double.
+     */
+    std::pair<std::string, FullMatrix<double>> integrate_with_precision
+    (const POD::NavierStokes::Parameters &run_parameters) const;
+
+    /*
+     * Print and save the relative drift of solutions from double_solutions.
+     * This may be called by concurrent runs.
+     */
+    void report_precision_drift(const std::string        &outname,
+                                const FullMatrix<double> &solutions,
+                                const FullMatrix<double> &double_solutions) const;
+
     void time_iterate();
+    void time_iterate_ensemble();
+    void sweep();
 
     const POD::NavierStokes::Parameters parameters;
 
     FullMatrix<double>               mass_matrix;
     FullMatrix<double>               boundary_matrix;
     FullMatrix<double>               laplace_matrix;
+    FullMatrix<double>               advection_matrix;
+    FullMatrix<double>               gradient_matrix;
     FullMatrix<double>               linear_operator;
     FullMatrix<double>               joint_convection;
     std::vector<FullMatrix<double>>  nonlinear_operator;
     Vector<double>                   mean_contribution_vector;
+    POD::NavierStokes::ReducedQuadrature reduced_quadrature;
 
     const unsigned int               n_pod_dofs;
 
-    Vector<double>                   solution;
+    Vector<double>                   initial_condition;
+
+    // HDF5 is not necessarily thread safe, so concurrent runs (in a sweep)
+    // only read or write one file at a time.
+    mutable Threads::Mutex           h5_mutex;
 
-    double                           time;
-    unsigned int                     timestep_number;
+    // Likewise, the messages of concurrent runs are printed one at a time so
+    // that their lines do not interleave.
+    mutable Threads::Mutex           output_mutex;
   };
 
 
@@ -75,18 +145,13 @@ namespace NavierStokes
   ROM<dim>::ROM(const POD::NavierStokes::Parameters &parameters)
     :
     parameters(parameters),
-    n_pod_dofs {parameters.n_pod_dofs},
-    time {parameters.initial_time},
-    timestep_number {0}
+    n_pod_dofs {parameters.n_pod_dofs}
   {}
 
 
   template<int dim>
   void ROM<dim>::setup_reduced_system()
   {
-    FullMatrix<double> advection_matrix;
-    FullMatrix<double> gradient_matrix;
-
     H5::load_full_matrix("rom-mass-matrix.h5", mass_matrix);
     H5::load_full_matrix("rom-boundary-matrix.h5", boundary_matrix);
     H5::load_full_matrix("rom-laplace-matrix.h5", laplace_matrix);
@@ -94,7 +159,15 @@ namespace NavierStokes
     H5::load_full_matrix("rom-gradient-matrix.h5", gradient_matrix);
     H5::load_full_matrices("rom-nonlinearity.h5", nonlinear_operator);
     H5::load_vector("rom-mean-contribution.h5", mean_contribution_vector);
-    H5::load_vector("rom-initial-condition.h5", solution);
+    H5::load_vector("rom-initial-condition.h5", initial_condition);
+    if (parameters.use_hyper_reduction)
+      {
+        reduced_quadrature.load("rom-hyper-reduction");
+        AssertThrow(reduced_quadrature.n_pod_dofs() >= n_pod_dofs,
+                    ExcMessage("The reduced quadrature rule was computed with "
+                               "fewer POD vectors than requested."));
+        reduced_quadrature.truncate(n_pod_dofs);
+      }
 
     if (n_pod_dofs < mass_matrix.m())
       {
@@ -111,7 +184,7 @@ namespace NavierStokes
           }
 
         extra::resize(mean_contribution_vector, n_pod_dofs);
-        extra::resize(solution, n_pod_dofs);
+        extra::resize(initial_condition, n_pod_dofs);
       }
 
     // The joint convection matrix is necessary for the L2 Projection model (all
@@ -120,70 +193,505 @@ namespace NavierStokes
     joint_convection.add(-1.0, advection_matrix);
     joint_convection.add(-1.0, gradient_matrix);
 
-    linear_operator.reinit(n_pod_dofs, n_pod_dofs);
-    linear_operator.add(-1.0/parameters.reynolds_n, laplace_matrix);
-    linear_operator.add(1.0/parameters.reynolds_n, boundary_matrix);
-    linear_operator.add(-1.0, advection_matrix);
-    linear_operator.add(-1.0, gradient_matrix);
+    linear_operator = create_linear_operator(parameters.reynolds_n);
   }
 
 
   template<int dim>
-  void ROM<dim>::time_iterate()
+  FullMatrix<double>
+  ROM<dim>::create_linear_operator(const double reynolds_n) const
+  {
+    FullMatrix<double> result(n_pod_dofs, n_pod_dofs);
+    result.add(-1.0/reynolds_n, laplace_matrix);
+    result.add(1.0/reynolds_n, boundary_matrix);
+    result.add(-1.0, advection_matrix);
+    result.add(-1.0, gradient_matrix);
+    return result;
+  }
+
+
+  template<int dim>
+  std::pair<std::string, FullMatrix<double>> ROM<dim>::integrate
+  (const POD::NavierStokes::Parameters &run_parameters) const
   {
+    Vector<double> solution(initial_condition);
     Vector<double> old_solution(solution);
     Vector<double> output_solution(solution);
 
+    const FullMatrix<double> run_linear_operator
+      = run_parameters.reynolds_n == parameters.reynolds_n
+        ? linear_operator : create_linear_operator(run_parameters.reynolds_n);
+
     std::string outname;
-    std::unique_ptr<ODE::RungeKuttaBase> rk_method {new ODE::RungeKutta4()};
+    std::unique_ptr<ODE::RungeKuttaBase<double>> rk_method
+    {new ODE::RungeKutta4<double>()};
     std::tie(outname, rk_method) = POD::NavierStokes::rk_factory
       (boundary_matrix, joint_convection, laplace_matrix,
-       linear_operator, mean_contribution_vector, mass_matrix,
-       nonlinear_operator, parameters);
+       run_linear_operator, mean_contribution_vector, mass_matrix,
+       nonlinear_operator, reduced_quadrature, run_parameters);
 
     // Annoyingly, there is no way to access the filter burried inside
     // rk_method at this point, so we must build another filter regardless of
-    // which filter model we actually use.
+    // which filter model we actually use. Its noise uses another substream
+    // than the noise of the filter in rk_method.
+    constexpr unsigned int output_noise_substream {1};
     POD::NavierStokes::AD::LavrentievFilter ad_filter
-      (mass_matrix, laplace_matrix, boundary_matrix, parameters.filter_radius,
-       parameters.noise_multiplier, parameters.lavrentiev_parameter);
+      (mass_matrix, laplace_matrix, boundary_matrix, run_parameters.filter_radius,
+       run_parameters.noise_multiplier, run_parameters.lavrentiev_parameter,
+       run_parameters.noise_stream, output_noise_substream);
 
     // Filter the initial condition, if appropriate
-    if (parameters.filter_model == POD::FilterModel::ADLavrentiev)
+    if (run_parameters.filter_model == POD::FilterModel::ADLavrentiev)
       {
         ad_filter.apply(old_solution, solution);
       }
 
     int n_save_steps = boost::math::iround
-      ((parameters.final_time - parameters.initial_time)/parameters.time_step)
-      /parameters.output_interval;
+      ((run_parameters.final_time - run_parameters.initial_time)
+       /run_parameters.time_step)/run_parameters.output_interval;
     FullMatrix<double> solutions(n_save_steps + 1, n_pod_dofs);
     unsigned int output_n = 0;
-
-    while (time < parameters.final_time)
+    auto save_solution = [&](const Vector<double> &src)
+    {
+      if (run_parameters.filter_model == POD::FilterModel::ADLavrentiev)
+        {
+          ad_filter.apply_inverse(output_solution, src);
+        }
+      else
+        {
+          output_solution = src;
+        }
+
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          solutions(output_n, i) = output_solution(i);
+        }
+      ++output_n;
+    };
+
+    if (run_parameters.parareal_n_slices > 0)
       {
-        old_solution = solution;
-        rk_method->step(parameters.time_step, old_solution, solution);
+        AssertThrow(run_parameters.filter_model != POD::FilterModel::ADLavrentiev
+                    or run_parameters.noise_multiplier == 0.0,
+                    ExcMessage("Parareal requires a deterministic right hand "
+                               "side."));
+        AssertThrow(run_parameters.checkpoint_interval == 0,
+                    ExcMessage("Checkpointing is not implemented with "
+                               "parareal."));
+        AssertThrow(run_parameters.monitor_interval == 0,
+                    ExcMessage("Divergence monitoring is not implemented with "
+                               "parareal."));
+        // every slice needs its own integrator.
+        const ODE::Parareal::IntegratorFactory create_rk_method
+          = [&]()
+        {
+          return POD::NavierStokes::rk_factory
+                 (boundary_matrix, joint_convection, laplace_matrix,
+                  run_linear_operator, mean_contribution_vector, mass_matrix,
+                  nonlinear_operator, reduced_quadrature, run_parameters).second;
+        };
+        ODE::Parareal parareal
+        (create_rk_method, run_parameters.parareal_coarse_time_step,
+         create_rk_method, run_parameters.parareal_n_slices,
+         run_parameters.parareal_tolerance,
+         run_parameters.parareal_max_iterations);
+        const unsigned int n_steps = boost::math::iround
+          ((run_parameters.final_time - run_parameters.initial_time)
+           /run_parameters.time_step);
+        std::vector<Vector<double>> outputs;
+        parareal.run(run_parameters.time_step, n_steps,
+                     run_parameters.output_interval, solution, old_solution,
+                     outputs);
+        for (const Vector<double> &output : outputs)
+          {
+            if (output_n == solutions.m())
+              {
+                break;
+              }
+            save_solution(output);
+          }
+        {
+          Threads::Mutex::ScopedLock lock(output_mutex);
+          std::cout << outname << ": " << parareal.n_iterations()
+                    << " parareal iterations" << std::endl;
+        }
+        return std::make_pair(outname, solutions);
+      }
 
-        if (timestep_number % parameters.output_interval == 0)
+    ODE::DormandPrince54 *adaptive_rk_method
+      = dynamic_cast<ODE::DormandPrince54 *>(rk_method.get());
+    if (adaptive_rk_method != nullptr)
+      {
+        AssertThrow(run_parameters.checkpoint_interval == 0,
+                    ExcMessage("Checkpointing is not implemented for adaptive "
+                               "time stepping."));
+        AssertThrow(run_parameters.monitor_interval == 0,
+                    ExcMessage("Divergence monitoring is not implemented for "
+                               "adaptive time stepping."));
+        // Save the solution at the same times as the fixed step loop below by
+        // interpolating within the adaptive steps.
+        const double output_time_step
+          = run_parameters.output_interval*run_parameters.time_step;
+        adaptive_rk_method->initialize(run_parameters.initial_time, solution,
+                                       run_parameters.time_step);
+        while (output_n < solutions.m())
           {
-            if (parameters.filter_model == POD::FilterModel::ADLavrentiev)
+            const double output_time = run_parameters.initial_time
+                                       + run_parameters.time_step
+                                       + output_n*output_time_step;
+            if (output_time - run_parameters.time_step >= run_parameters.final_time)
               {
-                ad_filter.apply_inverse(output_solution, solution);
+                break;
               }
-            else
+            while (adaptive_rk_method->get_time() < output_time)
               {
-                output_solution = solution;
+                adaptive_rk_method->advance();
               }
+            adaptive_rk_method->interpolate(output_time, solution);
+            save_solution(solution);
+          }
+        {
+          Threads::Mutex::ScopedLock lock(output_mutex);
+          std::cout << outname << ": " << adaptive_rk_method->n_accepted_steps()
+                    << " accepted and " << adaptive_rk_method->n_rejected_steps()
+                    << " rejected time steps" << std::endl;
+        }
+        return std::make_pair(outname, solutions);
+      }
+
+    // The output is written by an observer so that it may run on another
+    // thread (output_solution and ad_filter are only used by it from here on).
+    ODE::FunctionStepObserver output_observer
+    ([&](const unsigned int, const double, const Vector<double> &src)
+    {
+      if (output_n < solutions.m())
+        {
+          save_solution(src);
+        }
+    },
+    run_parameters.output_interval, run_parameters.asynchronous_output);
+    ODE::StepObserverList observers;
+    observers.add(output_observer);
+    std::unique_ptr<ODE::DivergenceMonitor> divergence_monitor;
+    if (run_parameters.monitor_interval > 0)
+      {
+        divergence_monitor.reset
+        (new ODE::DivergenceMonitor
+         (mass_matrix, run_parameters.monitor_max_energy,
+          run_parameters.monitor_max_coefficient,
+          run_parameters.monitor_interval));
+        observers.add(*divergence_monitor);
+      }
+
+    double time = run_parameters.initial_time;
+    unsigned int timestep_number = 0;
+
+    // A checkpoint holds the time, the number of steps taken, the number of
+    // saved outputs, and the time step; then the solution; then the size and
+    // the entries of the integrator state; then all of the outputs; and
+    // finally the state (the noise counter) of the output filter.
+    AssertThrow(run_parameters.checkpoint_stop_step == 0
+                or run_parameters.checkpoint_interval > 0,
+                ExcMessage("Stopping at a checkpoint requires a nonzero "
+                           "checkpoint interval."));
+    const std::string checkpoint_name = "checkpoint-" + outname;
+    auto save_checkpoint = [&]()
+    {
+      Vector<double> state;
+      rk_method->save_state(state);
+      Vector<double> output_filter_state;
+      ad_filter.save_state(output_filter_state);
+      std::vector<FullMatrix<double>> checkpoint
+      {
+        FullMatrix<double>(1, 4), FullMatrix<double>(1, n_pod_dofs),
+        FullMatrix<double>(1, state.size() + 1), solutions,
+        FullMatrix<double>(1, output_filter_state.size())
+      };
+      checkpoint[0](0, 0) = time;
+      checkpoint[0](0, 1) = timestep_number;
+      checkpoint[0](0, 2) = output_n;
+      checkpoint[0](0, 3) = run_parameters.time_step;
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          checkpoint[1](0, i) = solution[i];
+        }
+      checkpoint[2](0, 0) = state.size();
+      for (unsigned int i = 0; i < state.size(); ++i)
+        {
+          checkpoint[2](0, i + 1) = state[i];
+        }
+      for (unsigned int i = 0; i < output_filter_state.size(); ++i)
+        {
+          checkpoint[4](0, i) = output_filter_state[i];
+        }
+
+      // Write a new file and then move it over the old one, so that an
+      // interrupted run never leaves a partial checkpoint behind.
+      const std::string temporary_name = checkpoint_name + ".tmp";
+      Threads::Mutex::ScopedLock lock(h5_mutex);
+      H5::save_full_matrices(temporary_name, checkpoint);
+      AssertThrow(std::rename(temporary_name.c_str(), checkpoint_name.c_str()) == 0,
+                  ExcMessage("Could not write the checkpoint " + checkpoint_name));
+    };
+
+    if (run_parameters.checkpoint_interval > 0
+        and std::ifstream(checkpoint_name).good())
+      {
+        std::vector<FullMatrix<double>> checkpoint;
+        {
+          Threads::Mutex::ScopedLock lock(h5_mutex);
+          H5::load_full_matrices(checkpoint_name, checkpoint);
+        }
+        AssertThrow(checkpoint.size() == 5
+                    and checkpoint[0].n() == 4
+                    and checkpoint[0](0, 3) == run_parameters.time_step
+                    and checkpoint[1].n() == n_pod_dofs
+                    and checkpoint[3].m() == solutions.m()
+                    and checkpoint[3].n() == solutions.n(),
+                    ExcMessage("The checkpoint " + checkpoint_name + " does not "
+                               "belong to this run."));
+        time = checkpoint[0](0, 0);
+        timestep_number = static_cast<unsigned int>(checkpoint[0](0, 1));
+        output_n = static_cast<unsigned int>(checkpoint[0](0, 2));
+        for (unsigned int i = 0; i < n_pod_dofs; ++i)
+          {
+            solution[i] = checkpoint[1](0, i);
+          }
+        Vector<double> state(static_cast<unsigned int>(checkpoint[2](0, 0)));
+        for (unsigned int i = 0; i < state.size(); ++i)
+          {
+            state[i] = checkpoint[2](0, i + 1);
+          }
+        rk_method->load_state(state);
+        solutions = checkpoint[3];
+        Vector<double> output_filter_state(checkpoint[4].n());
+        for (unsigned int i = 0; i < output_filter_state.size(); ++i)
+          {
+            output_filter_state[i] = checkpoint[4](0, i);
+          }
+        ad_filter.load_state(output_filter_state);
+        Threads::Mutex::ScopedLock lock(output_mutex);
+        std::cout << outname << ": resuming from step " << timestep_number
+                  << " (time " << time << ")" << std::endl;
+      }
+
+    while (time < run_parameters.final_time)
+      {
+        old_solution = solution;
+        rk_method->step(run_parameters.time_step, old_solution, solution);
+        time += run_parameters.time_step;
+
+        if (observers.notify(timestep_number, time, solution))
+          {
+            break;
+          }
+        ++timestep_number;
+
+        const bool stop = timestep_number == run_parameters.checkpoint_stop_step;
+        if (run_parameters.checkpoint_interval > 0
+            and (stop
+                 or timestep_number % run_parameters.checkpoint_interval == 0))
+          {
+            // the output may still be in progress on another thread.
+            observers.finish();
+            save_checkpoint();
+          }
+        AssertThrow(!stop, ExcStopped("The run " + outname));
+      }
+    observers.finish();
+    if (run_parameters.checkpoint_interval > 0)
+      {
+        std::remove(checkpoint_name.c_str());
+      }
+
+    // Do not bother saving a diverged run: write a short description instead.
+    if (divergence_monitor and divergence_monitor->stop_requested())
+      {
+        const std::string diagnostics_name = "divergence-"
+                                             + outname.substr(0, outname.rfind(".h5"))
+                                             + ".txt";
+        std::ofstream diagnostics(diagnostics_name);
+        diagnostics << "run: " << outname << std::endl;
+        divergence_monitor->print_diagnostics(diagnostics);
+        {
+          Threads::Mutex::ScopedLock lock(output_mutex);
+          std::cout << outname << ": diverged at time " << time << ", see "
+                    << diagnostics_name << std::endl;
+        }
+        AssertThrow(false, ExcDiverged("The run " + outname));
+      }
+
+    return std::make_pair(outname, solutions);
+  }
+
+
+  template<int dim>
+  template<typename Number, typename AccumulationNumber>
+  FullMatrix<double> ROM<dim>::integrate_reduced_precision
+  (const POD::NavierStokes::Parameters &run_parameters) const
+  {
+    typedef ODE::OperatorBase<Number> OperatorType;
+    const FullMatrix<double> run_linear_operator
+      = run_parameters.reynolds_n == parameters.reynolds_n
+        ? linear_operator : create_linear_operator(run_parameters.reynolds_n);
+
+    std::unique_ptr<OperatorType> rhs_function
+    {
+      new POD::NavierStokes::PlainRHS<Number, AccumulationNumber>
+      (run_linear_operator, mass_matrix, nonlinear_operator,
+       mean_contribution_vector, run_parameters.symmetric_nonlinearity)
+    };
+    std::unique_ptr<OperatorType> filter_function;
+    if (run_parameters.filter_model == POD::FilterModel::PostDifferentialFilter)
+      {
+        filter_function = std::unique_ptr<OperatorType>
+          (new POD::NavierStokes::PostDifferentialFilter<Number>
+           (mass_matrix, laplace_matrix, boundary_matrix,
+            run_parameters.filter_radius));
+      }
+    else if (run_parameters.filter_model
+             == POD::FilterModel::PostDifferentialFilterRelax)
+      {
+        filter_function = std::unique_ptr<OperatorType>
+          (new POD::NavierStokes::PostDifferentialFilterRelax<Number>
+           (mass_matrix, laplace_matrix, boundary_matrix,
+            run_parameters.filter_radius,
+            run_parameters.relaxation_parameter));
+      }
+    else if (run_parameters.filter_model == POD::FilterModel::PostL2ProjectionFilter)
+      {
+        filter_function = std::unique_ptr<OperatorType>
+          (new POD::NavierStokes::PostL2ProjectionFilter<Number>
+           (run_parameters.cutoff_n));
+      }
+    else
+      {
+        AssertThrow(run_parameters.filter_model == POD::FilterModel::Differential,
+                    ExcMessage("Reduced precision is only implemented for the "
+                               "'Differential', 'PostDifferentialFilter', "
+                               "'PostDifferentialFilterRelax' and "
+                               "'PostL2ProjectionFilter' models."));
+      }
+    AssertThrow(!run_parameters.use_hyper_reduction,
+                ExcMessage("Reduced precision is not implemented with hyper "
+                           "reduction."));
+    AssertThrow(run_parameters.time_stepping_method
+                == POD::TimeSteppingMethod::RungeKutta4,
+                ExcMessage("Reduced precision is only implemented with "
+                           "RungeKutta4."));
+    AssertThrow(run_parameters.parareal_n_slices == 0,
+                ExcMessage("Reduced precision is not implemented with "
+                           "parareal."));
+    AssertThrow(run_parameters.checkpoint_interval == 0,
+                ExcMessage("Reduced precision is not implemented with "
+                           "checkpointing."));
+    AssertThrow(run_parameters.monitor_interval == 0,
+                ExcMessage("Reduced precision is not implemented with "
+                           "divergence monitoring."));
+    std::unique_ptr<ODE::RungeKuttaBase<Number>> rk_method;
+    if (filter_function)
+      {
+        rk_method = std::unique_ptr<ODE::RungeKuttaBase<Number>>
+          (new ODE::RungeKutta4PostFilter<Number>
+           (std::move(rhs_function), std::move(filter_function)));
+      }
+    else
+      {
+        rk_method = std::unique_ptr<ODE::RungeKuttaBase<Number>>
+          (new ODE::RungeKutta4<Number>(std::move(rhs_function)));
+      }
+
+    Vector<Number> solution(initial_condition);
+    Vector<Number> old_solution(solution);
+
+    int n_save_steps = boost::math::iround
+      ((run_parameters.final_time - run_parameters.initial_time)
+       /run_parameters.time_step)/run_parameters.output_interval;
+    FullMatrix<double> solutions(n_save_steps + 1, n_pod_dofs);
+    unsigned int output_n = 0;
+
+    double time = run_parameters.initial_time;
+    unsigned int timestep_number = 0;
+    while (time < run_parameters.final_time)
+      {
+        old_solution = solution;
+        rk_method->step(run_parameters.time_step, old_solution, solution);
 
+        if (timestep_number % run_parameters.output_interval == 0)
+          {
             for (unsigned int i = 0; i < n_pod_dofs; ++i)
               {
-                solutions(output_n, i) = output_solution(i);
+                solutions(output_n, i) = solution(i);
               }
             ++output_n;
           }
         ++timestep_number;
-        time += parameters.time_step;
+        time += run_parameters.time_step;
+      }
+
+    return solutions;
+  }
+
+
+  template<int dim>
+  std::pair<std::string, FullMatrix<double>> ROM<dim>::integrate_with_precision
+  (const POD::NavierStokes::Parameters &run_parameters) const
+  {
+    if (run_parameters.precision == POD::Precision::Double)
+      {
+        return integrate(run_parameters);
+      }
+
+    const std::string outname = POD::NavierStokes::get_output_name
+      (run_parameters, n_pod_dofs);
+    if (run_parameters.precision == POD::Precision::Single)
+      {
+        return std::make_pair
+          ("single-precision-" + outname,
+           integrate_reduced_precision<float, float>(run_parameters));
+      }
+    else
+      {
+        return std::make_pair
+          ("mixed-precision-" + outname,
+           integrate_reduced_precision<float, double>(run_parameters));
+      }
+  }
+
+
+  template<int dim>
+  void ROM<dim>::report_precision_drift
+  (const std::string        &outname,
+   const FullMatrix<double> &solutions,
+   const FullMatrix<double> &double_solutions) const
+  {
+    // relative l2 difference at each saved time
+    const Vector<double> drift = POD::extra::relative_drift(solutions,
+                                                            double_solutions);
+
+    {
+      Threads::Mutex::ScopedLock lock(output_mutex);
+      std::cout << "relative drift of " << outname
+                << " from the double precision trajectory:" << std::endl
+                << "  final:   " << drift[drift.size() - 1] << std::endl
+                << "  maximum: " << drift.linfty_norm() << std::endl;
+    }
+    Threads::Mutex::ScopedLock lock(h5_mutex);
+    H5::save_vector("drift-" + outname, drift);
+  }
+
+
+  template<int dim>
+  void ROM<dim>::time_iterate()
+  {
+    std::string outname;
+    FullMatrix<double> solutions;
+    std::tie(outname, solutions) = integrate_with_precision(parameters);
+    if (parameters.precision != POD::Precision::Double
+        and parameters.validate_precision)
+      {
+        report_precision_drift(outname, solutions,
+                               integrate(parameters).second);
       }
 
     if (parameters.test_output)
@@ -202,11 +710,168 @@ namespace NavierStokes
   }
 
 
+  template<int dim>
+  void ROM<dim>::sweep()
+  {
+    AssertThrow(!parameters.test_output and
+                parameters.ensemble_initial_conditions.empty(),
+                ExcMessage("Parameter sweeps cannot be combined with testing or "
+                           "with ensembles."));
+    const std::vector<POD::NavierStokes::Parameters> grid
+      = parameters.expand_sweep();
+
+    MultithreadInfo::set_thread_limit
+    (parameters.sweep_n_threads == 0
+     ? numbers::invalid_unsigned_int : parameters.sweep_n_threads);
+
+    // diverged or stopped runs do not stop the sweep, but are counted so that
+    // the exit status reflects them.
+    unsigned int n_diverged_runs = 0;
+    unsigned int n_stopped_runs = 0;
+    Threads::Mutex diverged_mutex;
+    Threads::TaskGroup<void> tasks;
+    for (const POD::NavierStokes::Parameters &run_parameters : grid)
+      {
+        const std::function<void ()> run
+          = [this, &run_parameters, &n_diverged_runs, &n_stopped_runs,
+             &diverged_mutex]()
+        {
+          try
+            {
+              const auto result = integrate_with_precision(run_parameters);
+              if (run_parameters.precision != POD::Precision::Double
+                  and run_parameters.validate_precision)
+                {
+                  report_precision_drift(result.first, result.second,
+                                         integrate(run_parameters).second);
+                }
+              Threads::Mutex::ScopedLock lock(h5_mutex);
+              H5::save_full_matrix(result.first, result.second);
+            }
+          catch (const ExcDiverged &)
+            {
+              Threads::Mutex::ScopedLock lock(diverged_mutex);
+              ++n_diverged_runs;
+            }
+          catch (const ExcStopped &)
+            {
+              Threads::Mutex::ScopedLock lock(diverged_mutex);
+              ++n_stopped_runs;
+            }
+        };
+        tasks += Threads::new_task(run);
+      }
+    tasks.join_all();
+    AssertThrow(n_diverged_runs == 0,
+                ExcDiverged(Utilities::int_to_string(n_diverged_runs) + " of "
+                            + Utilities::int_to_string(grid.size())
+                            + " runs of the sweep"));
+    AssertThrow(n_stopped_runs == 0,
+                ExcStopped(Utilities::int_to_string(n_stopped_runs) + " of "
+                           + Utilities::int_to_string(grid.size())
+                           + " runs of the sweep"));
+  }
+
+
+  template<int dim>
+  void ROM<dim>::time_iterate_ensemble()
+  {
+    AssertThrow(parameters.filter_model == POD::FilterModel::Differential
+                and not parameters.use_hyper_reduction,
+                ExcMessage("Ensembles are only implemented for the "
+                           "'Differential' model without hyper reduction."));
+    AssertThrow(parameters.time_stepping_method
+                == POD::TimeSteppingMethod::RungeKutta4,
+                ExcMessage("Ensembles are only implemented with RungeKutta4."));
+    AssertThrow(parameters.parareal_n_slices == 0,
+                ExcMessage("Ensembles are not implemented with parareal."));
+    AssertThrow(parameters.checkpoint_interval == 0,
+                ExcMessage("Ensembles are not implemented with checkpointing."));
+    AssertThrow(parameters.monitor_interval == 0,
+                ExcMessage("Ensembles are not implemented with divergence "
+                           "monitoring."));
+    // each row of the file is one initial condition; each column of solution
+    // is one member of the ensemble.
+    FullMatrix<double> initial_conditions;
+    H5::load_full_matrix(parameters.ensemble_initial_conditions,
+                         initial_conditions);
+    AssertThrow(initial_conditions.n() >= n_pod_dofs,
+                ExcMessage("The initial conditions have fewer POD coefficients "
+                           "than n_pod_dofs."));
+    const unsigned int n_members = initial_conditions.m();
+    FullMatrix<double> ensemble_solution(n_pod_dofs, n_members);
+    for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+      {
+        for (unsigned int i = 0; i < n_pod_dofs; ++i)
+          {
+            ensemble_solution(i, member_n) = initial_conditions(member_n, i);
+          }
+      }
+    FullMatrix<double> old_ensemble_solution(ensemble_solution);
+    double time = parameters.initial_time;
+    unsigned int timestep_number = 0;
+
+    const std::string outname = POD::NavierStokes::get_output_name
+      (parameters, n_pod_dofs);
+    ODE::EnsembleRungeKutta4 rk_method
+    (std::unique_ptr<ODE::EnsembleOperatorBase>
+     (new POD::NavierStokes::EnsemblePlainRHS
+      (linear_operator, mass_matrix, nonlinear_operator,
+       mean_contribution_vector)));
+
+    int n_save_steps = boost::math::iround
+      ((parameters.final_time - parameters.initial_time)/parameters.time_step)
+      /parameters.output_interval;
+    std::vector<FullMatrix<double>> solutions
+      (n_members, FullMatrix<double>(n_save_steps + 1, n_pod_dofs));
+    unsigned int output_n = 0;
+
+    while (time < parameters.final_time)
+      {
+        old_ensemble_solution = ensemble_solution;
+        rk_method.step(parameters.time_step, old_ensemble_solution,
+                       ensemble_solution);
+
+        if (timestep_number % parameters.output_interval == 0)
+          {
+            for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+              {
+                for (unsigned int i = 0; i < n_pod_dofs; ++i)
+                  {
+                    solutions[member_n](output_n, i)
+                      = ensemble_solution(i, member_n);
+                  }
+              }
+            ++output_n;
+          }
+        ++timestep_number;
+        time += parameters.time_step;
+      }
+
+    for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+      {
+        H5::save_full_matrix("ensemble-member-" + Utilities::int_to_string(member_n)
+                             + "-" + outname, solutions[member_n]);
+      }
+  }
+
+
   template<int dim>
   void ROM<dim>::run()
   {
     setup_reduced_system();
-    time_iterate();
+    if (parameters.is_sweep())
+      {
+        sweep();
+      }
+    else if (parameters.ensemble_initial_conditions.empty())
+      {
+        time_iterate();
+      }
+    else
+      {
+        time_iterate_ensemble();
+      }
   }
 }
 
@@ -227,6 +892,16 @@ int main(int argc, char **argv)
         nse_solver.run();
       }
     }
+  catch (NavierStokes::ExcDiverged &exc)
+    {
+      std::cerr << std::endl << exc.what() << std::endl;
+      return 2;
+    }
+  catch (NavierStokes::ExcStopped &exc)
+    {
+      std::cerr << std::endl << exc.what() << std::endl;
+      return 3;
+    }
   catch (std::exception &exc)
     {
       std::cerr << std::endl << std::endl
@@ -51,7 +51,7 @@ namespace POD
 
   namespace NavierStokes
   {
-    class PlainRHS : public ODE::OperatorBase
+    class PlainRHS : public ODE::OperatorBase<double>
     {
     public:
       PlainRHS();
@@ -92,7 +92,7 @@ namespace POD
      */
     namespace AD
     {
-      class FilterBase : public ODE::OperatorBase
+      class FilterBase : public ODE::OperatorBase<double>
       {
       public:
         FilterBase
@@ -161,7 +161,7 @@ namespace POD
       };
 
 
-      class FilterRHS : public ODE::OperatorBase
+      class FilterRHS : public ODE::OperatorBase<double>
       {
       public:
         FilterRHS
@@ -216,7 +216,7 @@ namespace POD
     };
 
 
-    class PostDifferentialFilter : public ODE::OperatorBase
+    class PostDifferentialFilter : public ODE::OperatorBase<double>
     {
     public:
       PostDifferentialFilter
@@ -231,7 +231,7 @@ namespace POD
     };
 
 
-    class PostL2ProjectionFilter : public ODE::OperatorBase
+    class PostL2ProjectionFilter : public ODE::OperatorBase<double>
     {
     public:
       PostL2ProjectionFilter(const unsigned int cutoff_n);
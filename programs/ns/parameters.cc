@@ -1,9 +1,46 @@
+#include <deal.II/base/utilities.h>
+
+#include <algorithm>
+
 #include "parameters.h"
 
 namespace POD
 {
   namespace NavierStokes
   {
+    namespace
+    {
+      // replace each point of grid by one point for each entry of values.
+      template<typename T>
+      void expand_grid(std::vector<Parameters> &grid,
+                       const std::vector<T>    &values,
+                       T Parameters::*          member)
+      {
+        if (values.empty())
+          {
+            return;
+          }
+        // a repeated value would give two runs with the same output file
+        std::vector<T> sorted_values(values);
+        std::sort(sorted_values.begin(), sorted_values.end());
+        AssertThrow(std::adjacent_find(sorted_values.begin(), sorted_values.end())
+                    == sorted_values.end(),
+                    ExcMessage("The lists in 'Parameter Sweep' may not contain "
+                               "duplicate values."));
+        std::vector<Parameters> new_grid;
+        for (const Parameters &point : grid)
+          {
+            for (const T value : values)
+              {
+                new_grid.push_back(point);
+                new_grid.back().*member = value;
+              }
+          }
+        grid.swap(new_grid);
+      }
+    }
+
+
     void Parameters::configure_parameter_handler
     (ParameterHandler &parameter_handler) const
     {
@@ -26,6 +63,11 @@ namespace POD
         parameter_handler.declare_entry
           ("noise_multiplier", "0.0", Patterns::Double(0.0), "Multiplier on the "
            "randomly generated noise vector for approximate deconvolution models.");
+        parameter_handler.declare_entry
+          ("noise_stream", "0", Patterns::Integer(0), "Random number stream of "
+           "the noise for approximate deconvolution models. Runs with different "
+           "streams draw independent noise; run i of a parameter sweep uses "
+           "noise_stream + i.");
         parameter_handler.declare_entry
           ("lavrentiev_parameter", "0.0", Patterns::Double(0.0), "Multiplier for"
            " the Lavrentiev regularization.");
@@ -48,12 +90,116 @@ namespace POD
       {
         parameter_handler.declare_entry
           ("n_pod_dofs", "1", Patterns::Integer(1), "Number of POD vectors.");
+        parameter_handler.declare_entry
+          ("use_hyper_reduction", "false", Patterns::Bool(), "Whether or not to "
+           "evaluate the nonlinearity with the reduced quadrature rule computed "
+           "by compute-hyper-reduction. The rule is built from the unfiltered "
+           "POD vectors, so the 'Differential' model requires a zero "
+           "filter_radius.");
+        parameter_handler.declare_entry
+          ("symmetric_nonlinearity", "false", Patterns::Bool(), "Whether or not "
+           "to store the nonlinearity in symmetric form, which halves the cost "
+           "of evaluating it. This is only used by the models that apply the "
+           "nonlinearity to a single vector ('Differential', the post filters, "
+           "and 'ADLavrentiev').");
+        parameter_handler.declare_entry
+          ("use_fixed_size_kernels", "false", Patterns::Bool(), "Whether or not "
+           "to use the compile-time fixed-size kernels for the 'Differential' "
+           "model when n_pod_dofs is one of the instantiated sizes. The results "
+           "agree with the generic kernels up to roundoff.");
+        parameter_handler.declare_entry
+          ("pre_invert_mass_matrix", "false", Patterns::Bool(), "Whether or not "
+           "to multiply the reduced operators by the inverse of the mass matrix "
+           "once during setup so that the right hand side does not solve a "
+           "linear system on every evaluation. A mass matrix that is the "
+           "identity to within 1e-12 is replaced by the identity.");
+        parameter_handler.declare_entry
+          ("ensemble_initial_conditions", "", Patterns::Anything(), "If not "
+           "empty, the name of an HDF5 file containing a matrix whose rows are "
+           "initial conditions. All of them are advanced together (only the "
+           "'Differential' model is supported) and the coefficients of member b "
+           "are saved with the prefix 'ensemble-member-b-'.");
+        parameter_handler.declare_entry
+          ("precision", "Double", Patterns::Selection("Double|Single|Mixed"),
+           "Floating point precision of the online ROM. 'Single' stores and "
+           "evaluates everything in single precision; 'Mixed' stores the state "
+           "and the operators in single precision but accumulates sums in double "
+           "precision. Only 'Differential', 'PostDifferentialFilter', "
+           "'PostDifferentialFilterRelax' and 'PostL2ProjectionFilter' "
+           "support reduced precision.");
+        parameter_handler.declare_entry
+          ("validate_precision", "false", Patterns::Bool(), "If true and "
+           "precision is not 'Double', also run the double precision ROM and "
+           "report the relative drift between the two trajectories (for each "
+           "run of a sweep).");
         parameter_handler.declare_entry
           ("initial_time", "30.0", Patterns::Double(), " Initial time for the ROM.");
         parameter_handler.declare_entry
           ("final_time", "500.0", Patterns::Double(), " Final time for the ROM.");
         parameter_handler.declare_entry
           ("time_step", "1.0e-4", Patterns::Double(0.0), " Time step");
+        parameter_handler.declare_entry
+          ("time_stepping_method", "RungeKutta4",
+           Patterns::Selection("RungeKutta4|DormandPrince54|BDF2|CrankNicolson|"
+                               "IMEXARS222|IMEXARS443|ETDRK4|"
+                               "LowStorageRK3|LowStorageRK4|Multirate"),
+           "Time integrator. 'DormandPrince54' picks the step size adaptively "
+           "(time_step is then only the size of the first step) and saves "
+           "the solution every output_interval*time_step time units by "
+           "interpolation. It is not implemented for the post filter models. "
+           "'BDF2' and 'CrankNicolson' are implicit, so they permit much "
+           "larger time steps for stiff ROMs; they are only implemented for "
+           "the 'Differential', 'L2Projection' and 'LerayHybrid' models. "
+           "'IMEXARS222' and 'IMEXARS443' treat the linear part of the ROM "
+           "implicitly and the nonlinearity explicitly (second and third "
+           "order); they are not implemented for the fixed size kernels. "
+           "'ETDRK4' integrates the linear part exactly (with matrix "
+           "exponentials computed once per time step size) and is not "
+           "implemented for the fixed size kernels or the post filter models. "
+           "'LowStorageRK3' and 'LowStorageRK4' are explicit 2N-storage "
+           "schemes (three stages, third order and five stages, fourth order) "
+           "that need less memory traffic per stage than RungeKutta4. "
+           "'Multirate' advances the leading multirate_n_slow_modes "
+           "coefficients with time_step and the others with "
+           "multirate_n_substeps substeps per step; it is only implemented "
+           "for the 'Differential' model without hyper reduction and with "
+           "pre_invert_mass_matrix.");
+        parameter_handler.declare_entry
+          ("absolute_tolerance", "1.0e-8", Patterns::Double(0.0), "Absolute "
+           "error tolerance of the adaptive time integrators.");
+        parameter_handler.declare_entry
+          ("newton_tolerance", "1.0e-10", Patterns::Double(0.0), "Relative "
+           "tolerance on the Newton update of the implicit time integrators.");
+        parameter_handler.declare_entry
+          ("max_newton_iterations", "10", Patterns::Integer(1), "Number of "
+           "Newton iterations done by the implicit time integrators before the "
+           "Jacobian is recomputed.");
+        parameter_handler.declare_entry
+          ("multirate_n_slow_modes", "0", Patterns::Integer(0), "Number of "
+           "leading (slow) POD coefficients of the multirate integrator.");
+        parameter_handler.declare_entry
+          ("multirate_n_substeps", "10", Patterns::Integer(1), "Number of "
+           "substeps taken by the fast POD coefficients in each step of the "
+           "multirate integrator.");
+        parameter_handler.declare_entry
+          ("relative_tolerance", "1.0e-8", Patterns::Double(0.0), "Relative "
+           "error tolerance of the adaptive time integrators.");
+        parameter_handler.declare_entry
+          ("parareal_n_slices", "0", Patterns::Integer(0), "If positive, "
+           "integrate with the parareal method on this many time slices, which "
+           "are advanced in parallel. The fine integrator is the one given by "
+           "time_stepping_method and the coarse integrator is the same method "
+           "with parareal_coarse_time_step.");
+        parameter_handler.declare_entry
+          ("parareal_coarse_time_step", "1.0e-2", Patterns::Double(0.0),
+           "Time step of the coarse parareal integrator.");
+        parameter_handler.declare_entry
+          ("parareal_tolerance", "1.0e-8", Patterns::Double(0.0), "Largest "
+           "relative change of a slice boundary value at which the parareal "
+           "iteration stops.");
+        parameter_handler.declare_entry
+          ("parareal_max_iterations", "10", Patterns::Integer(1), "Maximum "
+           "number of parareal iterations.");
       }
       parameter_handler.leave_subsection();
 
@@ -62,6 +208,35 @@ namespace POD
         parameter_handler.declare_entry
           ("output_interval", "10", Patterns::Integer(0), " Number of iterations "
            "between which output is saved.");
+        parameter_handler.declare_entry
+          ("asynchronous_output", "false", Patterns::Bool(), "Whether or not "
+           "to save the output on another thread while the time loop "
+           "continues.");
+        parameter_handler.declare_entry
+          ("checkpoint_interval", "0", Patterns::Integer(0), "Number of "
+           "iterations between checkpoints. If a checkpoint exists then the "
+           "run resumes from it. 0 disables checkpointing.");
+        parameter_handler.declare_entry
+          ("checkpoint_stop_step", "0", Patterns::Integer(0), "If nonzero, "
+           "write a checkpoint after this time step and stop (e.g., to fit "
+           "into the time limit of a batch job); running again resumes from "
+           "the checkpoint.");
+      }
+      parameter_handler.leave_subsection();
+
+      parameter_handler.enter_subsection("Divergence Monitor");
+      {
+        parameter_handler.declare_entry
+          ("monitor_interval", "0", Patterns::Integer(0), "Number of "
+           "iterations between checks for divergence. 0 disables the checks.");
+        parameter_handler.declare_entry
+          ("monitor_max_energy", "0.0", Patterns::Double(0.0), "The run is "
+           "stopped if the energy a^T M a of the POD coefficients exceeds this "
+           "value. 0 disables the check.");
+        parameter_handler.declare_entry
+          ("monitor_max_coefficient", "0.0", Patterns::Double(0.0), "The run is "
+           "stopped if any POD coefficient exceeds this value in absolute "
+           "value. 0 disables the check.");
       }
       parameter_handler.leave_subsection();
 
@@ -72,6 +247,30 @@ namespace POD
            "the output against a known output.");
       }
       parameter_handler.leave_subsection();
+
+      parameter_handler.enter_subsection("Parameter Sweep");
+      {
+        parameter_handler.declare_entry
+          ("reynolds_n", "", Patterns::List(Patterns::Double(0.0)), "Comma "
+           "separated list of Reynolds numbers to run. Leave empty to only use "
+           "the value in 'DNS Information'.");
+        parameter_handler.declare_entry
+          ("filter_radius", "", Patterns::List(Patterns::Double(0.0)), "Comma "
+           "separated list of filter radii to run.");
+        parameter_handler.declare_entry
+          ("cutoff_n", "", Patterns::List(Patterns::Integer(0)), "Comma "
+           "separated list of cutoff values to run.");
+        parameter_handler.declare_entry
+          ("lavrentiev_parameter", "", Patterns::List(Patterns::Double(0.0)),
+           "Comma separated list of Lavrentiev parameters to run.");
+        parameter_handler.declare_entry
+          ("relaxation_parameter", "", Patterns::List(Patterns::Double(0.0)),
+           "Comma separated list of relaxation parameters to run.");
+        parameter_handler.declare_entry
+          ("n_threads", "0", Patterns::Integer(0), "Number of configurations "
+           "to run at once. Zero means one per core.");
+      }
+      parameter_handler.leave_subsection();
     }
 
     void Parameters::read_data(const std::string &file_name)
@@ -130,6 +329,7 @@ namespace POD
           }
 
         noise_multiplier = parameter_handler.get_double("noise_multiplier");
+        noise_stream = parameter_handler.get_integer("noise_stream");
         lavrentiev_parameter = parameter_handler.get_double("lavrentiev_parameter");
         relaxation_parameter = parameter_handler.get_double("relaxation_parameter");
         filter_radius = parameter_handler.get_double("filter_radius");
@@ -141,15 +341,108 @@ namespace POD
       parameter_handler.enter_subsection("ROM Configuration");
       {
         n_pod_dofs = parameter_handler.get_double("n_pod_dofs");
+        use_hyper_reduction = parameter_handler.get_bool("use_hyper_reduction");
+        symmetric_nonlinearity =
+          parameter_handler.get_bool("symmetric_nonlinearity");
+        use_fixed_size_kernels =
+          parameter_handler.get_bool("use_fixed_size_kernels");
+        pre_invert_mass_matrix =
+          parameter_handler.get_bool("pre_invert_mass_matrix");
+        ensemble_initial_conditions =
+          parameter_handler.get("ensemble_initial_conditions");
+        const std::string precision_param = parameter_handler.get("precision");
+        if (precision_param == std::string("Single"))
+          {
+            precision = POD::Precision::Single;
+          }
+        else if (precision_param == std::string("Mixed"))
+          {
+            precision = POD::Precision::Mixed;
+          }
+        else
+          {
+            precision = POD::Precision::Double;
+          }
+        validate_precision = parameter_handler.get_bool("validate_precision");
         initial_time = parameter_handler.get_double("initial_time");
         final_time = parameter_handler.get_double("final_time");
         time_step = parameter_handler.get_double("time_step");
+        const std::string time_stepping_method_param
+          = parameter_handler.get("time_stepping_method");
+        if (time_stepping_method_param == std::string("DormandPrince54"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::DormandPrince54;
+          }
+        else if (time_stepping_method_param == std::string("BDF2"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::BDF2;
+          }
+        else if (time_stepping_method_param == std::string("CrankNicolson"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::CrankNicolson;
+          }
+        else if (time_stepping_method_param == std::string("IMEXARS222"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::IMEXARS222;
+          }
+        else if (time_stepping_method_param == std::string("IMEXARS443"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::IMEXARS443;
+          }
+        else if (time_stepping_method_param == std::string("ETDRK4"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::ETDRK4;
+          }
+        else if (time_stepping_method_param == std::string("LowStorageRK3"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::LowStorageRK3;
+          }
+        else if (time_stepping_method_param == std::string("LowStorageRK4"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::LowStorageRK4;
+          }
+        else if (time_stepping_method_param == std::string("Multirate"))
+          {
+            time_stepping_method = POD::TimeSteppingMethod::Multirate;
+          }
+        else
+          {
+            time_stepping_method = POD::TimeSteppingMethod::RungeKutta4;
+          }
+        absolute_tolerance = parameter_handler.get_double("absolute_tolerance");
+        relative_tolerance = parameter_handler.get_double("relative_tolerance");
+        newton_tolerance = parameter_handler.get_double("newton_tolerance");
+        max_newton_iterations =
+          parameter_handler.get_integer("max_newton_iterations");
+        multirate_n_slow_modes =
+          parameter_handler.get_integer("multirate_n_slow_modes");
+        multirate_n_substeps =
+          parameter_handler.get_integer("multirate_n_substeps");
+        parareal_n_slices = parameter_handler.get_integer("parareal_n_slices");
+        parareal_coarse_time_step =
+          parameter_handler.get_double("parareal_coarse_time_step");
+        parareal_tolerance = parameter_handler.get_double("parareal_tolerance");
+        parareal_max_iterations =
+          parameter_handler.get_integer("parareal_max_iterations");
       }
       parameter_handler.leave_subsection();
 
       parameter_handler.enter_subsection("Output Configuration");
       {
         output_interval = parameter_handler.get_integer("output_interval");
+        asynchronous_output = parameter_handler.get_bool("asynchronous_output");
+        checkpoint_interval = parameter_handler.get_integer("checkpoint_interval");
+        checkpoint_stop_step
+          = parameter_handler.get_integer("checkpoint_stop_step");
+      }
+      parameter_handler.leave_subsection();
+
+      parameter_handler.enter_subsection("Divergence Monitor");
+      {
+        monitor_interval = parameter_handler.get_integer("monitor_interval");
+        monitor_max_energy = parameter_handler.get_double("monitor_max_energy");
+        monitor_max_coefficient =
+          parameter_handler.get_double("monitor_max_coefficient");
       }
       parameter_handler.leave_subsection();
 
@@ -158,6 +451,91 @@ namespace POD
         test_output = parameter_handler.get_bool("test_output");
       }
       parameter_handler.leave_subsection();
+
+      parameter_handler.enter_subsection("Parameter Sweep");
+      {
+        sweep_reynolds_n = Utilities::string_to_double
+          (Utilities::split_string_list(parameter_handler.get("reynolds_n")));
+        sweep_filter_radius = Utilities::string_to_double
+          (Utilities::split_string_list(parameter_handler.get("filter_radius")));
+        sweep_cutoff_n.clear();
+        for (const int value : Utilities::string_to_int
+               (Utilities::split_string_list(parameter_handler.get("cutoff_n"))))
+          {
+            sweep_cutoff_n.push_back(value);
+          }
+        sweep_lavrentiev_parameter = Utilities::string_to_double
+          (Utilities::split_string_list
+           (parameter_handler.get("lavrentiev_parameter")));
+        sweep_relaxation_parameter = Utilities::string_to_double
+          (Utilities::split_string_list
+           (parameter_handler.get("relaxation_parameter")));
+        sweep_n_threads = parameter_handler.get_integer("n_threads");
+      }
+      parameter_handler.leave_subsection();
+    }
+
+
+    bool Parameters::is_sweep() const
+    {
+      return !(sweep_reynolds_n.empty() and sweep_filter_radius.empty()
+               and sweep_cutoff_n.empty() and sweep_lavrentiev_parameter.empty()
+               and sweep_relaxation_parameter.empty());
+    }
+
+
+    std::vector<Parameters> Parameters::expand_sweep() const
+    {
+      Parameters base = *this;
+      base.sweep_reynolds_n.clear();
+      base.sweep_filter_radius.clear();
+      base.sweep_cutoff_n.clear();
+      base.sweep_lavrentiev_parameter.clear();
+      base.sweep_relaxation_parameter.clear();
+
+      // Only vary the parameters that the filter model uses: the others do
+      // not change the run (or its output file name).
+      const bool uses_filter_radius
+        = filter_model != POD::FilterModel::L2Projection
+          and filter_model != POD::FilterModel::PostL2ProjectionFilter;
+      const bool uses_cutoff_n
+        = filter_model == POD::FilterModel::L2Projection
+          or filter_model == POD::FilterModel::LerayHybrid
+          or filter_model == POD::FilterModel::PostL2ProjectionFilter;
+      const bool uses_lavrentiev_parameter
+        = filter_model == POD::FilterModel::ADLavrentiev;
+      const bool uses_relaxation_parameter
+        = filter_model == POD::FilterModel::PostDifferentialFilterRelax;
+
+      // expand the grid one parameter at a time
+      std::vector<Parameters> grid {base};
+      expand_grid(grid, sweep_reynolds_n, &Parameters::reynolds_n);
+      if (uses_filter_radius)
+        {
+          expand_grid(grid, sweep_filter_radius, &Parameters::filter_radius);
+        }
+      if (uses_cutoff_n)
+        {
+          expand_grid(grid, sweep_cutoff_n, &Parameters::cutoff_n);
+        }
+      if (uses_lavrentiev_parameter)
+        {
+          expand_grid(grid, sweep_lavrentiev_parameter,
+                      &Parameters::lavrentiev_parameter);
+        }
+      if (uses_relaxation_parameter)
+        {
+          expand_grid(grid, sweep_relaxation_parameter,
+                      &Parameters::relaxation_parameter);
+        }
+
+      // give every run its own noise
+      for (unsigned int run_n = 0; run_n < grid.size(); ++run_n)
+        {
+          grid[run_n].noise_stream = noise_stream + run_n;
+        }
+
+      return grid;
     }
   }
 }
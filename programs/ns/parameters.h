@@ -21,6 +21,8 @@
 #include <deal.II/base/parameter_handler.h>
 
 #include <fstream>
+#include <string>
+#include <vector>
 
 using namespace dealii;
 namespace POD
@@ -37,6 +39,27 @@ namespace POD
       ADTikonov
     };
 
+  enum class Precision
+    {
+      Double,
+      Single,
+      Mixed
+    };
+
+  enum class TimeSteppingMethod
+    {
+      RungeKutta4,
+      DormandPrince54,
+      BDF2,
+      CrankNicolson,
+      IMEXARS222,
+      IMEXARS443,
+      ETDRK4,
+      LowStorageRK3,
+      LowStorageRK4,
+      Multirate
+    };
+
   namespace NavierStokes
   {
     class Parameters
@@ -46,6 +69,12 @@ namespace POD
 
       POD::FilterModel filter_model;
       double noise_multiplier;
+      /*
+       * Key of the random number stream of the approximate deconvolution
+       * noise. Run i of a sweep uses noise_stream + i, so the runs draw
+       * independent noise.
+       */
+      unsigned int noise_stream;
       double lavrentiev_parameter;
       double relaxation_parameter;
       double filter_radius;
@@ -53,15 +82,65 @@ namespace POD
       bool filter_mean;
 
       unsigned int n_pod_dofs;
+      bool use_hyper_reduction;
+      bool symmetric_nonlinearity;
+      bool use_fixed_size_kernels;
+      bool pre_invert_mass_matrix;
+      std::string ensemble_initial_conditions;
+      POD::Precision precision;
+      bool validate_precision;
       double initial_time;
       double final_time;
       double time_step;
+      POD::TimeSteppingMethod time_stepping_method;
+      double absolute_tolerance;
+      double relative_tolerance;
+      double newton_tolerance;
+      unsigned int max_newton_iterations;
+      unsigned int multirate_n_slow_modes;
+      unsigned int multirate_n_substeps;
+      unsigned int parareal_n_slices;
+      double parareal_coarse_time_step;
+      double parareal_tolerance;
+      unsigned int parareal_max_iterations;
 
       int output_interval;
+      bool asynchronous_output;
+      int checkpoint_interval;
+      unsigned int checkpoint_stop_step;
+
+      unsigned int monitor_interval;
+      double monitor_max_energy;
+      double monitor_max_coefficient;
 
       bool test_output;
 
+      /*
+       * Values for a parameter sweep. An empty list means that only the value
+       * above is used.
+       */
+      std::vector<double> sweep_reynolds_n;
+      std::vector<double> sweep_filter_radius;
+      std::vector<unsigned int> sweep_cutoff_n;
+      std::vector<double> sweep_lavrentiev_parameter;
+      std::vector<double> sweep_relaxation_parameter;
+      unsigned int sweep_n_threads;
+
       void read_data(const std::string &file_name);
+
+      /*
+       * Return true if any of the sweep lists is not empty.
+       */
+      bool is_sweep() const;
+
+      /*
+       * Return one set of parameters for each point of the tensor product grid
+       * given by the sweep lists. Lists of parameters that the filter model
+       * does not use are ignored, and no list may repeat a value, so every
+       * point is a different run. The sweep lists of the returned parameters
+       * are empty.
+       */
+      std::vector<Parameters> expand_sweep() const;
     private:
       void configure_parameter_handler(ParameterHandler &parameter_handler) const;
     };
@@ -6,7 +6,239 @@ namespace POD
   {
     using namespace dealii;
 
-    std::pair<std::string, std::unique_ptr<ODE::RungeKuttaBase>> rk_factory
+    namespace
+    {
+      bool is_imex(const POD::TimeSteppingMethod time_stepping_method)
+      {
+        return time_stepping_method == POD::TimeSteppingMethod::IMEXARS222
+               or time_stepping_method == POD::TimeSteppingMethod::IMEXARS443;
+      }
+
+
+      ODE::IMEXScheme imex_scheme
+      (const POD::TimeSteppingMethod time_stepping_method)
+      {
+        return time_stepping_method == POD::TimeSteppingMethod::IMEXARS222
+               ? ODE::IMEXScheme::ARS222 : ODE::IMEXScheme::ARS443;
+      }
+
+
+      // Create the time integrator requested by parameters for a right hand
+      // side without a post filter.
+      std::unique_ptr<ODE::RungeKuttaBase<double>> create_runge_kutta
+      (std::unique_ptr<ODE::OperatorBase<double>> rhs_function,
+       const POD::NavierStokes::Parameters &parameters)
+      {
+        if (parameters.time_stepping_method
+            == POD::TimeSteppingMethod::DormandPrince54)
+          {
+            // every evaluation draws new noise, so a rejected and retried
+            // step would see different forcing and the error estimate would
+            // measure the noise rather than the truncation error.
+            AssertThrow(parameters.filter_model != POD::FilterModel::ADLavrentiev
+                        or parameters.noise_multiplier == 0.0,
+                        ExcMessage("DormandPrince54 is not implemented for the "
+                                   "'ADLavrentiev' model with a nonzero noise "
+                                   "multiplier."));
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::DormandPrince54
+               (std::move(rhs_function), parameters.absolute_tolerance,
+                parameters.relative_tolerance));
+          }
+        else if (is_imex(parameters.time_stepping_method))
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::IMEXRungeKutta
+               (std::move(rhs_function),
+                imex_scheme(parameters.time_stepping_method)));
+          }
+        else if (parameters.time_stepping_method
+                 == POD::TimeSteppingMethod::ETDRK4)
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::ETDRungeKutta4(std::move(rhs_function)));
+          }
+        else if (parameters.time_stepping_method
+                 == POD::TimeSteppingMethod::Multirate)
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::MultirateRungeKutta
+               (std::move(rhs_function), parameters.multirate_n_slow_modes,
+                parameters.multirate_n_substeps));
+          }
+        else if (parameters.time_stepping_method
+                 == POD::TimeSteppingMethod::LowStorageRK3
+                 or parameters.time_stepping_method
+                 == POD::TimeSteppingMethod::LowStorageRK4)
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::LowStorageRungeKutta
+               (std::move(rhs_function),
+                parameters.time_stepping_method
+                == POD::TimeSteppingMethod::LowStorageRK3
+                ? ODE::LowStorageScheme::Williamson3
+                : ODE::LowStorageScheme::CarpenterKennedy4));
+          }
+        return std::unique_ptr<ODE::RungeKuttaBase<double>>
+          (new ODE::RungeKutta4<double>(std::move(rhs_function)));
+      }
+
+
+      // Same as create_runge_kutta, but for the post filter models.
+      std::unique_ptr<ODE::RungeKuttaBase<double>> create_post_filter_runge_kutta
+      (std::unique_ptr<ODE::OperatorBase<double>> rhs_function,
+       std::unique_ptr<ODE::OperatorBase<double>> filter_function,
+       const POD::NavierStokes::Parameters &parameters)
+      {
+        if (is_imex(parameters.time_stepping_method))
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::IMEXRungeKutta
+               (std::move(rhs_function),
+                imex_scheme(parameters.time_stepping_method),
+                std::move(filter_function)));
+          }
+        return std::unique_ptr<ODE::RungeKuttaBase<double>>
+          (new ODE::RungeKutta4PostFilter<double>
+           (std::move(rhs_function), std::move(filter_function)));
+      }
+
+
+      bool is_implicit(const POD::TimeSteppingMethod time_stepping_method)
+      {
+        return time_stepping_method == POD::TimeSteppingMethod::BDF2
+               or time_stepping_method == POD::TimeSteppingMethod::CrankNicolson;
+      }
+
+
+      // Same as create_runge_kutta, but for the implicit methods.
+      std::unique_ptr<ODE::RungeKuttaBase<double>> create_implicit_integrator
+      (std::unique_ptr<ODE::JacobianOperator<double>> rhs_function,
+       const POD::NavierStokes::Parameters &parameters)
+      {
+        if (parameters.time_stepping_method == POD::TimeSteppingMethod::BDF2)
+          {
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>
+              (new ODE::BDF2
+               (std::move(rhs_function), parameters.newton_tolerance,
+                parameters.max_newton_iterations));
+          }
+        return std::unique_ptr<ODE::RungeKuttaBase<double>>
+          (new ODE::CrankNicolson
+           (std::move(rhs_function), parameters.newton_tolerance,
+            parameters.max_newton_iterations));
+      }
+    }
+
+
+    std::string get_output_name(const POD::NavierStokes::Parameters &parameters,
+                                const unsigned int n_pod_dofs)
+    {
+      std::ostringstream outname;
+      outname.precision(8);
+      if (parameters.filter_model == POD::FilterModel::Differential)
+        {
+          outname << "pod-leray-radius-" << parameters.filter_radius;
+        }
+      else if (parameters.filter_model == POD::FilterModel::L2Projection)
+        {
+          outname << "pod-l2-projection-cutoff-" << parameters.cutoff_n;
+        }
+      else if (parameters.filter_model == POD::FilterModel::LerayHybrid)
+        {
+          outname << "pod-leray-hybrid-cutoff-" << parameters.cutoff_n
+                  << "-radius-" << parameters.filter_radius;
+        }
+      else if (parameters.filter_model == POD::FilterModel::PostDifferentialFilter)
+        {
+          outname << "pod-postfilter-differential-radius-"
+                  << parameters.filter_radius;
+        }
+      else if (parameters.filter_model
+               == POD::FilterModel::PostDifferentialFilterRelax)
+        {
+          outname << "pod-postfilter-differential-radius-"
+                  << parameters.filter_radius
+                  << "-relaxation-" << parameters.relaxation_parameter;
+        }
+      else if (parameters.filter_model == POD::FilterModel::PostL2ProjectionFilter)
+        {
+          outname << "pod-postfilter-cutoff-n-" << parameters.cutoff_n;
+        }
+      else if (parameters.filter_model == POD::FilterModel::ADLavrentiev)
+        {
+          outname << "pod-ad-lavrentiev-" << parameters.lavrentiev_parameter
+                  << "-filter-radius-" << parameters.filter_radius
+                  << "-noise-multiplier-" << parameters.noise_multiplier;
+        }
+
+      if (not parameters.filter_mean)
+        {
+          outname << "-unfiltered-mean";
+        }
+      if (parameters.use_hyper_reduction)
+        {
+          outname << "-hyper-reduced";
+        }
+      if (parameters.time_stepping_method
+          == POD::TimeSteppingMethod::DormandPrince54)
+        {
+          outname << "-dormand-prince-tolerance-"
+                  << parameters.relative_tolerance;
+        }
+      else if (parameters.time_stepping_method == POD::TimeSteppingMethod::BDF2)
+        {
+          outname << "-bdf2";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::CrankNicolson)
+        {
+          outname << "-crank-nicolson";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::IMEXARS222)
+        {
+          outname << "-imex-ars222";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::IMEXARS443)
+        {
+          outname << "-imex-ars443";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::ETDRK4)
+        {
+          outname << "-etdrk4";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::LowStorageRK3)
+        {
+          outname << "-low-storage-rk3";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::LowStorageRK4)
+        {
+          outname << "-low-storage-rk4";
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::Multirate)
+        {
+          outname << "-multirate-" << parameters.multirate_n_slow_modes
+                  << "-" << parameters.multirate_n_substeps;
+        }
+      if (parameters.parareal_n_slices > 0)
+        {
+          outname << "-parareal-" << parameters.parareal_n_slices;
+        }
+      outname << "-r-" << n_pod_dofs
+              << "-Re-" << parameters.reynolds_n
+              << ".h5";
+
+      return outname.str();
+    }
+
+
+    std::pair<std::string, std::unique_ptr<ODE::RungeKuttaBase<double>>> rk_factory
     (const FullMatrix<double>              &boundary_matrix,
      const FullMatrix<double>              &joint_convection,
      const FullMatrix<double>              &laplace_matrix,
@@ -14,52 +246,154 @@ namespace POD
      const Vector<double>                  &mean_contribution_vector,
      const FullMatrix<double>              &mass_matrix,
      const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const ReducedQuadrature               &reduced_quadrature,
      const POD::NavierStokes::Parameters   &parameters)
     {
-      std::ostringstream outname;
-      outname.precision(8);
-      std::ostringstream outname_tail;
-      if (not parameters.filter_mean)
+      const std::string outname = get_output_name
+        (parameters, mean_contribution_vector.size());
+
+      // The operators used by the right hand side. The filters always use the
+      // original mass matrix.
+      FullMatrix<double> rhs_mass_matrix(mass_matrix);
+      FullMatrix<double> rhs_linear_operator(linear_operator);
+      FullMatrix<double> rhs_joint_convection(joint_convection);
+      Vector<double> rhs_mean_contribution(mean_contribution_vector);
+      std::vector<FullMatrix<double>> rhs_nonlinear_operator(nonlinear_operator);
+      if (parameters.pre_invert_mass_matrix)
+        {
+          constexpr double identity_tolerance {1.0e-12};
+          // neither the hyper reduced nonlinearity nor the approximate
+          // deconvolution models can absorb M^{-1}, but they may still skip
+          // the solve if M is the identity.
+          if (parameters.use_hyper_reduction
+              or parameters.filter_model == POD::FilterModel::ADLavrentiev)
+            {
+              if (is_identity(mass_matrix, identity_tolerance))
+                {
+                  rhs_mass_matrix = IdentityMatrix(mass_matrix.m());
+                }
+            }
+          else
+            {
+              fold_inverse_mass_matrix
+              (rhs_mass_matrix, rhs_linear_operator, rhs_joint_convection,
+               rhs_mean_contribution, rhs_nonlinear_operator,
+               identity_tolerance);
+            }
+        }
+
+      AssertThrow(parameters.time_stepping_method
+                  == POD::TimeSteppingMethod::RungeKutta4
+                  or is_imex(parameters.time_stepping_method)
+                  or (parameters.filter_model
+                      != POD::FilterModel::PostDifferentialFilter
+                      and parameters.filter_model
+                      != POD::FilterModel::PostDifferentialFilterRelax
+                      and parameters.filter_model
+                      != POD::FilterModel::PostL2ProjectionFilter),
+                  ExcMessage("The post filter models are only implemented "
+                             "with RungeKutta4 and the IMEX methods."));
+      AssertThrow(!is_implicit(parameters.time_stepping_method)
+                  or parameters.filter_model == POD::FilterModel::Differential
+                  or parameters.filter_model == POD::FilterModel::L2Projection
+                  or parameters.filter_model == POD::FilterModel::LerayHybrid,
+                  ExcMessage("The implicit time stepping methods are only "
+                             "implemented for the 'Differential', "
+                             "'L2Projection' and 'LerayHybrid' models."));
+      AssertThrow(parameters.time_stepping_method
+                  != POD::TimeSteppingMethod::Multirate
+                  or (parameters.filter_model == POD::FilterModel::Differential
+                      and not parameters.use_hyper_reduction
+                      and parameters.multirate_n_slow_modes
+                      <= mean_contribution_vector.size()
+                      and is_identity(rhs_mass_matrix)),
+                  ExcMessage("The multirate integrator is only implemented for "
+                             "the 'Differential' model without hyper reduction "
+                             "and with pre_invert_mass_matrix, and needs at "
+                             "most n_pod_dofs slow modes."));
+      std::unique_ptr<POD::NavierStokes::PlainRHS<double>> plain_rhs_function;
+      if (parameters.use_hyper_reduction)
+        {
+          plain_rhs_function = std::unique_ptr<POD::NavierStokes::PlainRHS<double>>
+            (new POD::NavierStokes::HyperReducedRHS
+             (rhs_linear_operator, rhs_mass_matrix, reduced_quadrature,
+              rhs_mean_contribution));
+        }
+      else if (parameters.time_stepping_method
+               == POD::TimeSteppingMethod::Multirate)
         {
-          outname_tail << "-unfiltered-mean";
+          plain_rhs_function = std::unique_ptr<POD::NavierStokes::PlainRHS<double>>
+            (new POD::NavierStokes::PartitionedPlainRHS
+             (rhs_linear_operator, rhs_mass_matrix, rhs_nonlinear_operator,
+              rhs_mean_contribution, parameters.symmetric_nonlinearity));
         }
-      outname_tail << "-r-" << mean_contribution_vector.size() // n_pod_dofs
-                   << "-Re-" << parameters.reynolds_n
-                   << ".h5";
-      std::unique_ptr<POD::NavierStokes::PlainRHS> plain_rhs_function
-        (new POD::NavierStokes::PlainRHS
-         (linear_operator, mass_matrix, nonlinear_operator,
-          mean_contribution_vector));
-      std::unique_ptr<ODE::RungeKutta4> rk_method {new ODE::RungeKutta4()};
+      else
+        {
+          plain_rhs_function = std::unique_ptr<POD::NavierStokes::PlainRHS<double>>
+            (new POD::NavierStokes::PlainRHS<double>
+             (rhs_linear_operator, rhs_mass_matrix, rhs_nonlinear_operator,
+              rhs_mean_contribution, parameters.symmetric_nonlinearity));
+        }
+      std::unique_ptr<ODE::RungeKuttaBase<double>> rk_method
+      {new ODE::RungeKutta4<double>()};
       if (parameters.filter_model == POD::FilterModel::Differential)
         {
-          outname << "pod-leray-radius-" << parameters.filter_radius;
-          rk_method = std::unique_ptr<ODE::RungeKutta4>
-            (new ODE::RungeKutta4(std::move(plain_rhs_function)));
+          // the reduced quadrature rule is trained on and evaluates the
+          // unfiltered POD vectors, so it cannot stand in for the Leray
+          // filtered convection of compute-pod-matrices.
+          AssertThrow(!parameters.use_hyper_reduction
+                      or parameters.filter_radius == 0.0,
+                      ExcMessage("Hyper reduction is not implemented for the "
+                                 "'Differential' model with a nonzero filter "
+                                 "radius."));
+          if (parameters.use_fixed_size_kernels
+              and not parameters.use_hyper_reduction
+              and not parameters.symmetric_nonlinearity
+              and parameters.time_stepping_method
+              == POD::TimeSteppingMethod::RungeKutta4
+              and has_fixed_size_kernels(mass_matrix.m()))
+            {
+              return std::make_pair
+                (outname, create_fixed_size_runge_kutta_4
+                 (rhs_linear_operator, rhs_mass_matrix, rhs_nonlinear_operator,
+                  rhs_mean_contribution));
+            }
+          if (is_implicit(parameters.time_stepping_method))
+            {
+              rk_method = create_implicit_integrator
+                (std::move(plain_rhs_function), parameters);
+            }
+          else
+            {
+              rk_method = create_runge_kutta(std::move(plain_rhs_function),
+                                             parameters);
+            }
         }
       else if (parameters.filter_model == POD::FilterModel::L2Projection
                or parameters.filter_model == POD::FilterModel::LerayHybrid)
         {
+          AssertThrow(!parameters.use_hyper_reduction,
+                      ExcMessage("Hyper reduction is not implemented for the L2 "
+                                 "projection models."));
           if (parameters.filter_mean
               and parameters.filter_model == POD::FilterModel::L2Projection)
             {
               Assert(false, StandardExceptions::ExcNotImplemented());
             }
-          if (parameters.filter_model == POD::FilterModel::L2Projection)
+          std::unique_ptr<POD::NavierStokes::L2ProjectionFilterRHS> rhs_function
+            (new POD::NavierStokes::L2ProjectionFilterRHS
+             (rhs_linear_operator, rhs_mass_matrix, rhs_joint_convection,
+              rhs_nonlinear_operator, rhs_mean_contribution, parameters.cutoff_n));
+          if (is_implicit(parameters.time_stepping_method))
             {
-              outname << "pod-l2-projection-cutoff-" << parameters.cutoff_n;
+              rk_method = create_implicit_integrator(std::move(rhs_function),
+                                                     parameters);
             }
           else
             {
-              outname << "pod-leray-hybrid-cutoff-" << parameters.cutoff_n
-                      << "-radius-" << parameters.filter_radius;
+              rk_method = create_runge_kutta(std::move(rhs_function),
+                                             parameters);
             }
-          std::unique_ptr<POD::NavierStokes::L2ProjectionFilterRHS> rhs_function
-            (new POD::NavierStokes::L2ProjectionFilterRHS
-             (linear_operator, mass_matrix, joint_convection, nonlinear_operator,
-              mean_contribution_vector, parameters.cutoff_n));
-          rk_method = std::unique_ptr<ODE::RungeKutta4>
-            (new ODE::RungeKutta4(std::move(rhs_function)));
         }
       else if (parameters.filter_model == POD::FilterModel::PostDifferentialFilter)
         {
@@ -67,28 +401,24 @@ namespace POD
             {
               Assert(false, StandardExceptions::ExcNotImplemented());
             }
-          outname << "pod-postfilter-differential-radius-"
-                  << parameters.filter_radius;
-          std::unique_ptr<POD::NavierStokes::PostDifferentialFilter> filter_function
-            (new POD::NavierStokes::PostDifferentialFilter
+          std::unique_ptr<POD::NavierStokes::PostDifferentialFilter<double>> filter_function
+            (new POD::NavierStokes::PostDifferentialFilter<double>
              (mass_matrix, laplace_matrix, boundary_matrix,
               parameters.filter_radius));
-          rk_method = std::unique_ptr<ODE::RungeKutta4PostFilter>
-            (new ODE::RungeKutta4PostFilter
-             (std::move(plain_rhs_function), std::move(filter_function)));
+          rk_method = create_post_filter_runge_kutta
+            (std::move(plain_rhs_function), std::move(filter_function),
+             parameters);
         }
       else if (parameters.filter_model == POD::FilterModel::PostDifferentialFilterRelax)
         {
           Assert(!parameters.filter_mean, StandardExceptions::ExcNotImplemented());
-          outname << "pod-postfilter-differential-radius-"
-                  << parameters.filter_radius;
-          std::unique_ptr<POD::NavierStokes::PostDifferentialFilterRelax> filter_function
-            (new POD::NavierStokes::PostDifferentialFilterRelax
+          std::unique_ptr<POD::NavierStokes::PostDifferentialFilterRelax<double>> filter_function
+            (new POD::NavierStokes::PostDifferentialFilterRelax<double>
              (mass_matrix, laplace_matrix, boundary_matrix,
               parameters.filter_radius, parameters.relaxation_parameter));
-          rk_method = std::unique_ptr<ODE::RungeKutta4PostFilter>
-            (new ODE::RungeKutta4PostFilter
-             (std::move(plain_rhs_function), std::move(filter_function)));
+          rk_method = create_post_filter_runge_kutta
+            (std::move(plain_rhs_function), std::move(filter_function),
+             parameters);
         }
       else if (parameters.filter_model == POD::FilterModel::PostL2ProjectionFilter)
         {
@@ -96,44 +426,40 @@ namespace POD
             {
               StandardExceptions::ExcNotImplemented();
             }
-          outname << "pod-postfilter-cutoff-n-" << parameters.cutoff_n;
-          std::unique_ptr<POD::NavierStokes::PostL2ProjectionFilter> filter_function
-            (new POD::NavierStokes::PostL2ProjectionFilter
+          std::unique_ptr<POD::NavierStokes::PostL2ProjectionFilter<double>> filter_function
+            (new POD::NavierStokes::PostL2ProjectionFilter<double>
              (parameters.cutoff_n));
-          rk_method = std::unique_ptr<ODE::RungeKutta4PostFilter>
-            (new ODE::RungeKutta4PostFilter
-             (std::move(plain_rhs_function), std::move(filter_function)));
+          rk_method = create_post_filter_runge_kutta
+            (std::move(plain_rhs_function), std::move(filter_function),
+             parameters);
         }
       else if (parameters.filter_model == POD::FilterModel::ADLavrentiev)
         {
+          AssertThrow(!parameters.use_hyper_reduction,
+                      ExcMessage("Hyper reduction is not implemented for the "
+                                 "approximate deconvolution models."));
           if (!parameters.filter_mean)
             {
               StandardExceptions::ExcNotImplemented();
             }
-          outname << "pod-ad-lavrentiev-" << parameters.lavrentiev_parameter
-                  << "-filter-radius-" << parameters.filter_radius
-                  << "-noise-multiplier-" << parameters.noise_multiplier;
-
           std::unique_ptr<POD::NavierStokes::AD::FilterBase> ad_filter
             (new POD::NavierStokes::AD::LavrentievFilter
              (mass_matrix, laplace_matrix, boundary_matrix,
               parameters.filter_radius, parameters.noise_multiplier,
-              parameters.lavrentiev_parameter));
+              parameters.lavrentiev_parameter, parameters.noise_stream));
           std::unique_ptr<POD::NavierStokes::AD::FilterRHS> rhs_function
             (new POD::NavierStokes::AD::FilterRHS
-             (mass_matrix, boundary_matrix, laplace_matrix, joint_convection,
+             (rhs_mass_matrix, boundary_matrix, laplace_matrix, joint_convection,
               nonlinear_operator, mean_contribution_vector,
-              parameters.reynolds_n, std::move(ad_filter)));
-          rk_method = std::unique_ptr<ODE::RungeKutta4>
-            (new ODE::RungeKutta4(std::move(rhs_function)));
+              parameters.reynolds_n, std::move(ad_filter),
+              parameters.symmetric_nonlinearity));
+          rk_method = create_runge_kutta(std::move(rhs_function), parameters);
         }
       else
         {
           StandardExceptions::ExcNotImplemented();
         }
-      outname << outname_tail.str();
-
-      return std::make_pair(outname.str(), std::move(rk_method));
+      return std::make_pair(outname, std::move(rk_method));
     }
   }
 }
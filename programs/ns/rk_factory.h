@@ -18,14 +18,19 @@
 #ifndef dealii__rom_rk_factory_h
 #define dealii__rom_rk_factory_h
 #include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/identity_matrix.h>
 #include <deal.II/lac/vector.h>
 
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <deal.II-pod/ode/ode.h>
+#include <deal.II-pod/ns/fixed_size.h>
+#include <deal.II-pod/ns/hyper_reduction.h>
 #include <deal.II-pod/ns/ns.h>
 
 #include "parameters.h"
@@ -35,7 +40,17 @@ namespace POD
   namespace NavierStokes
   {
     using namespace dealii;
-    std::pair<std::string, std::unique_ptr<ODE::RungeKuttaBase>> rk_factory
+    /*
+     * The name of the file that the ROM described by parameters (with
+     * n_pod_dofs POD vectors) writes its solution to. This only depends on
+     * the parameters, so it may be computed without building the time
+     * integrator.
+     */
+    std::string get_output_name(const POD::NavierStokes::Parameters &parameters,
+                                const unsigned int n_pod_dofs);
+
+
+    std::pair<std::string, std::unique_ptr<ODE::RungeKuttaBase<double>>> rk_factory
     (const FullMatrix<double>              &boundary_matrix,
      const FullMatrix<double>              &joint_convection,
      const FullMatrix<double>              &laplace_matrix,
@@ -43,6 +58,7 @@ namespace POD
      const Vector<double>                  &mean_contribution_vector,
      const FullMatrix<double>              &mass_matrix,
      const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const ReducedQuadrature               &reduced_quadrature,
      const POD::NavierStokes::Parameters   &parameters);
   }
 }
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 
 #include <cstdio>
 #include <glob.h>
@@ -106,6 +107,33 @@ namespace POD
     }
 
 
+
+    Vector<double> relative_drift(const FullMatrix<double> &solutions,
+                                  const FullMatrix<double> &reference)
+    {
+      Assert(solutions.m() == reference.m(),
+             ExcDimensionMismatch(solutions.m(), reference.m()));
+      Assert(solutions.n() == reference.n(),
+             ExcDimensionMismatch(solutions.n(), reference.n()));
+      Vector<double> drift(solutions.m());
+      for (unsigned int i = 0; i < solutions.m(); ++i)
+        {
+          double difference = 0.0;
+          double norm = 0.0;
+          for (unsigned int j = 0; j < solutions.n(); ++j)
+            {
+              const double value = reference(i, j);
+              difference += (solutions(i, j) - value)*(solutions(i, j) - value);
+              norm += value*value;
+            }
+          drift[i] = norm == 0.0 ? std::sqrt(difference)
+                     : std::sqrt(difference/norm);
+        }
+
+      return drift;
+    }
+
+
     TemporaryFileName::TemporaryFileName()
     {
       std::array<char, 20> character_template;
@@ -0,0 +1,175 @@
+/* ---------------------------------------------------------------------
+ * Copyright (C) 2015 David Wells
+ *
+ * This file is NOT part of the deal.II library.
+ *
+ * This file is free software; you can use it, redistribute it, and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ * The full text of the license can be found in the file LICENSE at
+ * the top level of the deal.II distribution.
+ *
+ * ---------------------------------------------------------------------
+ * Author: David Wells, Rensselaer Polytechnic Institute, 2015
+ */
+#include <algorithm>
+#include <vector>
+
+#include <deal.II-pod/extra/nnls.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace extra
+  {
+    namespace
+    {
+      /*
+       * Solve the unconstrained least squares problem restricted to the
+       * columns in passive_set.
+       */
+      Vector<double> solve_passive_least_squares
+      (const FullMatrix<double>        &matrix,
+       const Vector<double>            &rhs,
+       const std::vector<unsigned int> &passive_set)
+      {
+        FullMatrix<double> passive_matrix(matrix.m(), passive_set.size());
+        for (unsigned int row = 0; row < matrix.m(); ++row)
+          {
+            for (unsigned int k = 0; k < passive_set.size(); ++k)
+              {
+                passive_matrix(row, k) = matrix(row, passive_set[k]);
+              }
+          }
+
+        Vector<double> passive_solution(passive_set.size());
+        Vector<double> passive_rhs(rhs);
+        passive_matrix.least_squares(passive_solution, passive_rhs);
+        return passive_solution;
+      }
+    }
+
+
+    void nonnegative_least_squares(const FullMatrix<double> &matrix,
+                                   const Vector<double>     &rhs,
+                                   const double              tolerance,
+                                   const unsigned int        max_n_nonzeros,
+                                   Vector<double>           &solution)
+    {
+      const unsigned int n_rows = matrix.m();
+      const unsigned int n_columns = matrix.n();
+      Assert(rhs.size() == n_rows, ExcDimensionMismatch(rhs.size(), n_rows));
+      solution.reinit(n_columns);
+
+      // the least squares problem on the passive set must not be
+      // underdetermined.
+      const unsigned int max_passive_set_size = std::min(max_n_nonzeros, n_rows);
+      // Each pass of the outer loop adds a column: only removals in the inner
+      // loop can make the method cycle, so bound the total work.
+      const unsigned int max_n_iterations = 3*n_columns;
+
+      std::vector<bool> is_passive(n_columns, false);
+      std::vector<unsigned int> passive_set;
+      Vector<double> residual(rhs);
+      Vector<double> dual(n_columns);
+      const double target_residual_norm = tolerance*rhs.l2_norm();
+
+      unsigned int iteration_n = 0;
+      while (residual.l2_norm() > target_residual_norm
+             && passive_set.size() < max_passive_set_size
+             && iteration_n < max_n_iterations)
+        {
+          ++iteration_n;
+          matrix.Tvmult(dual, residual);
+          unsigned int new_column = numbers::invalid_unsigned_int;
+          double max_dual = 0.0;
+          for (unsigned int column = 0; column < n_columns; ++column)
+            {
+              if (!is_passive[column] && dual[column] > max_dual)
+                {
+                  max_dual = dual[column];
+                  new_column = column;
+                }
+            }
+          // the KKT conditions are satisfied, so the solution is optimal.
+          if (new_column == numbers::invalid_unsigned_int)
+            {
+              break;
+            }
+          is_passive[new_column] = true;
+          passive_set.push_back(new_column);
+
+          while (!passive_set.empty())
+            {
+              const Vector<double> passive_solution
+                = solve_passive_least_squares(matrix, rhs, passive_set);
+
+              bool is_feasible = true;
+              for (unsigned int k = 0; k < passive_set.size(); ++k)
+                {
+                  if (passive_solution[k] <= 0.0)
+                    {
+                      is_feasible = false;
+                      break;
+                    }
+                }
+              if (is_feasible)
+                {
+                  for (unsigned int k = 0; k < passive_set.size(); ++k)
+                    {
+                      solution[passive_set[k]] = passive_solution[k];
+                    }
+                  break;
+                }
+
+              // Move towards the unconstrained solution until the first
+              // coefficient hits zero and then drop it from the passive set.
+              // A coefficient that is zero and stays zero (e.g., the one just
+              // added) allows no step at all.
+              double step_length = 1.0;
+              bool has_limiting_k = false;
+              unsigned int limiting_k = 0;
+              for (unsigned int k = 0; k < passive_set.size(); ++k)
+                {
+                  if (passive_solution[k] <= 0.0)
+                    {
+                      const double current = solution[passive_set[k]];
+                      const double denominator = current - passive_solution[k];
+                      const double candidate
+                        = denominator == 0.0 ? 0.0 : current/denominator;
+                      if (candidate < step_length)
+                        {
+                          step_length = candidate;
+                          has_limiting_k = true;
+                          limiting_k = k;
+                        }
+                    }
+                }
+
+              std::vector<unsigned int> new_passive_set;
+              for (unsigned int k = 0; k < passive_set.size(); ++k)
+                {
+                  const unsigned int column = passive_set[k];
+                  solution[column] += step_length*(passive_solution[k] - solution[column]);
+                  if ((has_limiting_k && k == limiting_k)
+                      || solution[column] <= 0.0)
+                    {
+                      solution[column] = 0.0;
+                      is_passive[column] = false;
+                    }
+                  else
+                    {
+                      new_passive_set.push_back(column);
+                    }
+                }
+              passive_set = std::move(new_passive_set);
+            }
+
+          matrix.vmult(residual, solution);
+          residual.sadd(-1.0, 1.0, rhs);
+        }
+    }
+  }
+}
@@ -0,0 +1,40 @@
+#include <deal.II-pod/extra/philox.h>
+
+namespace POD
+{
+  namespace extra
+  {
+    namespace
+    {
+      constexpr std::uint32_t philox_m0 {0xD2511F53u};
+      constexpr std::uint32_t philox_m1 {0xCD9E8D57u};
+      constexpr std::uint32_t philox_w0 {0x9E3779B9u};
+      constexpr std::uint32_t philox_w1 {0xBB67AE85u};
+      constexpr unsigned int philox_n_rounds {10};
+    }
+
+
+    PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key)
+    {
+      for (unsigned int round_n = 0; round_n < philox_n_rounds; ++round_n)
+        {
+          const std::uint64_t product_0
+            = std::uint64_t(philox_m0)*std::uint64_t(counter[0]);
+          const std::uint64_t product_1
+            = std::uint64_t(philox_m1)*std::uint64_t(counter[2]);
+          const std::uint32_t high_0 = product_0 >> 32;
+          const std::uint32_t low_0 = product_0;
+          const std::uint32_t high_1 = product_1 >> 32;
+          const std::uint32_t low_1 = product_1;
+
+          counter = {{high_1 ^ counter[1] ^ key[0], low_1,
+                      high_0 ^ counter[3] ^ key[1], low_0
+                     }
+                    };
+          key[0] += philox_w0;
+          key[1] += philox_w1;
+        }
+      return counter;
+    }
+  }
+}
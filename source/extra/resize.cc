@@ -15,6 +15,8 @@
  */
 #include <deal.II-pod/extra/resize.h>
 
+#include <algorithm>
+
 namespace POD
 {
   using namespace dealii;
@@ -32,9 +34,10 @@ namespace POD
       matrix.reinit(empty_table);
       TableIndices<2> indices(new_size, new_size);
       matrix.reinit(indices);
-      for (unsigned int i = 0; i < new_size; ++i)
+      const unsigned int n_kept = std::min<unsigned int>(temp.m(), new_size);
+      for (unsigned int i = 0; i < n_kept; ++i)
         {
-          for (unsigned int j = 0; j < new_size; ++j)
+          for (unsigned int j = 0; j < n_kept; ++j)
             {
               matrix(i, j) = temp(i, j);
             }
@@ -50,7 +53,8 @@ namespace POD
       // free all memory, then reallocate
       vector.reinit(0);
       vector.reinit(new_size);
-      for (unsigned int i = 0; i < new_size; ++i)
+      const unsigned int n_kept = std::min<unsigned int>(temp.size(), new_size);
+      for (unsigned int i = 0; i < n_kept; ++i)
         {
           vector[i] = temp[i];
         }
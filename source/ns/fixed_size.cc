@@ -0,0 +1,50 @@
+#include <deal.II-pod/ns/fixed_size.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    bool has_fixed_size_kernels(const unsigned int n_pod_dofs)
+    {
+      switch (n_pod_dofs)
+        {
+#define POD_NS_FIXED_SIZE_CASE(n) case n:
+          POD_NS_FIXED_SIZES(POD_NS_FIXED_SIZE_CASE)
+#undef POD_NS_FIXED_SIZE_CASE
+          return true;
+        default:
+          return false;
+        }
+    }
+
+
+    std::unique_ptr<ODE::RungeKuttaBase<double>> create_fixed_size_runge_kutta_4
+    (const FullMatrix<double>              &linear_operator,
+     const FullMatrix<double>              &mass_matrix,
+     const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const Vector<double>                  &mean_contribution)
+    {
+      switch (mass_matrix.m())
+        {
+#define POD_NS_FIXED_SIZE_CASE(n)                                       \
+          case n:                                                       \
+          {                                                             \
+            std::unique_ptr<PlainRHSFixed<n>> rhs_function              \
+              (new PlainRHSFixed<n>(linear_operator, mass_matrix,       \
+                                    nonlinear_operator, mean_contribution)); \
+            return std::unique_ptr<ODE::RungeKuttaBase<double>>         \
+              (new RungeKutta4Fixed<n>(std::move(rhs_function)));       \
+          }
+          POD_NS_FIXED_SIZES(POD_NS_FIXED_SIZE_CASE)
+#undef POD_NS_FIXED_SIZE_CASE
+        default:
+          AssertThrow(false,
+                      ExcMessage("There are no fixed-size kernels for this "
+                                 "number of POD vectors."));
+        }
+      return std::unique_ptr<ODE::RungeKuttaBase<double>>();
+    }
+  }
+}
@@ -0,0 +1,206 @@
+#include <deal.II-pod/h5/h5.h>
+#include <deal.II-pod/ns/hyper_reduction.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    ReducedQuadrature::ReducedQuadrature()
+    {}
+
+
+    ReducedQuadrature::ReducedQuadrature(const unsigned int dim,
+                                         const unsigned int n_pod_dofs,
+                                         const unsigned int n_points) :
+      values(n_points*dim, n_pod_dofs),
+      gradients(n_points*dim*dim, n_pod_dofs),
+      weights(n_points)
+    {}
+
+
+    unsigned int ReducedQuadrature::dimension() const
+    {
+      if (values.m() == 0)
+        {
+          return 0;
+        }
+      return gradients.m()/values.m();
+    }
+
+
+    unsigned int ReducedQuadrature::n_points() const
+    {
+      return weights.size();
+    }
+
+
+    unsigned int ReducedQuadrature::n_pod_dofs() const
+    {
+      return values.n();
+    }
+
+
+    void ReducedQuadrature::truncate(const unsigned int n_pod_dofs)
+    {
+      Assert(n_pod_dofs <= values.n(), ExcIndexRange(n_pod_dofs, 0, values.n() + 1));
+      FullMatrix<double> new_values(values.m(), n_pod_dofs);
+      FullMatrix<double> new_gradients(gradients.m(), n_pod_dofs);
+      for (unsigned int row = 0; row < values.m(); ++row)
+        {
+          for (unsigned int column = 0; column < n_pod_dofs; ++column)
+            {
+              new_values(row, column) = values(row, column);
+            }
+        }
+      for (unsigned int row = 0; row < gradients.m(); ++row)
+        {
+          for (unsigned int column = 0; column < n_pod_dofs; ++column)
+            {
+              new_gradients(row, column) = gradients(row, column);
+            }
+        }
+      values.swap(new_values);
+      gradients.swap(new_gradients);
+    }
+
+
+    void ReducedQuadrature::load(const std::string &file_name_base)
+    {
+      H5::load_full_matrix(file_name_base + "-values.h5", values);
+      H5::load_full_matrix(file_name_base + "-gradients.h5", gradients);
+      H5::load_vector(file_name_base + "-weights.h5", weights);
+    }
+
+
+    void ReducedQuadrature::save(const std::string &file_name_base) const
+    {
+      H5::save_full_matrix(file_name_base + "-values.h5", values);
+      H5::save_full_matrix(file_name_base + "-gradients.h5", gradients);
+      H5::save_vector(file_name_base + "-weights.h5", weights);
+    }
+
+
+    HyperReducedRHS::HyperReducedRHS
+    (const FullMatrix<double> linear_operator,
+     const FullMatrix<double> mass_matrix,
+     const ReducedQuadrature  reduced_quadrature,
+     const Vector<double>     mean_contribution) :
+      PlainRHS<double>(linear_operator, mass_matrix,
+                       std::vector<FullMatrix<double>>(), mean_contribution),
+      reduced_quadrature {reduced_quadrature},
+      point_values(reduced_quadrature.values.m()),
+      point_gradients(reduced_quadrature.gradients.m()),
+      point_convection(reduced_quadrature.values.m())
+    {
+      Assert(reduced_quadrature.n_pod_dofs() == n_pod_dofs,
+             ExcDimensionMismatch(reduced_quadrature.n_pod_dofs(), n_pod_dofs));
+    }
+
+
+    void HyperReducedRHS::apply(Vector<double> &dst, const Vector<double> &src)
+    {
+      linear_operator.vmult(dst, src);
+      dst += mean_contribution;
+      subtract_convection(dst, src);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
+        }
+    }
+
+
+    void HyperReducedRHS::apply_nonlinear_part(Vector<double> &dst,
+                                               const Vector<double> &src)
+    {
+      dst = mean_contribution;
+      subtract_convection(dst, src);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
+        }
+    }
+
+
+    void HyperReducedRHS::subtract_convection(Vector<double> &dst,
+                                              const Vector<double> &src)
+    {
+      // evaluate u and grad u at the sampled points...
+      reduced_quadrature.values.vmult(point_values, src);
+      reduced_quadrature.gradients.vmult(point_gradients, src);
+
+      // ...form the weighted convective term (u . grad) u at each point...
+      const unsigned int dim = reduced_quadrature.dimension();
+      for (unsigned int point_n = 0; point_n < reduced_quadrature.n_points();
+           ++point_n)
+        {
+          for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+            {
+              double value = 0.0;
+              for (unsigned int derivative_n = 0; derivative_n < dim; ++derivative_n)
+                {
+                  value += point_values[point_n*dim + derivative_n]
+                           *point_gradients[(point_n*dim + dim_n)*dim + derivative_n];
+                }
+              point_convection[point_n*dim + dim_n]
+                = reduced_quadrature.weights[point_n]*value;
+            }
+        }
+
+      // ...and test it against each POD vector.
+      reduced_quadrature.values.Tvmult(temp, point_convection);
+      dst -= temp;
+    }
+
+
+    void HyperReducedRHS::compute_jacobian
+    (FullMatrix<double> &jacobian, const Vector<double> &src)
+    {
+      reduced_quadrature.values.vmult(point_values, src);
+      reduced_quadrature.gradients.vmult(point_gradients, src);
+
+      // the derivative of the weighted convective term at each point in the
+      // direction of POD vector k is w ((phi_k . grad) u + (u . grad) phi_k)...
+      const unsigned int dim = reduced_quadrature.dimension();
+      FullMatrix<double> point_jacobian(reduced_quadrature.values.m(),
+                                        n_pod_dofs);
+      for (unsigned int point_n = 0; point_n < reduced_quadrature.n_points();
+           ++point_n)
+        {
+          for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+            {
+              const unsigned int row_n = point_n*dim + dim_n;
+              for (unsigned int pod_vector_n = 0; pod_vector_n < n_pod_dofs;
+                   ++pod_vector_n)
+                {
+                  double value = 0.0;
+                  for (unsigned int derivative_n = 0; derivative_n < dim;
+                       ++derivative_n)
+                    {
+                      const unsigned int gradient_n = row_n*dim + derivative_n;
+                      value += reduced_quadrature.values
+                               (point_n*dim + derivative_n, pod_vector_n)
+                               *point_gradients[gradient_n]
+                               + point_values[point_n*dim + derivative_n]
+                               *reduced_quadrature.gradients
+                               (gradient_n, pod_vector_n);
+                    }
+                  point_jacobian(row_n, pod_vector_n)
+                    = reduced_quadrature.weights[point_n]*value;
+                }
+            }
+        }
+
+      // ...and, as in subtract_convection, it is tested against each POD
+      // vector.
+      jacobian = linear_operator;
+      FullMatrix<double> convection_jacobian(n_pod_dofs);
+      reduced_quadrature.values.Tmmult(convection_jacobian, point_jacobian);
+      jacobian.add(-1.0, convection_jacobian);
+      apply_inverse_mass_matrix(jacobian);
+    }
+  }
+}
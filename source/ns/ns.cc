@@ -1,3 +1,8 @@
+#include <deal.II/lac/identity_matrix.h>
+
+#include <cmath>
+
+#include <deal.II-pod/extra/philox.h>
 #include <deal.II-pod/ns/ns.h>
 
 namespace POD
@@ -6,38 +11,335 @@ namespace POD
 
   namespace NavierStokes
   {
-    PlainRHS::PlainRHS() :
-      n_pod_dofs {numbers::invalid_unsigned_int}
+    bool is_identity(const FullMatrix<double> &matrix,
+                     const double              tolerance)
+    {
+      if (matrix.m() != matrix.n())
+        {
+          return false;
+        }
+      for (unsigned int i = 0; i < matrix.m(); ++i)
+        {
+          for (unsigned int j = 0; j < matrix.n(); ++j)
+            {
+              if (std::abs(matrix(i, j) - (i == j ? 1.0 : 0.0)) > tolerance)
+                {
+                  return false;
+                }
+            }
+        }
+      return true;
+    }
+
+
+    void fold_inverse_mass_matrix
+    (FullMatrix<double>              &mass_matrix,
+     FullMatrix<double>              &linear_operator,
+     FullMatrix<double>              &joint_convection,
+     Vector<double>                  &mean_contribution,
+     std::vector<FullMatrix<double>> &nonlinear_operator,
+     const double                     tolerance)
+    {
+      const unsigned int n_pod_dofs = mass_matrix.m();
+      Assert(nonlinear_operator.size() == n_pod_dofs,
+             ExcDimensionMismatch(nonlinear_operator.size(), n_pod_dofs));
+      if (!is_identity(mass_matrix, tolerance))
+        {
+          FullMatrix<double> inverse_mass_matrix(n_pod_dofs);
+          inverse_mass_matrix.invert(mass_matrix);
+
+          FullMatrix<double> temp_matrix(n_pod_dofs);
+          inverse_mass_matrix.mmult(temp_matrix, linear_operator);
+          linear_operator.swap(temp_matrix);
+          inverse_mass_matrix.mmult(temp_matrix, joint_convection);
+          joint_convection.swap(temp_matrix);
+
+          Vector<double> temp_vector(n_pod_dofs);
+          inverse_mass_matrix.vmult(temp_vector, mean_contribution);
+          mean_contribution.swap(temp_vector);
+
+          // the slices are rows of the tensor, so each new slice is a linear
+          // combination of the old ones.
+          std::vector<FullMatrix<double>> folded_nonlinear_operator
+            (n_pod_dofs, FullMatrix<double>(n_pod_dofs));
+          for (unsigned int i = 0; i < n_pod_dofs; ++i)
+            {
+              for (unsigned int l = 0; l < n_pod_dofs; ++l)
+                {
+                  folded_nonlinear_operator[i].add(inverse_mass_matrix(i, l),
+                                                   nonlinear_operator[l]);
+                }
+            }
+          nonlinear_operator.swap(folded_nonlinear_operator);
+        }
+
+      mass_matrix = IdentityMatrix(n_pod_dofs);
+    }
+
+
+    namespace
+    {
+      // Round the entries of a double precision matrix to type Number.
+      template<typename Number>
+      FullMatrix<Number> convert_matrix(const FullMatrix<double> &matrix)
+      {
+        FullMatrix<Number> result(matrix.m(), matrix.n());
+        result = matrix;
+        return result;
+      }
+
+
+      // dst += matrix*src, where each sum is done with the type of dst.
+      template<typename Number, typename AccumulationNumber>
+      void vmult_add_accumulate(Vector<AccumulationNumber> &dst,
+                                const FullMatrix<Number>   &matrix,
+                                const Vector<Number>       &src)
+      {
+        for (unsigned int i = 0; i < matrix.m(); ++i)
+          {
+            AccumulationNumber value = 0.0;
+            for (unsigned int j = 0; j < matrix.n(); ++j)
+              {
+                value += AccumulationNumber(matrix(i, j))*src[j];
+              }
+            dst[i] += value;
+          }
+      }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    PlainRHS<Number, AccumulationNumber>::PlainRHS() :
+      n_pod_dofs {numbers::invalid_unsigned_int},
+      identity_mass_matrix {false}
     {}
 
 
-    PlainRHS::PlainRHS(const FullMatrix<double> linear_operator,
-                       const FullMatrix<double> mass_matrix,
-                       const std::vector<FullMatrix<double>> nonlinear_operator,
-                       const Vector<double> mean_contribution) :
-      linear_operator {linear_operator},
-      nonlinear_operator {nonlinear_operator},
-      mean_contribution {mean_contribution},
+    template<typename Number, typename AccumulationNumber>
+    PlainRHS<Number, AccumulationNumber>::PlainRHS
+    (const FullMatrix<double> linear_operator,
+     const FullMatrix<double> mass_matrix,
+     const std::vector<FullMatrix<double>> nonlinear_operator,
+     const Vector<double> mean_contribution,
+     const bool symmetric_nonlinearity) :
+      linear_operator (convert_matrix<Number>(linear_operator)),
+      nonlinear_operator
+      (nonlinear_operator,
+       symmetric_nonlinearity
+       ? QuadraticOperator<Number, AccumulationNumber>::Storage::symmetric
+       : QuadraticOperator<Number, AccumulationNumber>::Storage::full),
+      mean_contribution (mean_contribution),
       n_pod_dofs {mass_matrix.m()},
+      identity_mass_matrix {is_identity(mass_matrix)},
       temp(n_pod_dofs)
     {
       factorized_mass_matrix.reinit(mass_matrix.m());
       factorized_mass_matrix = mass_matrix;
       factorized_mass_matrix.compute_lu_factorization();
+
+      linear_part = linear_operator;
+      apply_inverse_mass_matrix(linear_part);
     }
 
-    void PlainRHS::apply(Vector<double> &dst, const Vector<double> &src)
+
+    template<typename Number, typename AccumulationNumber>
+    void PlainRHS<Number, AccumulationNumber>::apply(Vector<Number> &dst,
+                                                     const Vector<Number> &src)
     {
-      linear_operator.vmult(dst, src);
-      dst += mean_contribution;
+      temp = mean_contribution;
+      vmult_add_accumulate(temp, linear_operator, src);
+      nonlinear_operator.vmult_add(temp, src, -1.0);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(temp, false);
+        }
+      dst = temp;
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void PlainRHS<Number, AccumulationNumber>::compute_jacobian
+    (FullMatrix<Number> &jacobian, const Vector<Number> &src)
+    {
+      jacobian = linear_operator;
+      nonlinear_operator.jacobian_add(jacobian, src, -1.0);
+      apply_inverse_mass_matrix(jacobian);
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    const FullMatrix<Number> &
+    PlainRHS<Number, AccumulationNumber>::get_linear_part() const
+    {
+      return linear_part;
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void PlainRHS<Number, AccumulationNumber>::apply_nonlinear_part
+    (Vector<Number> &dst, const Vector<Number> &src)
+    {
+      temp = mean_contribution;
+      nonlinear_operator.vmult_add(temp, src, -1.0);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(temp, false);
+        }
+      dst = temp;
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void PlainRHS<Number, AccumulationNumber>::apply_inverse_mass_matrix
+    (FullMatrix<Number> &matrix)
+    {
+      if (identity_mass_matrix)
+        {
+          return;
+        }
+      // solve one column at a time
+      for (unsigned int j = 0; j < matrix.n(); ++j)
+        {
+          for (unsigned int i = 0; i < n_pod_dofs; ++i)
+            {
+              temp[i] = matrix(i, j);
+            }
+          factorized_mass_matrix.apply_lu_factorization(temp, false);
+          for (unsigned int i = 0; i < n_pod_dofs; ++i)
+            {
+              matrix(i, j) = temp[i];
+            }
+        }
+    }
+
+
+    PartitionedPlainRHS::PartitionedPlainRHS
+    (const FullMatrix<double> linear_operator,
+     const FullMatrix<double> mass_matrix,
+     const std::vector<FullMatrix<double>> nonlinear_operator,
+     const Vector<double> mean_contribution,
+     const bool symmetric_nonlinearity) :
+      PlainRHS(linear_operator, mass_matrix, nonlinear_operator,
+               mean_contribution, symmetric_nonlinearity),
+      n_slow_dofs {0}
+    {
+      AssertThrow(identity_mass_matrix,
+                  ExcMessage("The partitioned right hand side is only "
+                             "implemented for an identity mass matrix."));
+    }
+
+
+    void PartitionedPlainRHS::freeze_slow_part
+    (const Vector<double> &src, const unsigned int n_slow)
+    {
+      AssertIndexRange(n_slow, n_pod_dofs + 1);
+      n_slow_dofs = n_slow;
+
+      // the slow coefficients, padded with zeros
+      slow_part.reinit(n_pod_dofs);
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          slow_part[i] = src[i];
+        }
+
+      // mean + L s - N(s, s) and L - (derivative of N(u, u) at s): the
+      // derivative holds the cross terms s^T N_i f + f^T N_i s.
+      fast_forcing = mean_contribution;
+      vmult_add_accumulate(fast_forcing, linear_operator, slow_part);
+      nonlinear_operator.vmult_add(fast_forcing, slow_part, -1.0);
+      fast_linear_operator = linear_operator;
+      nonlinear_operator.jacobian_add(fast_linear_operator, slow_part, -1.0);
+    }
+
+
+    void PartitionedPlainRHS::apply_fast_part
+    (Vector<double> &dst, const Vector<double> &src)
+    {
+      for (unsigned int i = n_slow_dofs; i < n_pod_dofs; ++i)
+        {
+          double value = fast_forcing[i];
+          for (unsigned int j = n_slow_dofs; j < n_pod_dofs; ++j)
+            {
+              value += fast_linear_operator(i, j)*src[j];
+            }
+          temp[i] = value;
+        }
+      nonlinear_operator.vmult_add_trailing(temp, src, n_slow_dofs, -1.0);
+      for (unsigned int i = n_slow_dofs; i < n_pod_dofs; ++i)
+        {
+          dst[i] = temp[i];
+        }
+    }
+
+
+    EnsemblePlainRHS::EnsemblePlainRHS
+    (const FullMatrix<double> linear_operator,
+     const FullMatrix<double> mass_matrix,
+     const std::vector<FullMatrix<double>> nonlinear_operator,
+     const Vector<double> mean_contribution) :
+      linear_operator {linear_operator},
+      identity_mass_matrix {is_identity(mass_matrix)},
+      mean_contribution {mean_contribution},
+      n_pod_dofs {mass_matrix.m()}
+    {
+      AssertThrow(nonlinear_operator.size() == n_pod_dofs,
+                  ExcDimensionMismatch(nonlinear_operator.size(), n_pod_dofs));
+      if (!identity_mass_matrix)
+        {
+          inverse_mass_matrix.reinit(n_pod_dofs, n_pod_dofs);
+          inverse_mass_matrix.invert(mass_matrix);
+        }
+
+      flat_nonlinear_operator.reinit(n_pod_dofs*n_pod_dofs, n_pod_dofs);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          flat_nonlinear_operator.fill(nonlinear_operator[i], i*n_pod_dofs, 0);
+        }
+    }
+
+
+    void EnsemblePlainRHS::apply(FullMatrix<double> &dst,
+                                 const FullMatrix<double> &src)
+    {
+      Assert(src.m() == n_pod_dofs, ExcDimensionMismatch(src.m(), n_pod_dofs));
+      const unsigned int n_members = src.n();
+      if (dst.m() != n_pod_dofs or dst.n() != n_members)
+        {
+          dst.reinit(n_pod_dofs, n_members);
+        }
+      if (nonlinear_products.n() != n_members)
+        {
+          nonlinear_products.reinit(n_pod_dofs*n_pod_dofs, n_members);
+          temp.reinit(n_pod_dofs, n_members);
+        }
 
-      for (unsigned int pod_vector_n = 0; pod_vector_n < n_pod_dofs; ++pod_vector_n)
+      linear_operator.mmult(dst, src);
+      flat_nonlinear_operator.mmult(nonlinear_products, src);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
         {
-          nonlinear_operator[pod_vector_n].vmult(temp, src);
-          dst(pod_vector_n) -= temp * src;
+          double *const dst_row = &dst(i, 0);
+          for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+            {
+              dst_row[member_n] += mean_contribution[i];
+            }
+          for (unsigned int j = 0; j < n_pod_dofs; ++j)
+            {
+              const double *const products = &nonlinear_products(i*n_pod_dofs + j, 0);
+              const double *const src_row = &src(j, 0);
+              for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+                {
+                  dst_row[member_n] -= src_row[member_n]*products[member_n];
+                }
+            }
         }
 
-      factorized_mass_matrix.apply_lu_factorization(dst, false);
+      if (!identity_mass_matrix)
+        {
+          temp = dst;
+          inverse_mass_matrix.mmult(dst, temp);
+        }
     }
 
 
@@ -60,6 +362,25 @@ namespace POD
       factorized_filter_matrix.reinit(mass_matrix.m());
       factorized_filter_matrix.copy_from(filter_matrix);
       factorized_filter_matrix.compute_lu_factorization();
+
+      // apply the filter to one column of M at a time
+      filter_operator = mass_matrix;
+      Vector<double> column(mass_matrix.m());
+      for (unsigned int j = 0; j < mass_matrix.n(); ++j)
+        {
+          for (unsigned int i = 0; i < mass_matrix.m(); ++i)
+            {
+              column[i] = mass_matrix(i, j);
+            }
+          factorized_filter_matrix.apply_lu_factorization(column, false);
+          for (unsigned int i = 0; i < mass_matrix.m(); ++i)
+            {
+              filter_operator(i, j) = column[i];
+            }
+        }
+
+      // workspace[0] is the filtered solution
+      workspace.reserve(1, mass_matrix.m());
     }
 
 
@@ -70,25 +391,73 @@ namespace POD
        const FullMatrix<double> laplace_matrix,
        const FullMatrix<double> boundary_matrix,
        const double filter_radius,
-       const double noise_multiplier) :
+       const double noise_multiplier,
+       const unsigned int noise_stream,
+       const unsigned int noise_substream) :
         mass_matrix {mass_matrix},
         laplace_matrix {laplace_matrix},
         boundary_matrix {boundary_matrix},
         filter_radius {filter_radius},
         noise_multiplier {noise_multiplier},
-        distribution(0.0, 1.0)
+        noise_stream {noise_stream},
+        noise_substream {noise_substream},
+        n_noise_evaluations {0}
       {
         filter_matrix = mass_matrix;
         filter_matrix.add(filter_radius*filter_radius, laplace_matrix);
         filter_matrix.add(-1.0*filter_radius*filter_radius, boundary_matrix);
 
-        factorized_mass_matrix.reinit(mass_matrix.m());
-        factorized_mass_matrix.copy_from(mass_matrix);
-        factorized_mass_matrix.compute_lu_factorization();
+        filter_operator.reinit(mass_matrix.m(), mass_matrix.m());
+        filter_operator.invert(filter_matrix);
+      }
+
 
-        factorized_filter_matrix.reinit(mass_matrix.m());
-        factorized_filter_matrix.copy_from(filter_matrix);
-        factorized_filter_matrix.compute_lu_factorization();
+      const FullMatrix<double> &FilterBase::get_filter_operator() const
+      {
+        return filter_operator;
+      }
+
+
+      void FilterBase::save_state(Vector<double> &state) const
+      {
+        // the counter is exact in double precision up to 2^53 evaluations.
+        state.reinit(1);
+        state[0] = n_noise_evaluations;
+      }
+
+
+      void FilterBase::load_state(const Vector<double> &state)
+      {
+        AssertThrow(state.size() == 1, ExcMessage("The state has the wrong size."));
+        n_noise_evaluations = static_cast<std::uint64_t>(state[0]);
+      }
+
+
+      void FilterBase::add_noise(Vector<double> &dst)
+      {
+        const extra::PhiloxKey key
+        {{std::uint32_t(noise_substream), std::uint32_t(noise_stream)}};
+        extra::PhiloxCounter counter
+        {{
+            std::uint32_t(n_noise_evaluations),
+            std::uint32_t(n_noise_evaluations >> 32), 0u, 0u
+          }
+        };
+        ++n_noise_evaluations;
+
+        const unsigned int n_entries = dst.size();
+        for (unsigned int block_n = 0; 4*block_n < n_entries; ++block_n)
+          {
+            counter[2] = block_n;
+            const extra::PhiloxCounter random_values
+              = extra::philox4x32(counter, key);
+            for (unsigned int i = 4*block_n;
+                 i < std::min(4*block_n + 4, n_entries); ++i)
+              {
+                dst[i] += noise_multiplier
+                          *extra::philox_to_uniform(random_values[i % 4]);
+              }
+          }
       }
 
 
@@ -98,13 +467,22 @@ namespace POD
        const FullMatrix<double> boundary_matrix,
        const double filter_radius,
        const double noise_multiplier,
-       const double lavrentiev_parameter) :
+       const double lavrentiev_parameter,
+       const unsigned int noise_stream,
+       const unsigned int noise_substream) :
         FilterBase(mass_matrix, laplace_matrix, boundary_matrix, filter_radius,
-                   noise_multiplier),
+                   noise_multiplier, noise_stream, noise_substream),
         lavrentiev_parameter {lavrentiev_parameter},
-        work0(mass_matrix.m()),
-        work1(mass_matrix.m())
-      {}
+        deconvolution_operator(mass_matrix.m()),
+        work0(mass_matrix.m())
+      {
+        // (M + mu (M + d^2 S)) M
+        FullMatrix<double> temp_0(mass_matrix);
+        temp_0.add(lavrentiev_parameter, filter_matrix);
+        FullMatrix<double> temp_1(mass_matrix.m());
+        temp_0.mmult(temp_1, mass_matrix);
+        filter_operator.mmult(deconvolution_operator, temp_1);
+      }
 
       /*
        * Apply the filter G = (M + d^2 S)^-1 to the input vector src. src
@@ -114,37 +492,31 @@ namespace POD
       (Vector<double> &dst, const Vector<double> &src)
       {
         // TODO is there anything specific to Lavrentiev that should be done here?
-        dst = src;
-        factorized_filter_matrix.apply_lu_factorization(dst, false);
+        filter_operator.vmult(dst, src);
       }
 
 
       /*
-       * Solve the linear system
+       * Compute the solution of the linear system
        *
        * (M + d^2 S) u^{AD-L} = (M + mu M + mu d^2 S) M (\bar{u} + noise)
        *
-       * for u^{AD-L}. This approximately undoes the action of the filter.
+       * with the precomputed deconvolution operator. This approximately undoes
+       * the action of the filter.
        */
       void LavrentievFilter::apply_inverse
       (Vector<double> &dst, const Vector<double> &src)
       {
-        work0 = src;
-
-        for (unsigned int i = 0; i < work0.size(); ++i)
+        if (noise_multiplier == 0.0)
           {
-            work0[i] += noise_multiplier * distribution(generator);
+            deconvolution_operator.vmult(dst, src);
+          }
+        else
+          {
+            work0 = src;
+            add_noise(work0);
+            deconvolution_operator.vmult(dst, work0);
           }
-
-        // M (\bar{u} + noise) == work1
-        mass_matrix.vmult(work1, work0);
-        mass_matrix.vmult(dst, work1);
-
-        filter_matrix.vmult(work0, work1);
-        work0 *= lavrentiev_parameter;
-        dst += work0;
-
-        factorized_filter_matrix.apply_lu_factorization(dst, false);
       }
 
       FilterRHS::FilterRHS
@@ -155,81 +527,136 @@ namespace POD
        const std::vector<FullMatrix<double>> nonlinear_operator,
        const Vector<double> mean_contribution,
        const double reynolds_n,
-       std::unique_ptr<FilterBase> ad_filter) :
-        mass_matrix {mass_matrix},
-        boundary_matrix {boundary_matrix},
-        laplace_matrix {laplace_matrix},
+       std::unique_ptr<FilterBase> ad_filter,
+       const bool symmetric_nonlinearity) :
         joint_convection_matrix {joint_convection_matrix},
-        nonlinear_operator {nonlinear_operator},
+        nonlinear_operator (nonlinear_operator,
+                            symmetric_nonlinearity
+                            ? QuadraticOperator<double>::Storage::symmetric
+                            : QuadraticOperator<double>::Storage::full),
         mean_contribution {mean_contribution},
         reynolds_n {reynolds_n},
         unfiltered_contribution(mass_matrix.m()),
-        work1(mass_matrix.m()),
-        work2(mass_matrix.m()),
         approximately_deconvolved_solution(mass_matrix.m()),
-        filter {std::move(ad_filter)}
+        filter {std::move(ad_filter)},
+        filtered_inverse_mass_matrix(mass_matrix.m()),
+        viscous_operator(mass_matrix.m())
       {
-        factorized_mass_matrix.reinit(mass_matrix.m());
-        factorized_mass_matrix = mass_matrix;
-        factorized_mass_matrix.compute_lu_factorization();
+        FullMatrix<double> viscous_matrix(boundary_matrix);
+        viscous_matrix.add(-1.0, laplace_matrix);
+        viscous_matrix *= 1.0/reynolds_n;
+
+        if (is_identity(mass_matrix))
+          {
+            filtered_inverse_mass_matrix = filter->get_filter_operator();
+            viscous_operator = viscous_matrix;
+          }
+        else
+          {
+            FullMatrix<double> inverse_mass_matrix(mass_matrix.m());
+            inverse_mass_matrix.invert(mass_matrix);
+            FullMatrix<double> temp(mass_matrix.m());
+            inverse_mass_matrix.mmult(temp, filter->get_filter_operator());
+            temp.mmult(filtered_inverse_mass_matrix, inverse_mass_matrix);
+            inverse_mass_matrix.mmult(viscous_operator, viscous_matrix);
+          }
       }
 
 
       void FilterRHS::apply
       (Vector<double> &dst, const Vector<double> &src)
       {
-        dst = 0.0;
+        apply_nonlinear_part(dst, src);
+        viscous_operator.vmult_add(dst, src);
+      }
+
+
+      const FullMatrix<double> &FilterRHS::get_linear_part() const
+      {
+        return viscous_operator;
+      }
+
+
+      void FilterRHS::apply_nonlinear_part
+      (Vector<double> &dst, const Vector<double> &src)
+      {
         // get an approximation of the unfiltered solution
         filter->apply_inverse(approximately_deconvolved_solution, src);
 
-        // compute the result of the filtered mean contribution
+        // compute the result of the filtered mean contribution, the
+        // convection matrices, and the nonlinearity
         unfiltered_contribution = mean_contribution;
+        joint_convection_matrix.vmult_add(unfiltered_contribution,
+                                          approximately_deconvolved_solution);
+        nonlinear_operator.vmult_add(unfiltered_contribution,
+                                     approximately_deconvolved_solution, -1.0);
 
-        // add the result of the convection matrices
-        joint_convection_matrix.vmult(work1, approximately_deconvolved_solution);
-        unfiltered_contribution += work1;
+        // dst = M^{-1} G M^{-1} (unfiltered contribution)
+        filtered_inverse_mass_matrix.vmult(dst, unfiltered_contribution);
+      }
 
-        // and the nonlinearity
-        for (unsigned int pod_vector_n = 0; pod_vector_n < src.size(); ++pod_vector_n)
-          {
-            nonlinear_operator[pod_vector_n].vmult(work1, approximately_deconvolved_solution);
-            unfiltered_contribution[pod_vector_n] -= work1 * approximately_deconvolved_solution;
-          }
-        factorized_mass_matrix.apply_lu_factorization(unfiltered_contribution, false);
-        filter->apply(work1, unfiltered_contribution);
-        dst += work1;
 
-        // add the result of the laplace matrix
-        laplace_matrix.vmult(work1, src);
-        dst.add(-1.0/reynolds_n, work1);
+      void FilterRHS::save_state(Vector<double> &state) const
+      {
+        filter->save_state(state);
+      }
 
-        // and the boundary matrix
-        boundary_matrix.vmult(work1, src);
-        dst.add(1.0/reynolds_n, work1);
 
-        factorized_mass_matrix.apply_lu_factorization(dst, false);
+      void FilterRHS::load_state(const Vector<double> &state)
+      {
+        filter->load_state(state);
       }
     }
 
     void PODDifferentialFilterRHS::apply
     (Vector<double> &dst, const Vector<double> &src)
     {
-      const unsigned int n_dofs = src.size();
       linear_operator.vmult(dst, src);
       dst += mean_contribution;
 
-      Vector<double> filtered_src(src.size());
+      Vector<double> &filtered_src = workspace[0];
       mass_matrix.vmult(filtered_src, src);
       factorized_filter_matrix.apply_lu_factorization(filtered_src, false);
 
-      Vector<double> temp(n_dofs);
-      for (unsigned int pod_vector_n = 0; pod_vector_n < n_dofs; ++pod_vector_n)
+      nonlinear_operator.vmult_add(dst, filtered_src, src, -1.0);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
+        }
+    }
+
+
+    void PODDifferentialFilterRHS::apply_nonlinear_part
+    (Vector<double> &dst, const Vector<double> &src)
+    {
+      dst = mean_contribution;
+
+      Vector<double> &filtered_src = workspace[0];
+      mass_matrix.vmult(filtered_src, src);
+      factorized_filter_matrix.apply_lu_factorization(filtered_src, false);
+
+      nonlinear_operator.vmult_add(dst, filtered_src, src, -1.0);
+
+      if (!identity_mass_matrix)
         {
-          nonlinear_operator[pod_vector_n].vmult(temp, src);
-          dst(pod_vector_n) -= temp * filtered_src;
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
         }
+    }
+
 
-      factorized_mass_matrix.apply_lu_factorization(dst, false);
+    void PODDifferentialFilterRHS::compute_jacobian
+    (FullMatrix<double> &jacobian, const Vector<double> &src)
+    {
+      Vector<double> &filtered_src = workspace[0];
+      filter_operator.vmult(filtered_src, src);
+
+      jacobian = linear_operator;
+      nonlinear_operator.right_jacobian_add(jacobian, filtered_src, -1.0);
+      FullMatrix<double> filtered_derivative(n_pod_dofs);
+      nonlinear_operator.left_jacobian_add(filtered_derivative, src, -1.0);
+      filtered_derivative.mmult(jacobian, filter_operator, true);
+      apply_inverse_mass_matrix(jacobian);
     }
 
 
@@ -247,6 +674,19 @@ namespace POD
       cutoff_n {cutoff_n}
     {
       this->linear_operator_without_convection.add(-1.0, joint_convection);
+
+      // the convection by the filtered solution only uses the leading
+      // columns of the joint convection matrix
+      linear_part = linear_operator_without_convection;
+      const unsigned int n_filtered = std::min(cutoff_n, n_pod_dofs);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          for (unsigned int j = 0; j < n_filtered; ++j)
+            {
+              linear_part(i, j) += joint_convection(i, j);
+            }
+        }
+      apply_inverse_mass_matrix(linear_part);
     }
 
 
@@ -257,51 +697,102 @@ namespace POD
       linear_operator_without_convection.vmult(dst, src);
       dst += mean_contribution;
 
-      auto filtered_src = src;
-      for (unsigned int pod_vector_n = cutoff_n; pod_vector_n < n_dofs;
-           ++pod_vector_n)
+      // The filtered solution is src with every coefficient past cutoff_n set
+      // to zero, so only the leading n_filtered columns of the convection
+      // matrix and rows of each slice of the nonlinearity contribute.
+      const unsigned int n_filtered = std::min(cutoff_n, n_dofs);
+      for (unsigned int i = 0; i < n_dofs; ++i)
+        {
+          double value = 0.0;
+          for (unsigned int j = 0; j < n_filtered; ++j)
+            {
+              value += joint_convection(i, j)*src[j];
+            }
+          dst[i] += value;
+        }
+
+      nonlinear_operator.vmult_add_leading(dst, src, src, n_filtered, -1.0);
+
+      if (!identity_mass_matrix)
+        {
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
+        }
+    }
+
+
+    void L2ProjectionFilterRHS::apply_nonlinear_part
+    (Vector<double> &dst, const Vector<double> &src)
+    {
+      dst = mean_contribution;
+      const unsigned int n_filtered = std::min(cutoff_n, n_pod_dofs);
+      nonlinear_operator.vmult_add_leading(dst, src, src, n_filtered, -1.0);
+
+      if (!identity_mass_matrix)
         {
-          filtered_src[pod_vector_n] = 0.0;
+          factorized_mass_matrix.apply_lu_factorization(dst, false);
         }
-      joint_convection.vmult_add(dst, filtered_src);
+    }
+
 
-      Vector<double> temp(n_dofs);
-      for (unsigned int pod_vector_n = 0; pod_vector_n < n_dofs; ++pod_vector_n)
+    void L2ProjectionFilterRHS::compute_jacobian
+    (FullMatrix<double> &jacobian, const Vector<double> &src)
+    {
+      // as in apply, only the leading n_filtered coefficients are filtered,
+      // so the derivatives with respect to the filtered solution only
+      // contribute to the leading n_filtered columns
+      const unsigned int n_filtered = std::min(cutoff_n, n_pod_dofs);
+      Vector<double> filtered_src(n_pod_dofs);
+      for (unsigned int j = 0; j < n_filtered; ++j)
         {
-          nonlinear_operator[pod_vector_n].vmult(temp, src);
-          dst(pod_vector_n) -= temp * filtered_src;
+          filtered_src[j] = src[j];
         }
 
-      factorized_mass_matrix.apply_lu_factorization(dst, false);
+      jacobian = linear_operator_without_convection;
+      nonlinear_operator.right_jacobian_add(jacobian, filtered_src, -1.0);
+      FullMatrix<double> filtered_derivative(n_pod_dofs);
+      nonlinear_operator.left_jacobian_add(filtered_derivative, src, -1.0);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          for (unsigned int j = 0; j < n_filtered; ++j)
+            {
+              jacobian(i, j) += joint_convection(i, j)
+                                + filtered_derivative(i, j);
+            }
+        }
+      apply_inverse_mass_matrix(jacobian);
     }
 
 
-    PostDifferentialFilter::PostDifferentialFilter
+    template<typename Number>
+    PostDifferentialFilter<Number>::PostDifferentialFilter
     (const FullMatrix<double> &mass_matrix,
      const FullMatrix<double> &laplace_matrix,
      const FullMatrix<double> &boundary_matrix,
      const double filter_radius) :
-      mass_matrix {mass_matrix}
+      mass_matrix (convert_matrix<Number>(mass_matrix))
     {
+      // assemble the filter in double precision and then round it
       FullMatrix<double> filter_matrix(mass_matrix.m());
       filter_matrix.add(1.0, mass_matrix);
       filter_matrix.add(filter_radius*filter_radius, laplace_matrix);
       filter_matrix.add(-1.0*filter_radius*filter_radius, boundary_matrix);
       factorized_post_filter_matrix.reinit(mass_matrix.m());
-      factorized_post_filter_matrix.copy_from(filter_matrix);
+      factorized_post_filter_matrix = filter_matrix;
       factorized_post_filter_matrix.compute_lu_factorization();
     }
 
 
-    void PostDifferentialFilter::apply(Vector<double> &dst,
-                                       const Vector<double> &src)
+    template<typename Number>
+    void PostDifferentialFilter<Number>::apply(Vector<Number> &dst,
+                                               const Vector<Number> &src)
     {
       mass_matrix.vmult(dst, src);
       factorized_post_filter_matrix.apply_lu_factorization(dst, false);
     }
 
 
-    PostDifferentialFilterRelax::PostDifferentialFilterRelax
+    template<typename Number>
+    PostDifferentialFilterRelax<Number>::PostDifferentialFilterRelax
     (const FullMatrix<double> &mass_matrix,
      const FullMatrix<double> &laplace_matrix,
      const FullMatrix<double> &boundary_matrix,
@@ -312,27 +803,42 @@ namespace POD
     {}
 
 
-    void PostDifferentialFilterRelax::apply(Vector<double> &dst,
-                                            const Vector<double> &src)
+    template<typename Number>
+    void PostDifferentialFilterRelax<Number>::apply(Vector<Number> &dst,
+                                                    const Vector<Number> &src)
     {
       differential_filter.apply(dst, src);
-      dst.sadd((1.0 - relaxation_parameter), relaxation_parameter, src);
+      dst.sadd((Number(1.0) - relaxation_parameter), relaxation_parameter, src);
     }
 
 
-    PostL2ProjectionFilter::PostL2ProjectionFilter
+    template<typename Number>
+    PostL2ProjectionFilter<Number>::PostL2ProjectionFilter
     (const unsigned int cutoff_n) : cutoff_n (cutoff_n) {}
 
 
-    void PostL2ProjectionFilter::apply(Vector<double> &dst,
-                                       const Vector<double> &src)
+    template<typename Number>
+    void PostL2ProjectionFilter<Number>::apply(Vector<Number> &dst,
+                                               const Vector<Number> &src)
     {
-      dst = src;
-      for (unsigned int pod_vector_n = cutoff_n; pod_vector_n < dst.size();
-           ++pod_vector_n)
+      if (dst.size() != src.size())
         {
-          dst[pod_vector_n] = 0.0;
+          dst.reinit(src.size(), true);
         }
+      const unsigned int n_filtered = std::min<unsigned int>(cutoff_n, src.size());
+      std::copy(src.begin(), src.begin() + n_filtered, dst.begin());
+      std::fill(dst.begin() + n_filtered, dst.end(), Number(0.0));
     }
+
+
+    template class PlainRHS<double>;
+    template class PlainRHS<float>;
+    template class PlainRHS<float, double>;
+    template class PostDifferentialFilter<double>;
+    template class PostDifferentialFilter<float>;
+    template class PostDifferentialFilterRelax<double>;
+    template class PostDifferentialFilterRelax<float>;
+    template class PostL2ProjectionFilter<double>;
+    template class PostL2ProjectionFilter<float>;
   }
 }
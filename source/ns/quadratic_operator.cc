@@ -0,0 +1,345 @@
+#include <deal.II-pod/ns/quadratic_operator.h>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace NavierStokes
+  {
+    namespace
+    {
+      // offset of row j of a packed upper triangular n x n matrix
+      inline std::size_t packed_row_offset(const std::size_t n, const std::size_t j)
+      {
+        return j*n - (j*(j - 1))/2;
+      }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    QuadraticOperator<Number, AccumulationNumber>::QuadraticOperator() :
+      n_pod_dofs {0},
+      storage {Storage::full}
+    {}
+
+
+    template<typename Number, typename AccumulationNumber>
+    QuadraticOperator<Number, AccumulationNumber>::QuadraticOperator
+    (const std::vector<FullMatrix<double>> &nonlinear_operator,
+     const Storage storage) :
+      n_pod_dofs {static_cast<unsigned int>(nonlinear_operator.size())},
+      storage {storage}
+    {
+      const std::size_t n = n_pod_dofs;
+      for (const auto &slice : nonlinear_operator)
+        {
+          AssertThrow(slice.m() == n && slice.n() == n,
+                      ExcMessage("Each slice of the nonlinearity must be a square "
+                                 "matrix with as many rows as there are slices."));
+        }
+
+      if (storage == Storage::full)
+        {
+          values.resize(n*n*n);
+          for (std::size_t i = 0; i < n; ++i)
+            {
+              for (std::size_t j = 0; j < n; ++j)
+                {
+                  for (std::size_t k = 0; k < n; ++k)
+                    {
+                      values[(i*n + j)*n + k] = nonlinear_operator[i](j, k);
+                    }
+                }
+            }
+        }
+      else
+        {
+          const std::size_t slice_size = (n*(n + 1))/2;
+          values.resize(n*slice_size);
+          for (std::size_t i = 0; i < n; ++i)
+            {
+              for (std::size_t j = 0; j < n; ++j)
+                {
+                  Number *row = values.begin() + i*slice_size
+                                + packed_row_offset(n, j) - j;
+                  row[j] = nonlinear_operator[i](j, j);
+                  for (std::size_t k = j + 1; k < n; ++k)
+                    {
+                      row[k] = nonlinear_operator[i](j, k)
+                               + nonlinear_operator[i](k, j);
+                    }
+                }
+            }
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    unsigned int QuadraticOperator<Number, AccumulationNumber>::size() const
+    {
+      return n_pod_dofs;
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    typename QuadraticOperator<Number, AccumulationNumber>::Storage
+    QuadraticOperator<Number, AccumulationNumber>::get_storage() const
+    {
+      return storage;
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::vmult_add
+    (Vector<AccumulationNumber> &dst,
+     const Vector<Number>       &a,
+     const Vector<Number>       &b,
+     const AccumulationNumber    factor) const
+    {
+      Assert(storage == Storage::full,
+             ExcMessage("The symmetric form can only evaluate a^T N_i a."));
+      Assert(dst.size() == n_pod_dofs, ExcDimensionMismatch(dst.size(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+      Assert(b.size() == n_pod_dofs, ExcDimensionMismatch(b.size(), n_pod_dofs));
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const a_values = a.begin();
+      const Number *const b_values = b.begin();
+      const Number *row = values.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          AccumulationNumber value = 0.0;
+          for (std::size_t j = 0; j < n; ++j, row += n)
+            {
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = 0; k < n; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*b_values[k];
+                }
+              value += a_values[j]*row_value;
+            }
+          dst[i] += factor*value;
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::vmult_add_leading
+    (Vector<AccumulationNumber> &dst,
+     const Vector<Number>       &a,
+     const Vector<Number>       &b,
+     const unsigned int          n_leading,
+     const AccumulationNumber    factor) const
+    {
+      Assert(storage == Storage::full,
+             ExcMessage("The symmetric form can only evaluate a^T N_i a."));
+      Assert(dst.size() == n_pod_dofs, ExcDimensionMismatch(dst.size(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+      Assert(b.size() == n_pod_dofs, ExcDimensionMismatch(b.size(), n_pod_dofs));
+      AssertIndexRange(n_leading, n_pod_dofs + 1);
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const a_values = a.begin();
+      const Number *const b_values = b.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          const Number *row = values.begin() + i*n*n;
+          AccumulationNumber value = 0.0;
+          for (std::size_t j = 0; j < n_leading; ++j, row += n)
+            {
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = 0; k < n; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*b_values[k];
+                }
+              value += a_values[j]*row_value;
+            }
+          dst[i] += factor*value;
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::vmult_add
+    (Vector<AccumulationNumber> &dst,
+     const Vector<Number>       &a,
+     const AccumulationNumber    factor) const
+    {
+      if (storage == Storage::full)
+        {
+          vmult_add(dst, a, a, factor);
+          return;
+        }
+      Assert(dst.size() == n_pod_dofs, ExcDimensionMismatch(dst.size(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const a_values = a.begin();
+      const Number *row = values.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          AccumulationNumber value = 0.0;
+          for (std::size_t j = 0; j < n; ++j)
+            {
+              // the packed row j holds the entries k = j, ..., n - 1
+              const std::size_t row_length = n - j;
+              const Number *const row_a_values = a_values + j;
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = 0; k < row_length; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*row_a_values[k];
+                }
+              value += a_values[j]*row_value;
+              row += row_length;
+            }
+          dst[i] += factor*value;
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::vmult_add_trailing
+    (Vector<AccumulationNumber> &dst,
+     const Vector<Number>       &a,
+     const unsigned int          n_leading,
+     const AccumulationNumber    factor) const
+    {
+      Assert(dst.size() == n_pod_dofs, ExcDimensionMismatch(dst.size(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+      AssertIndexRange(n_leading, n_pod_dofs + 1);
+
+      const std::size_t n = n_pod_dofs;
+      const std::size_t slice_size = storage == Storage::full ? n*n : (n*(n + 1))/2;
+      const Number *const a_values = a.begin();
+      for (std::size_t i = n_leading; i < n; ++i)
+        {
+          AccumulationNumber value = 0.0;
+          for (std::size_t j = n_leading; j < n; ++j)
+            {
+              // in symmetric storage row j only holds the entries k >= j
+              const std::size_t first_k = storage == Storage::full ? n_leading : j;
+              const Number *const row = values.begin() + i*slice_size
+                                        + (storage == Storage::full
+                                           ? j*n : packed_row_offset(n, j) - j);
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = first_k; k < n; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*a_values[k];
+                }
+              value += a_values[j]*row_value;
+            }
+          dst[i] += factor*value;
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::jacobian_add
+    (FullMatrix<Number>   &dst,
+     const Vector<Number> &a,
+     const Number          factor) const
+    {
+      Assert(dst.m() == n_pod_dofs, ExcDimensionMismatch(dst.m(), n_pod_dofs));
+      Assert(dst.n() == n_pod_dofs, ExcDimensionMismatch(dst.n(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const a_values = a.begin();
+      const Number *row = values.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          Number *const dst_row = &dst(i, 0);
+          for (std::size_t j = 0; j < n; ++j)
+            {
+              // in symmetric storage row j only holds the entries k >= j
+              const std::size_t first_k = storage == Storage::full ? 0 : j;
+              const std::size_t row_length = n - first_k;
+              const Number *const row_a_values = a_values + first_k;
+              Number *const row_dst = dst_row + first_k;
+              const Number a_j = factor*a_values[j];
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = 0; k < row_length; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*row_a_values[k];
+                  row_dst[k] += a_j*row[k];
+                }
+              dst_row[j] += factor*row_value;
+              row += row_length;
+            }
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::left_jacobian_add
+    (FullMatrix<Number>   &dst,
+     const Vector<Number> &b,
+     const Number          factor) const
+    {
+      Assert(storage == Storage::full,
+             ExcMessage("The symmetric form can only evaluate a^T N_i a."));
+      Assert(dst.m() == n_pod_dofs, ExcDimensionMismatch(dst.m(), n_pod_dofs));
+      Assert(dst.n() == n_pod_dofs, ExcDimensionMismatch(dst.n(), n_pod_dofs));
+      Assert(b.size() == n_pod_dofs, ExcDimensionMismatch(b.size(), n_pod_dofs));
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const b_values = b.begin();
+      const Number *row = values.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          Number *const dst_row = &dst(i, 0);
+          for (std::size_t j = 0; j < n; ++j, row += n)
+            {
+              AccumulationNumber row_value = 0.0;
+              #pragma omp simd reduction(+:row_value)
+              for (std::size_t k = 0; k < n; ++k)
+                {
+                  row_value += AccumulationNumber(row[k])*b_values[k];
+                }
+              dst_row[j] += factor*row_value;
+            }
+        }
+    }
+
+
+    template<typename Number, typename AccumulationNumber>
+    void QuadraticOperator<Number, AccumulationNumber>::right_jacobian_add
+    (FullMatrix<Number>   &dst,
+     const Vector<Number> &a,
+     const Number          factor) const
+    {
+      Assert(storage == Storage::full,
+             ExcMessage("The symmetric form can only evaluate a^T N_i a."));
+      Assert(dst.m() == n_pod_dofs, ExcDimensionMismatch(dst.m(), n_pod_dofs));
+      Assert(dst.n() == n_pod_dofs, ExcDimensionMismatch(dst.n(), n_pod_dofs));
+      Assert(a.size() == n_pod_dofs, ExcDimensionMismatch(a.size(), n_pod_dofs));
+
+      const std::size_t n = n_pod_dofs;
+      const Number *const a_values = a.begin();
+      const Number *row = values.begin();
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          Number *const dst_row = &dst(i, 0);
+          for (std::size_t j = 0; j < n; ++j, row += n)
+            {
+              const Number a_j = factor*a_values[j];
+              #pragma omp simd
+              for (std::size_t k = 0; k < n; ++k)
+                {
+                  dst_row[k] += a_j*row[k];
+                }
+            }
+        }
+    }
+
+
+    template class QuadraticOperator<double>;
+    template class QuadraticOperator<float>;
+    template class QuadraticOperator<float, double>;
+  }
+}
@@ -0,0 +1,211 @@
+#include <deal.II-pod/ode/observer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace ODE
+  {
+    StepObserver::StepObserver(const unsigned int interval,
+                               const bool asynchronous)
+      : interval {interval},
+        asynchronous {asynchronous}
+    {
+      Assert(interval > 0, ExcMessage("The interval must be positive."));
+    }
+
+
+    bool StepObserver::stop_requested() const
+    {
+      return false;
+    }
+
+
+    unsigned int StepObserver::get_interval() const
+    {
+      return interval;
+    }
+
+
+    bool StepObserver::is_asynchronous() const
+    {
+      return asynchronous;
+    }
+
+
+    FunctionStepObserver::FunctionStepObserver(const FunctionType &function,
+                                               const unsigned int interval,
+                                               const bool asynchronous)
+      : StepObserver(interval, asynchronous),
+        function {function}
+    {}
+
+
+    void FunctionStepObserver::observe(const unsigned int step_n,
+                                       const double time,
+                                       const Vector<double> &solution)
+    {
+      function(step_n, time, solution);
+    }
+
+
+    DivergenceMonitor::DivergenceMonitor(const FullMatrix<double> &mass_matrix,
+                                         const double max_energy,
+                                         const double max_coefficient,
+                                         const unsigned int interval)
+      : StepObserver(interval),
+        mass_matrix {mass_matrix},
+        max_energy {max_energy},
+        max_coefficient {max_coefficient},
+        mass_solution(mass_matrix.m()),
+        last_step_n {0},
+        last_time {0.0},
+        energy {0.0},
+        largest_coefficient {0.0}
+    {}
+
+
+    void DivergenceMonitor::observe(const unsigned int step_n, const double time,
+                                    const Vector<double> &solution)
+    {
+      if (!reason.empty())
+        {
+          return;
+        }
+      last_step_n = step_n;
+      last_time = time;
+
+      bool is_finite = true;
+      largest_coefficient = 0.0;
+      for (unsigned int i = 0; i < solution.size(); ++i)
+        {
+          is_finite = is_finite and std::isfinite(solution[i]);
+          largest_coefficient = std::max(largest_coefficient,
+                                         std::abs(solution[i]));
+        }
+      if (!is_finite)
+        {
+          energy = std::numeric_limits<double>::quiet_NaN();
+          reason = "not finite";
+          return;
+        }
+
+      // the energy may overflow, so sum by hand rather than with a deal.II
+      // dot product (which may assert that the result is finite).
+      mass_matrix.vmult(mass_solution, solution);
+      energy = 0.0;
+      for (unsigned int i = 0; i < solution.size(); ++i)
+        {
+          energy += solution[i]*mass_solution[i];
+        }
+
+      if (!std::isfinite(energy))
+        {
+          reason = "not finite";
+        }
+      else if (max_energy != 0.0 and energy > max_energy)
+        {
+          reason = "energy above threshold";
+        }
+      else if (max_coefficient != 0.0 and largest_coefficient > max_coefficient)
+        {
+          reason = "coefficient above threshold";
+        }
+    }
+
+
+    bool DivergenceMonitor::stop_requested() const
+    {
+      return !reason.empty();
+    }
+
+
+    void DivergenceMonitor::print_diagnostics(std::ostream &out) const
+    {
+      out << "reason: " << (reason.empty() ? "none" : reason) << std::endl
+          << "step: " << last_step_n << std::endl
+          << "time: " << last_time << std::endl
+          << "energy: " << energy << std::endl
+          << "largest coefficient: " << largest_coefficient << std::endl
+          << "max energy: " << max_energy << std::endl
+          << "max coefficient: " << max_coefficient << std::endl;
+    }
+
+
+    StepObserverList::~StepObserverList()
+    {
+      finish();
+    }
+
+
+    void StepObserverList::add(StepObserver &observer)
+    {
+      entries.emplace_back();
+      entries.back().observer = &observer;
+      entries.back().task_running = false;
+    }
+
+
+    void StepObserverList::join(Entry &entry)
+    {
+      if (entry.task_running)
+        {
+          entry.task.join();
+          entry.task_running = false;
+        }
+    }
+
+
+    bool StepObserverList::notify(const unsigned int step_n, const double time,
+                                  const Vector<double> &solution)
+    {
+      bool stop = false;
+      for (Entry &entry : entries)
+        {
+          StepObserver &observer = *entry.observer;
+          if (step_n % observer.get_interval() != 0)
+            {
+              continue;
+            }
+
+          if (observer.is_asynchronous())
+            {
+              // the copy of the solution may only be reused once the last
+              // observation is done.
+              join(entry);
+              stop = stop or observer.stop_requested();
+              entry.solution = solution;
+              Vector<double> &observed_solution = entry.solution;
+              entry.task = Threads::new_task
+                (std::function<void()>([&observer, &observed_solution, step_n, time]
+                 {
+                   observer.observe(step_n, time, observed_solution);
+                 }));
+              entry.task_running = true;
+            }
+          else
+            {
+              observer.observe(step_n, time, solution);
+              stop = stop or observer.stop_requested();
+            }
+        }
+      return stop;
+    }
+
+
+    bool StepObserverList::finish()
+    {
+      bool stop = false;
+      for (Entry &entry : entries)
+        {
+          join(entry);
+          stop = stop or entry.observer->stop_requested();
+        }
+      return stop;
+    }
+  }
+}
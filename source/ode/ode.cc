@@ -1,18 +1,99 @@
 #include <deal.II-pod/ode/ode.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace POD
 {
   using namespace dealii;
 
   namespace ODE
   {
-    RungeKuttaBase::RungeKuttaBase(std::unique_ptr<OperatorBase> rhs_function)
+    template<typename Number>
+    void Workspace<Number>::reserve(const unsigned int n_vectors,
+                                    const unsigned int size)
+    {
+      if (vectors.size() < n_vectors)
+        {
+          vectors.resize(n_vectors);
+        }
+      for (unsigned int i = 0; i < n_vectors; ++i)
+        {
+          if (vectors[i].size() != size)
+            {
+              vectors[i].reinit(size);
+            }
+        }
+    }
+
+
+    template<typename Number>
+    Vector<Number> &Workspace<Number>::operator[](const unsigned int n)
+    {
+      AssertIndexRange(n, vectors.size());
+      return vectors[n];
+    }
+
+
+    template<typename Number>
+    const Vector<Number> &Workspace<Number>::operator[](const unsigned int n) const
+    {
+      AssertIndexRange(n, vectors.size());
+      return vectors[n];
+    }
+
+
+    template<typename Number>
+    unsigned int Workspace<Number>::n_vectors() const
+    {
+      return vectors.size();
+    }
+
+
+    template<typename Number>
+    RungeKuttaBase<Number>::RungeKuttaBase
+    (std::unique_ptr<OperatorBase<Number>> rhs_function)
       : rhs_function {std::move(rhs_function)},
         n_dofs {numbers::invalid_unsigned_int}
     {}
 
 
-    void EmptyOperator::apply(Vector<double> &dst, const Vector<double> &src)
+    template<typename Number>
+    void RungeKuttaBase<Number>::save_state(Vector<double> &state) const
+    {
+      const StatefulOperator *stateful_function
+        = dynamic_cast<const StatefulOperator *>(rhs_function.get());
+      if (stateful_function != nullptr)
+        {
+          stateful_function->save_state(state);
+        }
+      else
+        {
+          state.reinit(0);
+        }
+    }
+
+
+    template<typename Number>
+    void RungeKuttaBase<Number>::load_state(const Vector<double> &state)
+    {
+      StatefulOperator *stateful_function
+        = dynamic_cast<StatefulOperator *>(rhs_function.get());
+      if (stateful_function != nullptr)
+        {
+          stateful_function->load_state(state);
+        }
+      else
+        {
+          AssertThrow(state.size() == 0,
+                      ExcMessage("The right hand side does not have a state."));
+        }
+    }
+
+
+    template<typename Number>
+    void EmptyOperator<Number>::apply(Vector<Number> &dst,
+                                      const Vector<Number> &src)
     {
       (void)dst;
       (void)src;
@@ -20,39 +101,45 @@ namespace POD
     }
 
 
-    RungeKutta4::RungeKutta4()
-      : RungeKuttaBase(std::unique_ptr<OperatorBase> {new EmptyOperator()})
+    template<typename Number>
+    RungeKutta4<Number>::RungeKutta4()
+      : RungeKuttaBase<Number>
+        (std::unique_ptr<OperatorBase<Number>> {new EmptyOperator<Number>()})
     {}
 
 
-    RungeKutta4::RungeKutta4(std::unique_ptr<OperatorBase> rhs_function)
-      : RungeKuttaBase {std::move(rhs_function)}
+    template<typename Number>
+    RungeKutta4<Number>::RungeKutta4
+    (std::unique_ptr<OperatorBase<Number>> rhs_function)
+      : RungeKuttaBase<Number> {std::move(rhs_function)}
     {}
 
 
-    void RungeKutta4::step
-    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    template<typename Number>
+    void RungeKutta4<Number>::step
+    (double time_step, const Vector<Number> &src, Vector<Number> &dst)
     {
-      if (n_dofs == numbers::invalid_unsigned_int)
+      if (this->n_dofs == numbers::invalid_unsigned_int)
         {
-          n_dofs = src.size();
-          temp.reinit(n_dofs);
-          step_1.reinit(n_dofs);
-          step_2.reinit(n_dofs);
-          step_3.reinit(n_dofs);
-          step_4.reinit(n_dofs);
+          this->n_dofs = src.size();
+          this->workspace.reserve(n_workspace_vectors, this->n_dofs);
         }
+      Vector<Number> &temp = this->workspace[0];
+      Vector<Number> &step_1 = this->workspace[1];
+      Vector<Number> &step_2 = this->workspace[2];
+      Vector<Number> &step_3 = this->workspace[3];
+      Vector<Number> &step_4 = this->workspace[4];
       temp = src;
-      rhs_function->apply(step_1, temp);
+      this->rhs_function->apply(step_1, temp);
       temp = src;
       temp.add(0.5*time_step, step_1);
-      rhs_function->apply(step_2, temp);
+      this->rhs_function->apply(step_2, temp);
       temp = src;
       temp.add(0.5*time_step, step_2);
-      rhs_function->apply(step_3, temp);
+      this->rhs_function->apply(step_3, temp);
       temp = src;
       temp.add(time_step, step_3);
-      rhs_function->apply(step_4, temp);
+      this->rhs_function->apply(step_4, temp);
 
       dst = src;
       dst.add(time_step/6.0, step_1);
@@ -62,20 +149,1091 @@ namespace POD
     }
 
 
-    RungeKutta4PostFilter::RungeKutta4PostFilter
-    (std::unique_ptr<OperatorBase> rhs_function,
-     std::unique_ptr<OperatorBase> filter_function)
-      : RungeKutta4 {std::move(rhs_function)},
+    LowStorageRungeKutta::LowStorageRungeKutta
+    (std::unique_ptr<OperatorBase<double>> rhs_function,
+     const LowStorageScheme scheme)
+      : RungeKuttaBase<double> {std::move(rhs_function)}
+    {
+      switch (scheme)
+        {
+        case LowStorageScheme::Williamson3:
+          register_coefficients = {0.0, -5.0/9.0, -153.0/128.0};
+          solution_coefficients = {1.0/3.0, 15.0/16.0, 8.0/15.0};
+          break;
+        case LowStorageScheme::CarpenterKennedy4:
+          register_coefficients =
+          {
+            0.0,
+            -567301805773.0/1357537059087.0,
+            -2404267990393.0/2016746695238.0,
+            -3550918686646.0/2091501179385.0,
+            -1275806237668.0/842570457699.0
+          };
+          solution_coefficients =
+          {
+            1432997174477.0/9575080441755.0,
+            5161836677717.0/13612068292357.0,
+            1720146321549.0/2090206949498.0,
+            3134564353537.0/4481467310338.0,
+            2277821191437.0/14882151754819.0
+          };
+          break;
+        default:
+          AssertThrow(false, StandardExceptions::ExcNotImplemented());
+        }
+    }
+
+
+    void LowStorageRungeKutta::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+          workspace.reserve(n_workspace_vectors, n_dofs);
+        }
+      Vector<double> &du = workspace[0];
+      Vector<double> &derivative = workspace[1];
+      // the solution is advanced in place.
+      dst = src;
+      for (unsigned int stage_n = 0; stage_n < register_coefficients.size();
+           ++stage_n)
+        {
+          rhs_function->apply(derivative, dst);
+          const double a = register_coefficients[stage_n];
+          const double b = solution_coefficients[stage_n];
+          // a is zero in the first stage, so du need not be initialized.
+          if (stage_n == 0)
+            {
+              for (unsigned int i = 0; i < n_dofs; ++i)
+                {
+                  du[i] = time_step*derivative[i];
+                  dst[i] += b*du[i];
+                }
+            }
+          else
+            {
+              for (unsigned int i = 0; i < n_dofs; ++i)
+                {
+                  du[i] = a*du[i] + time_step*derivative[i];
+                  dst[i] += b*du[i];
+                }
+            }
+        }
+    }
+
+
+    MultirateRungeKutta::MultirateRungeKutta
+    (std::unique_ptr<OperatorBase<double>> rhs_function,
+     const unsigned int n_slow,
+     const unsigned int n_substeps)
+      : RungeKuttaBase<double> {std::move(rhs_function)},
+        partitioned_function
+        {dynamic_cast<PartitionedOperator<double> *>(this->rhs_function.get())},
+        n_slow {n_slow},
+        n_substeps {n_substeps}
+    {
+      AssertThrow(partitioned_function != nullptr,
+                  ExcMessage("The multirate integrator requires a "
+                             "PartitionedOperator."));
+      AssertThrow(n_substeps > 0, ExcMessage("There must be at least one "
+                                             "substep."));
+    }
+
+
+    void MultirateRungeKutta::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+          workspace.reserve(n_workspace_vectors, n_dofs);
+        }
+      AssertIndexRange(n_slow, n_dofs + 1);
+      Vector<double> &temp = workspace[0];
+      Vector<double> &step_1 = workspace[1];
+      Vector<double> &step_2 = workspace[2];
+      Vector<double> &step_3 = workspace[3];
+      Vector<double> &step_4 = workspace[4];
+      Vector<double> &solution = workspace[5];
+
+      // 1. RK4 for the slow components: the fast components of temp stay at
+      // those of src.
+      temp = src;
+      rhs_function->apply(step_1, temp);
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          temp[i] = src[i] + 0.5*time_step*step_1[i];
+        }
+      rhs_function->apply(step_2, temp);
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          temp[i] = src[i] + 0.5*time_step*step_2[i];
+        }
+      rhs_function->apply(step_3, temp);
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          temp[i] = src[i] + time_step*step_3[i];
+        }
+      rhs_function->apply(step_4, temp);
+
+      // 2. RK4 substeps for the fast components, with the slow components at
+      // the midpoint of the step. Only the fast components of the vectors are
+      // used from here on.
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          temp[i] = src[i] + time_step/12.0*(step_1[i] + 2.0*step_2[i]
+                                              + 2.0*step_3[i] + step_4[i]);
+        }
+      partitioned_function->freeze_slow_part(temp, n_slow);
+      // the slow components are done
+      for (unsigned int i = 0; i < n_slow; ++i)
+        {
+          solution[i] = src[i] + time_step/6.0*(step_1[i] + 2.0*step_2[i]
+                                                      + 2.0*step_3[i] + step_4[i]);
+        }
+      for (unsigned int i = n_slow; i < n_dofs; ++i)
+        {
+          solution[i] = src[i];
+        }
+
+      const double substep = time_step/n_substeps;
+      for (unsigned int substep_n = 0; substep_n < n_substeps; ++substep_n)
+        {
+          partitioned_function->apply_fast_part(step_1, solution);
+          for (unsigned int i = n_slow; i < n_dofs; ++i)
+            {
+              temp[i] = solution[i] + 0.5*substep*step_1[i];
+            }
+          partitioned_function->apply_fast_part(step_2, temp);
+          for (unsigned int i = n_slow; i < n_dofs; ++i)
+            {
+              temp[i] = solution[i] + 0.5*substep*step_2[i];
+            }
+          partitioned_function->apply_fast_part(step_3, temp);
+          for (unsigned int i = n_slow; i < n_dofs; ++i)
+            {
+              temp[i] = solution[i] + substep*step_3[i];
+            }
+          partitioned_function->apply_fast_part(step_4, temp);
+          for (unsigned int i = n_slow; i < n_dofs; ++i)
+            {
+              solution[i] += substep/6.0*(step_1[i] + 2.0*step_2[i]
+                                               + 2.0*step_3[i] + step_4[i]);
+            }
+        }
+
+      dst = solution;
+    }
+
+
+    template<typename Number>
+    RungeKutta4PostFilter<Number>::RungeKutta4PostFilter
+    (std::unique_ptr<OperatorBase<Number>> rhs_function,
+     std::unique_ptr<OperatorBase<Number>> filter_function)
+      : RungeKutta4<Number> {std::move(rhs_function)},
         filter_function {std::move(filter_function)}
     {}
 
 
-    void RungeKutta4PostFilter::step
+    template<typename Number>
+    void RungeKutta4PostFilter<Number>::step
+    (double time_step, const Vector<Number> &src, Vector<Number> &dst)
+    {
+      // the unfiltered solution goes after the vectors used by RungeKutta4
+      constexpr unsigned int n_workspace_vectors
+        = RungeKutta4<Number>::n_workspace_vectors;
+      this->workspace.reserve(n_workspace_vectors + 1, src.size());
+      Vector<Number> &unfiltered_dst = this->workspace[n_workspace_vectors];
+      RungeKutta4<Number>::step(time_step, src, unfiltered_dst);
+      filter_function->apply(dst, unfiltered_dst);
+    }
+
+
+    namespace
+    {
+      // The Butcher tableau of the Dormand-Prince pair. The last row of a is
+      // the vector b of fifth order weights.
+      constexpr double dp_a21 {1.0/5.0};
+      constexpr double dp_a31 {3.0/40.0};
+      constexpr double dp_a32 {9.0/40.0};
+      constexpr double dp_a41 {44.0/45.0};
+      constexpr double dp_a42 {-56.0/15.0};
+      constexpr double dp_a43 {32.0/9.0};
+      constexpr double dp_a51 {19372.0/6561.0};
+      constexpr double dp_a52 {-25360.0/2187.0};
+      constexpr double dp_a53 {64448.0/6561.0};
+      constexpr double dp_a54 {-212.0/729.0};
+      constexpr double dp_a61 {9017.0/3168.0};
+      constexpr double dp_a62 {-355.0/33.0};
+      constexpr double dp_a63 {46732.0/5247.0};
+      constexpr double dp_a64 {49.0/176.0};
+      constexpr double dp_a65 {-5103.0/18656.0};
+      constexpr double dp_b1 {35.0/384.0};
+      constexpr double dp_b3 {500.0/1113.0};
+      constexpr double dp_b4 {125.0/192.0};
+      constexpr double dp_b5 {-2187.0/6784.0};
+      constexpr double dp_b6 {11.0/84.0};
+
+      // difference between the fifth and fourth order weights
+      constexpr double dp_e1 {71.0/57600.0};
+      constexpr double dp_e3 {-71.0/16695.0};
+      constexpr double dp_e4 {71.0/1920.0};
+      constexpr double dp_e5 {-17253.0/339200.0};
+      constexpr double dp_e6 {22.0/525.0};
+      constexpr double dp_e7 {-1.0/40.0};
+
+      // weights of the dense output (Hairer, Norsett, and Wanner, Solving
+      // Ordinary Differential Equations I, section II.6)
+      constexpr double dp_d1 {-12715105075.0/11282082432.0};
+      constexpr double dp_d3 {87487479700.0/32700410799.0};
+      constexpr double dp_d4 {-10690763975.0/1880347072.0};
+      constexpr double dp_d5 {701980252875.0/199316789632.0};
+      constexpr double dp_d6 {-1453857185.0/822651844.0};
+      constexpr double dp_d7 {69997945.0/29380423.0};
+
+      // step size control
+      constexpr double dp_safety_factor {0.9};
+      constexpr double dp_minimum_factor {0.2};
+      constexpr double dp_maximum_factor {10.0};
+    }
+
+
+    DormandPrince54::DormandPrince54
+    (std::unique_ptr<OperatorBase<double>> rhs_function,
+     const double absolute_tolerance,
+     const double relative_tolerance)
+      : RungeKuttaBase<double> {std::move(rhs_function)},
+        absolute_tolerance {absolute_tolerance},
+        relative_tolerance {relative_tolerance},
+        time {0.0},
+        previous_time {0.0},
+        next_time_step {0.0},
+        accepted_step_count {0},
+        rejected_step_count {0}
+    {
+      Assert(absolute_tolerance > 0.0 or relative_tolerance > 0.0,
+             ExcMessage("At least one tolerance must be positive."));
+    }
+
+
+    void DormandPrince54::step
     (double time_step, const Vector<double> &src, Vector<double> &dst)
     {
-      Vector<double> temp(src.size());
-      RungeKutta4::step(time_step, src, temp);
-      filter_function->apply(dst, temp);
+      // If src is the solution computed by the last call then the step size
+      // and the first stage may be reused.
+      if (n_dofs != src.size() or !(src == workspace[8]))
+        {
+          initialize(time, src, next_time_step > 0.0 ? next_time_step : time_step);
+        }
+      const double final_time = time + time_step;
+      while (time < final_time)
+        {
+          advance(final_time);
+        }
+      dst = workspace[8];
     }
+
+
+    void DormandPrince54::initialize
+    (const double time, const Vector<double> &initial_condition,
+     const double initial_time_step)
+    {
+      Assert(initial_time_step > 0.0, ExcMessage("The time step must be positive."));
+      n_dofs = initial_condition.size();
+      workspace.reserve(n_workspace_vectors, n_dofs);
+      this->time = time;
+      previous_time = time;
+      next_time_step = initial_time_step;
+
+      workspace[8] = initial_condition;
+      workspace[0] = initial_condition;
+      rhs_function->apply(workspace[1], workspace[0]);
+    }
+
+
+    void DormandPrince54::advance(const double maximum_time)
+    {
+      Assert(n_dofs != numbers::invalid_unsigned_int,
+             StandardExceptions::ExcNotInitialized());
+      Assert(maximum_time > time, ExcMessage("maximum_time must be in the future."));
+      Vector<double> &temp = workspace[0];
+      Vector<double> &step_1 = workspace[1];
+      Vector<double> &step_2 = workspace[2];
+      Vector<double> &step_3 = workspace[3];
+      Vector<double> &step_4 = workspace[4];
+      Vector<double> &step_5 = workspace[5];
+      Vector<double> &step_6 = workspace[6];
+      Vector<double> &step_7 = workspace[7];
+      Vector<double> &solution = workspace[8];
+      Vector<double> &trial_solution = workspace[9];
+
+      bool rejected = false;
+      while (true)
+        {
+          const bool last_step = next_time_step >= maximum_time - time;
+          const double h = last_step ? maximum_time - time : next_time_step;
+
+          temp = solution;
+          temp.add(h*dp_a21, step_1);
+          rhs_function->apply(step_2, temp);
+
+          temp = solution;
+          temp.add(h*dp_a31, step_1, h*dp_a32, step_2);
+          rhs_function->apply(step_3, temp);
+
+          temp = solution;
+          temp.add(h*dp_a41, step_1, h*dp_a42, step_2);
+          temp.add(h*dp_a43, step_3);
+          rhs_function->apply(step_4, temp);
+
+          temp = solution;
+          temp.add(h*dp_a51, step_1, h*dp_a52, step_2);
+          temp.add(h*dp_a53, step_3, h*dp_a54, step_4);
+          rhs_function->apply(step_5, temp);
+
+          temp = solution;
+          temp.add(h*dp_a61, step_1, h*dp_a62, step_2);
+          temp.add(h*dp_a63, step_3, h*dp_a64, step_4);
+          temp.add(h*dp_a65, step_5);
+          rhs_function->apply(step_6, temp);
+
+          trial_solution = solution;
+          trial_solution.add(h*dp_b1, step_1, h*dp_b3, step_3);
+          trial_solution.add(h*dp_b4, step_4, h*dp_b5, step_5);
+          trial_solution.add(h*dp_b6, step_6);
+          rhs_function->apply(step_7, trial_solution);
+
+          // root mean square of the scaled error estimate
+          double error = 0.0;
+          for (unsigned int i = 0; i < n_dofs; ++i)
+            {
+              const double local_error = h*(dp_e1*step_1[i] + dp_e3*step_3[i]
+                                            + dp_e4*step_4[i] + dp_e5*step_5[i]
+                                            + dp_e6*step_6[i] + dp_e7*step_7[i]);
+              const double scale = absolute_tolerance + relative_tolerance
+                                   *std::max(std::abs(solution[i]),
+                                             std::abs(trial_solution[i]));
+              error += (local_error/scale)*(local_error/scale);
+            }
+          error = std::sqrt(error/n_dofs);
+          const double factor = error == 0.0 ? dp_maximum_factor
+                                : std::min(dp_maximum_factor,
+                                           std::max(dp_minimum_factor,
+                                                    dp_safety_factor
+                                                    *std::pow(error, -0.2)));
+
+          if (error <= 1.0)
+            {
+              // set up the dense output of this step
+              Vector<double> &dense_1 = workspace[11];
+              Vector<double> &dense_2 = workspace[12];
+              Vector<double> &dense_3 = workspace[13];
+              Vector<double> &dense_4 = workspace[14];
+              dense_1 = trial_solution;
+              dense_1 -= solution;
+              dense_2 = dense_1;
+              dense_2.sadd(-1.0, h, step_1);
+              dense_3 = dense_1;
+              dense_3.add(-h, step_7, -1.0, dense_2);
+              dense_4.equ(h*dp_d1, step_1, h*dp_d3, step_3);
+              dense_4.add(h*dp_d4, step_4, h*dp_d5, step_5);
+              dense_4.add(h*dp_d6, step_6, h*dp_d7, step_7);
+
+              workspace[10].swap(solution);
+              solution.swap(trial_solution);
+              // first same as last
+              step_1.swap(step_7);
+
+              previous_time = time;
+              time = last_step ? maximum_time : time + h;
+              ++accepted_step_count;
+
+              // do not grow the step right after a rejection, and do not let a
+              // step that was shortened to stop at maximum_time shrink the next
+              const double proposed_time_step = next_time_step;
+              next_time_step = h*(rejected ? std::min(1.0, factor) : factor);
+              if (last_step and factor >= 1.0)
+                {
+                  next_time_step = std::max(next_time_step, proposed_time_step);
+                }
+              return;
+            }
+
+          ++rejected_step_count;
+          rejected = true;
+          next_time_step = h*factor;
+          AssertThrow(time + next_time_step > time,
+                      ExcMessage("The time step of DormandPrince54 underflowed."));
+        }
+    }
+
+
+    void DormandPrince54::interpolate(const double time, Vector<double> &dst)
+    {
+      Assert(n_dofs != numbers::invalid_unsigned_int,
+             StandardExceptions::ExcNotInitialized());
+      if (dst.size() != n_dofs)
+        {
+          dst.reinit(n_dofs);
+        }
+      if (time == this->time)
+        {
+          dst = workspace[8];
+          return;
+        }
+
+      const double h = this->time - previous_time;
+      Assert(h > 0.0 and time >= previous_time - 1e-12*h
+             and time <= this->time + 1e-12*h,
+             ExcMessage("The interpolation time must be in the last step."));
+      const double theta = (time - previous_time)/h;
+      const double theta_1 = 1.0 - theta;
+      const Vector<double> &previous_solution = workspace[10];
+      const Vector<double> &dense_1 = workspace[11];
+      const Vector<double> &dense_2 = workspace[12];
+      const Vector<double> &dense_3 = workspace[13];
+      const Vector<double> &dense_4 = workspace[14];
+      for (unsigned int i = 0; i < n_dofs; ++i)
+        {
+          dst[i] = previous_solution[i]
+                   + theta*(dense_1[i] + theta_1*(dense_2[i]
+                                                  + theta*(dense_3[i]
+                                                           + theta_1*dense_4[i])));
+        }
+    }
+
+
+    double DormandPrince54::get_time() const
+    {
+      return time;
+    }
+
+
+    double DormandPrince54::get_previous_time() const
+    {
+      return previous_time;
+    }
+
+
+    const Vector<double> &DormandPrince54::get_solution()
+    {
+      return workspace[8];
+    }
+
+
+    unsigned int DormandPrince54::n_accepted_steps() const
+    {
+      return accepted_step_count;
+    }
+
+
+    unsigned int DormandPrince54::n_rejected_steps() const
+    {
+      return rejected_step_count;
+    }
+
+
+    ImplicitIntegratorBase::ImplicitIntegratorBase
+    (std::unique_ptr<JacobianOperator<double>> rhs_function,
+     const double newton_tolerance,
+     const unsigned int max_newton_iterations)
+      : RungeKuttaBase<double>(nullptr),
+        jacobian_operator {rhs_function.get()},
+        newton_tolerance {newton_tolerance},
+        max_newton_iterations {max_newton_iterations},
+        factorized_factor {0.0},
+        jacobian_evaluation_count {0},
+        newton_iteration_count {0}
+    {
+      this->rhs_function = std::move(rhs_function);
+    }
+
+
+    unsigned int ImplicitIntegratorBase::n_jacobian_evaluations() const
+    {
+      return jacobian_evaluation_count;
+    }
+
+
+    unsigned int ImplicitIntegratorBase::n_newton_iterations() const
+    {
+      return newton_iteration_count;
+    }
+
+
+    void ImplicitIntegratorBase::update_jacobian(const Vector<double> &src)
+    {
+      jacobian_operator->compute_jacobian(jacobian, src);
+      ++jacobian_evaluation_count;
+      factorized_factor = 0.0;
+    }
+
+
+    void ImplicitIntegratorBase::factorize(const double factor)
+    {
+      // I - factor J
+      newton_matrix = jacobian;
+      newton_matrix *= -factor;
+      for (unsigned int i = 0; i < newton_matrix.m(); ++i)
+        {
+          newton_matrix(i, i) += 1.0;
+        }
+      factorized_newton_matrix.reinit(newton_matrix.m());
+      factorized_newton_matrix = newton_matrix;
+      factorized_newton_matrix.compute_lu_factorization();
+      factorized_factor = factor;
+    }
+
+
+    void ImplicitIntegratorBase::solve
+    (const double factor, const Vector<double> &rhs, Vector<double> &y)
+    {
+      Vector<double> &update = workspace[0];
+      Vector<double> &rhs_value = workspace[1];
+      Vector<double> &initial_guess = workspace[2];
+      initial_guess = y;
+
+      if (jacobian.m() != y.size())
+        {
+          update_jacobian(y);
+        }
+      // Try with the current (possibly old) Jacobian first, and then with
+      // one evaluated at the initial guess.
+      bool fresh_jacobian = false;
+      while (true)
+        {
+          if (factorized_factor != factor)
+            {
+              factorize(factor);
+            }
+
+          double previous_update_norm = 0.0;
+          for (unsigned int iteration_n = 0; iteration_n < max_newton_iterations;
+               ++iteration_n)
+            {
+              ++newton_iteration_count;
+              // update = rhs - (y - factor f(y))
+              rhs_function->apply(rhs_value, y);
+              update = rhs;
+              update -= y;
+              update.add(factor, rhs_value);
+              factorized_newton_matrix.apply_lu_factorization(update, false);
+              y += update;
+
+              const double update_norm = update.l2_norm();
+              if (update_norm <= newton_tolerance*std::max(1.0, y.l2_norm()))
+                {
+                  return;
+                }
+              // stop if the iteration is not contracting quickly enough
+              if (iteration_n > 0 and update_norm > 0.5*previous_update_norm)
+                {
+                  break;
+                }
+              previous_update_norm = update_norm;
+            }
+
+          AssertThrow(!fresh_jacobian,
+                      ExcMessage("The Newton iteration did not converge. Try a "
+                                 "smaller time step."));
+          y = initial_guess;
+          update_jacobian(y);
+          fresh_jacobian = true;
+        }
+    }
+
+
+    CrankNicolson::CrankNicolson
+    (std::unique_ptr<JacobianOperator<double>> rhs_function,
+     const double newton_tolerance,
+     const unsigned int max_newton_iterations)
+      : ImplicitIntegratorBase(std::move(rhs_function), newton_tolerance,
+                               max_newton_iterations)
+    {}
+
+
+    void CrankNicolson::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+        }
+      workspace.reserve(n_workspace_vectors, n_dofs);
+      Vector<double> &rhs = workspace[3];
+      Vector<double> &solution = workspace[4];
+
+      // use the forward Euler step as the initial guess
+      rhs_function->apply(solution, src);
+      rhs = src;
+      rhs.add(0.5*time_step, solution);
+      solution.sadd(time_step, 1.0, src);
+      solve(0.5*time_step, rhs, solution);
+      dst = solution;
+    }
+
+
+    BDF2::BDF2
+    (std::unique_ptr<JacobianOperator<double>> rhs_function,
+     const double newton_tolerance,
+     const unsigned int max_newton_iterations)
+      : CrankNicolson(std::move(rhs_function), newton_tolerance,
+                      max_newton_iterations),
+        previous_time_step {0.0}
+    {}
+
+
+    void BDF2::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+        }
+      workspace.reserve(n_bdf_workspace_vectors, n_dofs);
+      Vector<double> &old_solution = workspace[CrankNicolson::n_workspace_vectors];
+      Vector<double> &last_solution
+        = workspace[CrankNicolson::n_workspace_vectors + 1];
+
+      if (time_step != previous_time_step or !(src == last_solution))
+        {
+          CrankNicolson::step(time_step, src, last_solution);
+        }
+      else
+        {
+          Vector<double> &rhs = workspace[3];
+          Vector<double> &solution = workspace[4];
+          rhs.equ(4.0/3.0, src, -1.0/3.0, old_solution);
+          // extrapolate for the initial guess
+          solution.equ(2.0, src, -1.0, old_solution);
+          solve(2.0/3.0*time_step, rhs, solution);
+          last_solution = solution;
+        }
+      old_solution = src;
+      previous_time_step = time_step;
+      dst = last_solution;
+    }
+
+
+    void BDF2::save_state(Vector<double> &state) const
+    {
+      // the state is the previous time step, the number of entries in each
+      // of the two saved solutions (zero before the first step), the two
+      // solutions, and then the state of the right hand side.
+      Vector<double> rhs_state;
+      RungeKuttaBase<double>::save_state(rhs_state);
+      const unsigned int n_history_dofs = previous_time_step == 0.0 ? 0 : n_dofs;
+      state.reinit(2 + 2*n_history_dofs + rhs_state.size());
+      state[0] = previous_time_step;
+      state[1] = n_history_dofs;
+      for (unsigned int i = 0; i < n_history_dofs; ++i)
+        {
+          state[2 + i] = workspace[CrankNicolson::n_workspace_vectors][i];
+          state[2 + n_history_dofs + i]
+            = workspace[CrankNicolson::n_workspace_vectors + 1][i];
+        }
+      for (unsigned int i = 0; i < rhs_state.size(); ++i)
+        {
+          state[2 + 2*n_history_dofs + i] = rhs_state[i];
+        }
+    }
+
+
+    void BDF2::load_state(const Vector<double> &state)
+    {
+      AssertThrow(state.size() >= 2, ExcMessage("The state is too short."));
+      const unsigned int n_history_dofs = static_cast<unsigned int>(state[1]);
+      AssertThrow(state.size() >= 2 + 2*n_history_dofs,
+                  ExcMessage("The state is too short."));
+      previous_time_step = state[0];
+      if (n_history_dofs != 0)
+        {
+          n_dofs = n_history_dofs;
+          workspace.reserve(n_bdf_workspace_vectors, n_dofs);
+          for (unsigned int i = 0; i < n_history_dofs; ++i)
+            {
+              workspace[CrankNicolson::n_workspace_vectors][i] = state[2 + i];
+              workspace[CrankNicolson::n_workspace_vectors + 1][i]
+                = state[2 + n_history_dofs + i];
+            }
+        }
+
+      Vector<double> rhs_state(state.size() - 2 - 2*n_history_dofs);
+      for (unsigned int i = 0; i < rhs_state.size(); ++i)
+        {
+          rhs_state[i] = state[2 + 2*n_history_dofs + i];
+        }
+      RungeKuttaBase<double>::load_state(rhs_state);
+    }
+
+
+    IMEXRungeKutta::IMEXRungeKutta
+    (std::unique_ptr<OperatorBase<double>> rhs_function,
+     const IMEXScheme scheme,
+     std::unique_ptr<OperatorBase<double>> filter_function)
+      : RungeKuttaBase<double> {std::move(rhs_function)},
+        split_function
+        {dynamic_cast<SplitOperator<double> *>(this->rhs_function.get())},
+        filter_function {std::move(filter_function)},
+        factorized_time_step {0.0}
+    {
+      AssertThrow(split_function != nullptr,
+                  ExcMessage("The IMEX integrators require a SplitOperator."));
+      switch (scheme)
+        {
+        case IMEXScheme::ARS222:
+        {
+          const double gamma = 1.0 - 1.0/std::sqrt(2.0);
+          const double delta = 1.0 - 1.0/(2.0*gamma);
+          n_stages = 3;
+          explicit_coefficients.reinit(n_stages, n_stages);
+          implicit_coefficients.reinit(n_stages, n_stages);
+          explicit_coefficients(1, 0) = gamma;
+          explicit_coefficients(2, 0) = delta;
+          explicit_coefficients(2, 1) = 1.0 - delta;
+          implicit_coefficients(1, 1) = gamma;
+          implicit_coefficients(2, 1) = 1.0 - gamma;
+          implicit_coefficients(2, 2) = gamma;
+          diagonal_coefficient = gamma;
+          break;
+        }
+        case IMEXScheme::ARS443:
+        {
+          n_stages = 5;
+          explicit_coefficients.reinit(n_stages, n_stages);
+          implicit_coefficients.reinit(n_stages, n_stages);
+          explicit_coefficients(1, 0) = 1.0/2.0;
+          explicit_coefficients(2, 0) = 11.0/18.0;
+          explicit_coefficients(2, 1) = 1.0/18.0;
+          explicit_coefficients(3, 0) = 5.0/6.0;
+          explicit_coefficients(3, 1) = -5.0/6.0;
+          explicit_coefficients(3, 2) = 1.0/2.0;
+          explicit_coefficients(4, 0) = 1.0/4.0;
+          explicit_coefficients(4, 1) = 7.0/4.0;
+          explicit_coefficients(4, 2) = 3.0/4.0;
+          explicit_coefficients(4, 3) = -7.0/4.0;
+          implicit_coefficients(1, 1) = 1.0/2.0;
+          implicit_coefficients(2, 1) = 1.0/6.0;
+          implicit_coefficients(2, 2) = 1.0/2.0;
+          implicit_coefficients(3, 1) = -1.0/2.0;
+          implicit_coefficients(3, 2) = 1.0/2.0;
+          implicit_coefficients(3, 3) = 1.0/2.0;
+          implicit_coefficients(4, 1) = 3.0/2.0;
+          implicit_coefficients(4, 2) = -3.0/2.0;
+          implicit_coefficients(4, 3) = 1.0/2.0;
+          implicit_coefficients(4, 4) = 1.0/2.0;
+          diagonal_coefficient = 1.0/2.0;
+          break;
+        }
+        default:
+          AssertThrow(false, StandardExceptions::ExcNotImplemented());
+        }
+
+      // Both schemes are stiffly accurate: the weights are the last rows of
+      // the tableaux.
+      explicit_weights.reinit(n_stages);
+      implicit_weights.reinit(n_stages);
+      for (unsigned int j = 0; j < n_stages; ++j)
+        {
+          explicit_weights[j] = explicit_coefficients(n_stages - 1, j);
+          implicit_weights[j] = implicit_coefficients(n_stages - 1, j);
+        }
+    }
+
+
+    void IMEXRungeKutta::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+          workspace.reserve(n_fixed_workspace_vectors + 2*n_stages, n_dofs);
+        }
+      if (time_step != factorized_time_step)
+        {
+          // I - h gamma A
+          FullMatrix<double> stage_matrix(split_function->get_linear_part());
+          stage_matrix *= -time_step*diagonal_coefficient;
+          for (unsigned int i = 0; i < n_dofs; ++i)
+            {
+              stage_matrix(i, i) += 1.0;
+            }
+          factorized_stage_matrix.reinit(n_dofs);
+          factorized_stage_matrix = stage_matrix;
+          factorized_stage_matrix.compute_lu_factorization();
+          factorized_time_step = time_step;
+        }
+
+      const FullMatrix<double> &linear_part = split_function->get_linear_part();
+      Vector<double> &stage_value = workspace[0];
+      Vector<double> &result = workspace[1];
+      const unsigned int explicit_offset = n_fixed_workspace_vectors;
+      const unsigned int implicit_offset = n_fixed_workspace_vectors + n_stages;
+      for (unsigned int stage_n = 0; stage_n < n_stages; ++stage_n)
+        {
+          stage_value = src;
+          for (unsigned int j = 0; j < stage_n; ++j)
+            {
+              stage_value.add
+              (time_step*explicit_coefficients(stage_n, j),
+               workspace[explicit_offset + j],
+               time_step*implicit_coefficients(stage_n, j),
+               workspace[implicit_offset + j]);
+            }
+          if (implicit_coefficients(stage_n, stage_n) != 0.0)
+            {
+              factorized_stage_matrix.apply_lu_factorization(stage_value, false);
+            }
+          split_function->apply_nonlinear_part(workspace[explicit_offset + stage_n],
+                                               stage_value);
+          linear_part.vmult(workspace[implicit_offset + stage_n], stage_value);
+        }
+
+      result = src;
+      for (unsigned int j = 0; j < n_stages; ++j)
+        {
+          result.add(time_step*explicit_weights[j], workspace[explicit_offset + j],
+                     time_step*implicit_weights[j], workspace[implicit_offset + j]);
+        }
+
+      if (filter_function)
+        {
+          filter_function->apply(dst, result);
+        }
+      else
+        {
+          dst = result;
+        }
+    }
+
+
+    namespace
+    {
+      // exp(matrix) by the diagonal (6, 6) Pade approximant with scaling and
+      // squaring (Moler and Van Loan, SIAM Review, 2003): the approximant is
+      // accurate to double precision when the infinity norm is at most 1/2.
+      void matrix_exponential(const FullMatrix<double> &matrix,
+                              FullMatrix<double> &exponential)
+      {
+        const unsigned int n = matrix.m();
+        const double norm = matrix.linfty_norm();
+        const int n_squarings
+          = norm > 0.5 ? static_cast<int>(std::ceil(std::log2(norm/0.5))) : 0;
+        FullMatrix<double> scaled_matrix(matrix);
+        scaled_matrix *= std::ldexp(1.0, -n_squarings);
+
+        constexpr unsigned int pade_degree {6};
+        FullMatrix<double> numerator(n, n);
+        FullMatrix<double> denominator(n, n);
+        FullMatrix<double> power(n, n);
+        FullMatrix<double> temp(n, n);
+        for (unsigned int i = 0; i < n; ++i)
+          {
+            numerator(i, i) = 1.0;
+            denominator(i, i) = 1.0;
+            power(i, i) = 1.0;
+          }
+        double coefficient = 1.0;
+        for (unsigned int k = 1; k <= pade_degree; ++k)
+          {
+            coefficient *= double(pade_degree - k + 1)
+                           /double((2*pade_degree - k + 1)*k);
+            scaled_matrix.mmult(temp, power);
+            power = temp;
+            numerator.add(coefficient, power);
+            denominator.add(k % 2 == 0 ? coefficient : -coefficient, power);
+          }
+        temp.invert(denominator);
+        exponential.reinit(n, n);
+        temp.mmult(exponential, numerator);
+
+        for (int squaring_n = 0; squaring_n < n_squarings; ++squaring_n)
+          {
+            exponential.mmult(temp, exponential);
+            exponential = temp;
+          }
+      }
+    }
+
+
+    ETDRungeKutta4::ETDRungeKutta4(std::unique_ptr<OperatorBase<double>> rhs_function)
+      : RungeKuttaBase<double> {std::move(rhs_function)},
+        split_function
+        {dynamic_cast<SplitOperator<double> *>(this->rhs_function.get())},
+        operator_time_step {0.0}
+    {
+      AssertThrow(split_function != nullptr,
+                  ExcMessage("The ETD integrators require a SplitOperator."));
+    }
+
+
+    void ETDRungeKutta4::compute_operators(const double time_step)
+    {
+      const FullMatrix<double> &linear_part = split_function->get_linear_part();
+      const unsigned int n = linear_part.m();
+
+      // The exponential of the block matrix
+      //
+      // [hA I 0 0]
+      // [0  0 I 0]
+      // [0  0 0 I]
+      // [0  0 0 0]
+      //
+      // has first block row [exp(hA) phi_1(hA) phi_2(hA) phi_3(hA)], and that of
+      // [hA/2 I; 0 0] has first block row [exp(hA/2) phi_1(hA/2)].
+      FullMatrix<double> augmented_matrix(4*n, 4*n);
+      for (unsigned int i = 0; i < n; ++i)
+        {
+          for (unsigned int j = 0; j < n; ++j)
+            {
+              augmented_matrix(i, j) = time_step*linear_part(i, j);
+            }
+          for (unsigned int block_n = 0; block_n < 3; ++block_n)
+            {
+              augmented_matrix(block_n*n + i, (block_n + 1)*n + i) = 1.0;
+            }
+        }
+      FullMatrix<double> augmented_exponential;
+      matrix_exponential(augmented_matrix, augmented_exponential);
+
+      FullMatrix<double> half_augmented_matrix(2*n, 2*n);
+      for (unsigned int i = 0; i < n; ++i)
+        {
+          for (unsigned int j = 0; j < n; ++j)
+            {
+              half_augmented_matrix(i, j) = 0.5*time_step*linear_part(i, j);
+            }
+          half_augmented_matrix(i, n + i) = 1.0;
+        }
+      FullMatrix<double> half_augmented_exponential;
+      matrix_exponential(half_augmented_matrix, half_augmented_exponential);
+
+      exponential.reinit(n, n);
+      half_exponential.reinit(n, n);
+      half_step_operator.reinit(n, n);
+      first_weight.reinit(n, n);
+      middle_weight.reinit(n, n);
+      last_weight.reinit(n, n);
+      for (unsigned int i = 0; i < n; ++i)
+        {
+          for (unsigned int j = 0; j < n; ++j)
+            {
+              exponential(i, j) = augmented_exponential(i, j);
+              const double phi_1 = augmented_exponential(i, n + j);
+              const double phi_2 = augmented_exponential(i, 2*n + j);
+              const double phi_3 = augmented_exponential(i, 3*n + j);
+              first_weight(i, j)
+                = time_step*(phi_1 - 3.0*phi_2 + 4.0*phi_3);
+              middle_weight(i, j) = time_step*(2.0*phi_2 - 4.0*phi_3);
+              last_weight(i, j) = time_step*(4.0*phi_3 - phi_2);
+
+              half_exponential(i, j) = half_augmented_exponential(i, j);
+              half_step_operator(i, j)
+                = 0.5*time_step*half_augmented_exponential(i, n + j);
+            }
+        }
+      operator_time_step = time_step;
+    }
+
+
+    void ETDRungeKutta4::step
+    (double time_step, const Vector<double> &src, Vector<double> &dst)
+    {
+      if (n_dofs == numbers::invalid_unsigned_int)
+        {
+          n_dofs = src.size();
+          workspace.reserve(n_workspace_vectors, n_dofs);
+        }
+      if (time_step != operator_time_step)
+        {
+          compute_operators(time_step);
+        }
+
+      Vector<double> &half_propagated_src = workspace[0];
+      Vector<double> &stage_a = workspace[1];
+      Vector<double> &stage_b = workspace[2];
+      Vector<double> &stage_c = workspace[3];
+      Vector<double> &nonlinear_src = workspace[4];
+      Vector<double> &nonlinear_a = workspace[5];
+      Vector<double> &nonlinear_b = workspace[6];
+      Vector<double> &nonlinear_c = workspace[7];
+      Vector<double> &temp = workspace[8];
+
+      half_exponential.vmult(half_propagated_src, src);
+      split_function->apply_nonlinear_part(nonlinear_src, src);
+
+      // a = exp(hA/2) y_n + h/2 phi_1(hA/2) g(y_n)
+      stage_a = half_propagated_src;
+      half_step_operator.vmult_add(stage_a, nonlinear_src);
+      split_function->apply_nonlinear_part(nonlinear_a, stage_a);
+
+      // b = exp(hA/2) y_n + h/2 phi_1(hA/2) g(a)
+      stage_b = half_propagated_src;
+      half_step_operator.vmult_add(stage_b, nonlinear_a);
+      split_function->apply_nonlinear_part(nonlinear_b, stage_b);
+
+      // c = exp(hA/2) a + h/2 phi_1(hA/2) (2 g(b) - g(y_n))
+      half_exponential.vmult(stage_c, stage_a);
+      temp.equ(2.0, nonlinear_b, -1.0, nonlinear_src);
+      half_step_operator.vmult_add(stage_c, temp);
+      split_function->apply_nonlinear_part(nonlinear_c, stage_c);
+
+      // the result is accumulated in stage_a so that src and dst may alias.
+      exponential.vmult(stage_a, src);
+      first_weight.vmult_add(stage_a, nonlinear_src);
+      temp.equ(1.0, nonlinear_a, 1.0, nonlinear_b);
+      middle_weight.vmult_add(stage_a, temp);
+      last_weight.vmult_add(stage_a, nonlinear_c);
+      dst = stage_a;
+    }
+
+
+    EnsembleRungeKutta4::EnsembleRungeKutta4
+    (std::unique_ptr<EnsembleOperatorBase> rhs_function)
+      : rhs_function {std::move(rhs_function)}
+    {}
+
+
+    void EnsembleRungeKutta4::step
+    (double time_step, const FullMatrix<double> &src, FullMatrix<double> &dst)
+    {
+      if (step_1.m() != src.m() or step_1.n() != src.n())
+        {
+          temp.reinit(src.m(), src.n());
+          step_1.reinit(src.m(), src.n());
+          step_2.reinit(src.m(), src.n());
+          step_3.reinit(src.m(), src.n());
+          step_4.reinit(src.m(), src.n());
+        }
+      rhs_function->apply(step_1, src);
+      temp = src;
+      temp.add(0.5*time_step, step_1);
+      rhs_function->apply(step_2, temp);
+      temp = src;
+      temp.add(0.5*time_step, step_2);
+      rhs_function->apply(step_3, temp);
+      temp = src;
+      temp.add(time_step, step_3);
+      rhs_function->apply(step_4, temp);
+
+      dst = src;
+      dst.add(time_step/6.0, step_1);
+      dst.add(time_step/3.0, step_2);
+      dst.add(time_step/3.0, step_3);
+      dst.add(time_step/6.0, step_4);
+    }
+
+
+    template class Workspace<double>;
+    template class Workspace<float>;
+    template class EmptyOperator<double>;
+    template class EmptyOperator<float>;
+    template class RungeKuttaBase<double>;
+    template class RungeKuttaBase<float>;
+    template class RungeKutta4<double>;
+    template class RungeKutta4<float>;
+    template class RungeKutta4PostFilter<double>;
+    template class RungeKutta4PostFilter<float>;
   }
 }
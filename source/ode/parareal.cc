@@ -0,0 +1,168 @@
+#include <deal.II/base/thread_management.h>
+
+#include <deal.II-pod/ode/parareal.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace POD
+{
+  using namespace dealii;
+
+  namespace ODE
+  {
+    Parareal::Parareal(const IntegratorFactory &create_coarse_integrator,
+                       const double             coarse_time_step,
+                       const IntegratorFactory &create_fine_integrator,
+                       const unsigned int       n_slices,
+                       const double             tolerance,
+                       const unsigned int       max_iterations)
+      : create_fine_integrator {create_fine_integrator},
+        coarse_integrator {create_coarse_integrator()},
+        coarse_time_step {coarse_time_step},
+        max_n_slices {n_slices},
+        tolerance {tolerance},
+        max_iterations {max_iterations},
+        time_step {0.0},
+        output_interval {1},
+        n_done_iterations {0}
+    {
+      Assert(n_slices > 0, ExcMessage("There must be at least one slice."));
+      Assert(coarse_time_step > 0.0, ExcMessage("The time step must be positive."));
+    }
+
+
+    void Parareal::coarse_propagate(const unsigned int slice_n,
+                                    const Vector<double> &src,
+                                    Vector<double> &dst)
+    {
+      const double slice_length
+        = time_step*(slice_begin[slice_n + 1] - slice_begin[slice_n]);
+      const unsigned int n_coarse_steps = std::max
+        (1u, static_cast<unsigned int>(std::round(slice_length/coarse_time_step)));
+      dst = src;
+      Vector<double> temp(src.size());
+      for (unsigned int step_n = 0; step_n < n_coarse_steps; ++step_n)
+        {
+          coarse_integrator->step(slice_length/n_coarse_steps, dst, temp);
+          dst.swap(temp);
+        }
+    }
+
+
+    void Parareal::fine_propagate(const unsigned int slice_n,
+                                  const Vector<double> &src,
+                                  Vector<double> &dst)
+    {
+      std::vector<Vector<double>> &outputs = slice_outputs[slice_n];
+      outputs.clear();
+      dst = src;
+      Vector<double> temp(src.size());
+      for (unsigned int step_n = slice_begin[slice_n];
+           step_n < slice_begin[slice_n + 1]; ++step_n)
+        {
+          fine_integrators[slice_n]->step(time_step, dst, temp);
+          dst.swap(temp);
+          if (step_n % output_interval == 0)
+            {
+              outputs.push_back(dst);
+            }
+        }
+    }
+
+
+    void Parareal::run(const double                 time_step,
+                       const unsigned int           n_steps,
+                       const unsigned int           output_interval,
+                       const Vector<double>        &initial_condition,
+                       Vector<double>              &dst,
+                       std::vector<Vector<double>> &outputs)
+    {
+      Assert(output_interval > 0, ExcMessage("The output interval must be positive."));
+      this->time_step = time_step;
+      this->output_interval = output_interval;
+
+      // there must be at least one step per slice
+      const unsigned int n_slices = std::max(1u, std::min(max_n_slices, n_steps));
+      slice_begin.resize(n_slices + 1);
+      for (unsigned int slice_n = 0; slice_n <= n_slices; ++slice_n)
+        {
+          slice_begin[slice_n] = static_cast<unsigned int>
+            ((static_cast<unsigned long long>(slice_n)*n_steps)/n_slices);
+        }
+      slice_outputs.resize(n_slices);
+      while (fine_integrators.size() < n_slices)
+        {
+          fine_integrators.push_back(create_fine_integrator());
+        }
+
+      // U_n is the solution at the start of slice n. The initial guess comes
+      // from the coarse integrator alone.
+      std::vector<Vector<double>> solutions(n_slices + 1, initial_condition);
+      std::vector<Vector<double>> coarse_solutions(n_slices, initial_condition);
+      std::vector<Vector<double>> fine_solutions(n_slices, initial_condition);
+      for (unsigned int slice_n = 0; slice_n < n_slices; ++slice_n)
+        {
+          coarse_propagate(slice_n, solutions[slice_n], coarse_solutions[slice_n]);
+          solutions[slice_n + 1] = coarse_solutions[slice_n];
+        }
+
+      Vector<double> new_coarse_solution(initial_condition.size());
+      Vector<double> new_solution(initial_condition.size());
+      n_done_iterations = 0;
+      for (unsigned int iteration_n = 0;
+           iteration_n < std::min(max_iterations, n_slices); ++iteration_n)
+        {
+          // Slices before iteration_n started from their converged values in an
+          // earlier iteration, so their fine solutions are already known.
+          Threads::TaskGroup<> fine_tasks;
+          for (unsigned int slice_n = iteration_n; slice_n < n_slices; ++slice_n)
+            {
+              fine_tasks += Threads::new_task
+                (std::function<void()>([this, slice_n, &solutions, &fine_solutions]
+                 {
+                   fine_propagate(slice_n, solutions[slice_n],
+                                  fine_solutions[slice_n]);
+                 }));
+            }
+          fine_tasks.join_all();
+          ++n_done_iterations;
+
+          double max_change = 0.0;
+          for (unsigned int slice_n = iteration_n; slice_n < n_slices; ++slice_n)
+            {
+              coarse_propagate(slice_n, solutions[slice_n], new_coarse_solution);
+              new_solution = new_coarse_solution;
+              new_solution -= coarse_solutions[slice_n];
+              new_solution += fine_solutions[slice_n];
+              coarse_solutions[slice_n].swap(new_coarse_solution);
+
+              solutions[slice_n + 1] -= new_solution;
+              const double scale = std::max(new_solution.linfty_norm(),
+                                            std::numeric_limits<double>::min());
+              max_change = std::max(max_change,
+                                    solutions[slice_n + 1].linfty_norm()/scale);
+              solutions[slice_n + 1].swap(new_solution);
+            }
+          if (max_change <= tolerance)
+            {
+              break;
+            }
+        }
+
+      dst = solutions[n_slices];
+      outputs.clear();
+      for (const std::vector<Vector<double>> &slice_output : slice_outputs)
+        {
+          outputs.insert(outputs.end(), slice_output.begin(), slice_output.end());
+        }
+    }
+
+
+    unsigned int Parareal::n_iterations() const
+    {
+      return n_done_iterations;
+    }
+  }
+}
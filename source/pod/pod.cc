@@ -1,4 +1,5 @@
 #include <deal.II-pod/extra/extra.h>
+#include <deal.II-pod/extra/resize.h>
 
 #include <deal.II-pod/h5/h5.h>
 
@@ -217,6 +218,56 @@ namespace POD
       }
   }
 
+
+  void extend_reduced_matrix(const std::vector<BlockVector<double>> &pod_vectors,
+                             const SparseMatrix<double>             &full_matrix,
+                             FullMatrix<double>                     &rom_matrix)
+  {
+    std::vector<unsigned int> dims;
+    for (unsigned int i = 0; i < pod_vectors.at(0).n_blocks(); ++i)
+      {
+        dims.push_back(i);
+      }
+    extend_reduced_matrix(pod_vectors, full_matrix, dims, rom_matrix);
+  }
+
+
+  void extend_reduced_matrix(const std::vector<BlockVector<double>> &pod_vectors,
+                             const SparseMatrix<double>             &full_matrix,
+                             const std::vector<unsigned int>        &dims,
+                             FullMatrix<double>                     &rom_matrix)
+  {
+    const unsigned int n_dofs = pod_vectors[0].block(0).size();
+    const unsigned int n_pod_dofs = pod_vectors.size();
+    const unsigned int n_old_pod_dofs = rom_matrix.m();
+    AssertThrow(n_old_pod_dofs <= n_pod_dofs,
+                ExcMessage("The reduced matrix is larger than the POD basis."));
+    extra::resize(rom_matrix, n_pod_dofs);
+
+    Vector<double> temp(n_dofs);
+    for (auto dim_n : dims)
+      {
+        // new columns, all rows
+        for (unsigned int column = n_old_pod_dofs; column < n_pod_dofs; ++column)
+          {
+            full_matrix.vmult(temp, pod_vectors.at(column).block(dim_n));
+            for (unsigned int row = 0; row < n_pod_dofs; ++row)
+              {
+                rom_matrix(row, column) += pod_vectors.at(row).block(dim_n) * temp;
+              }
+          }
+        // new rows, old columns
+        for (unsigned int row = n_old_pod_dofs; row < n_pod_dofs; ++row)
+          {
+            full_matrix.Tvmult(temp, pod_vectors.at(row).block(dim_n));
+            for (unsigned int column = 0; column < n_old_pod_dofs; ++column)
+              {
+                rom_matrix(row, column) += pod_vectors.at(column).block(dim_n) * temp;
+              }
+          }
+      }
+  }
+
   template class PODOutput<2>;
 
   template class PODOutput<3>;
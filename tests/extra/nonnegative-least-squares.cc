@@ -0,0 +1,85 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+
+#include <deal.II-pod/extra/nnls.h>
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  // The unconstrained solution is (1, -1, 2), so the constrained one is
+  // (1, 0, 2).
+  {
+    FullMatrix<double> identity(3, 3);
+    for (unsigned int i = 0; i < identity.m(); ++i)
+      {
+        identity(i, i) = 1.0;
+      }
+    Vector<double> rhs(3);
+    rhs[0] = 1.0;
+    rhs[1] = -1.0;
+    rhs[2] = 2.0;
+
+    Vector<double> solution;
+    extra::nonnegative_least_squares(identity, rhs, 1e-14, 3, solution);
+    if (std::abs(solution[0] - 1.0) > 1e-14 || solution[1] != 0.0
+        || std::abs(solution[2] - 2.0) > 1e-14)
+      {
+        return 1;
+      }
+  }
+
+  // A consistent overdetermined system with a positive solution.
+  {
+    FullMatrix<double> matrix(4, 2);
+    for (unsigned int i = 0; i < matrix.m(); ++i)
+      {
+        matrix(i, 0) = 1.0;
+        matrix(i, 1) = double(i + 1);
+      }
+    Vector<double> exact_solution(2);
+    exact_solution[0] = 2.0;
+    exact_solution[1] = 3.0;
+    Vector<double> rhs(4);
+    matrix.vmult(rhs, exact_solution);
+
+    Vector<double> solution;
+    extra::nonnegative_least_squares(matrix, rhs, 1e-12, 2, solution);
+    solution -= exact_solution;
+    if (solution.l2_norm() > 1e-10)
+      {
+        return 1;
+      }
+  }
+
+  // A degenerate problem: the dual of the second column is zero at the
+  // solution (0, 0, 1/3), so roundoff may add it to the passive set, where its
+  // coefficient is zero and stays zero. That must not stop the iteration.
+  {
+    FullMatrix<double> matrix(3, 3);
+    matrix(0, 0) = -1.0;
+    matrix(0, 1) = 2.0;
+    matrix(0, 2) = 2.0;
+    matrix(1, 0) = -1.0;
+    matrix(1, 1) = 2.0;
+    matrix(1, 2) = 1.0;
+    matrix(2, 0) = -1.0;
+    matrix(2, 2) = 1.0;
+    Vector<double> rhs(3);
+    rhs[1] = 1.0;
+    rhs[2] = 1.0;
+
+    Vector<double> solution;
+    extra::nonnegative_least_squares(matrix, rhs, 1e-14, 3, solution);
+    if (solution[0] != 0.0 || std::abs(solution[1]) > 1e-14
+        || std::abs(solution[2] - 1.0/3.0) > 1e-14)
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
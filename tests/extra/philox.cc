@@ -0,0 +1,29 @@
+#include <deal.II-pod/extra/philox.h>
+
+// known answers from the reference implementation (Random123)
+int main()
+{
+  using namespace POD::extra;
+
+  if (philox4x32({{0u, 0u, 0u, 0u}}, {{0u, 0u}})
+      != PhiloxCounter {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}})
+    {
+      return 1;
+    }
+
+  if (philox4x32({{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}},
+                 {{0xffffffffu, 0xffffffffu}})
+      != PhiloxCounter {{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}})
+    {
+      return 1;
+    }
+
+  if (philox4x32({{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}},
+                 {{0xa4093822u, 0x299f31d0u}})
+      != PhiloxCounter {{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}})
+    {
+      return 1;
+    }
+
+  return 0;
+}
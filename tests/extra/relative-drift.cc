@@ -0,0 +1,42 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+
+#include <deal.II-pod/extra/extra.h>
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  constexpr unsigned int n_rows {3};
+  constexpr unsigned int n_columns {2};
+  FullMatrix<double> reference(n_rows, n_columns);
+  FullMatrix<double> solutions(n_rows, n_columns);
+  // an exact row, a row with relative error 0.1 and a zero reference row
+  reference(0, 0) = 1.0;
+  reference(0, 1) = 2.0;
+  solutions(0, 0) = 1.0;
+  solutions(0, 1) = 2.0;
+  reference(1, 0) = 3.0;
+  reference(1, 1) = 4.0;
+  solutions(1, 0) = 3.3;
+  solutions(1, 1) = 4.4;
+  solutions(2, 0) = 0.3;
+  solutions(2, 1) = 0.4;
+
+  const Vector<double> drift = extra::relative_drift(solutions, reference);
+  if (drift.size() != n_rows)
+    {
+      return 1;
+    }
+  if (drift[0] != 0.0
+      or std::abs(drift[1] - 0.1) > 1e-14
+      or std::abs(drift[2] - 0.5) > 1e-14)
+    {
+      return 1;
+    }
+
+  return 0;
+}
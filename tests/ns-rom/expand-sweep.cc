@@ -0,0 +1,104 @@
+#include <deal.II/base/exceptions.h>
+
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "parameters.h"
+
+// Expand the sweep for filter_model and check that it has n_runs different
+// runs which only vary the parameters in the sweep lists and which each have
+// their own noise stream.
+bool check_sweep(POD::NavierStokes::Parameters parameters,
+                 const POD::FilterModel        filter_model,
+                 const unsigned int            n_runs)
+{
+  parameters.filter_model = filter_model;
+  const std::vector<POD::NavierStokes::Parameters> runs
+    = parameters.expand_sweep();
+  if (runs.size() != n_runs)
+    {
+      return false;
+    }
+
+  std::set<std::tuple<double, double, unsigned int, double, double>> points;
+  std::set<unsigned int> noise_streams;
+  for (const POD::NavierStokes::Parameters &run : runs)
+    {
+      if (run.is_sweep() or run.filter_model != filter_model)
+        {
+          return false;
+        }
+      points.insert(std::make_tuple(run.reynolds_n, run.filter_radius,
+                                    run.cutoff_n, run.lavrentiev_parameter,
+                                    run.relaxation_parameter));
+      noise_streams.insert(run.noise_stream);
+    }
+  return points.size() == n_runs and noise_streams.size() == n_runs
+         and *noise_streams.begin() == parameters.noise_stream;
+}
+
+
+int main()
+{
+  using namespace POD;
+
+  NavierStokes::Parameters parameters {};
+  parameters.reynolds_n = 100.0;
+  parameters.filter_radius = 0.0;
+  parameters.cutoff_n = 3;
+  parameters.lavrentiev_parameter = 0.1;
+  parameters.relaxation_parameter = 0.5;
+  parameters.noise_stream = 7;
+  parameters.sweep_reynolds_n = {100.0, 200.0};
+  parameters.sweep_filter_radius = {0.0, 0.01, 0.02};
+  parameters.sweep_cutoff_n = {2, 4};
+  parameters.sweep_lavrentiev_parameter = {0.1, 0.2};
+  parameters.sweep_relaxation_parameter = {0.25, 0.5};
+  if (!parameters.is_sweep())
+    {
+      return 1;
+    }
+
+  // each model only varies the parameters it uses (and the Reynolds number)
+  if (!check_sweep(parameters, FilterModel::Differential, 2*3)
+      or !check_sweep(parameters, FilterModel::L2Projection, 2*2)
+      or !check_sweep(parameters, FilterModel::PostL2ProjectionFilter, 2*2)
+      or !check_sweep(parameters, FilterModel::LerayHybrid, 2*3*2)
+      or !check_sweep(parameters, FilterModel::PostDifferentialFilter, 2*3)
+      or !check_sweep(parameters, FilterModel::PostDifferentialFilterRelax,
+                      2*3*2)
+      or !check_sweep(parameters, FilterModel::ADLavrentiev, 2*3*2))
+    {
+      return 1;
+    }
+
+  // the parameters that are not varied keep their values
+  parameters.filter_model = FilterModel::Differential;
+  for (const NavierStokes::Parameters &run : parameters.expand_sweep())
+    {
+      if (run.cutoff_n != 3 or run.lavrentiev_parameter != 0.1
+          or run.relaxation_parameter != 0.5)
+        {
+          return 1;
+        }
+    }
+
+  // a repeated value would make two runs write the same file
+  parameters.sweep_reynolds_n = {100.0, 200.0, 100.0};
+  bool threw = false;
+  try
+    {
+      parameters.expand_sweep();
+    }
+  catch (const dealii::ExceptionBase &)
+    {
+      threw = true;
+    }
+  if (!threw)
+    {
+      return 1;
+    }
+
+  return 0;
+}
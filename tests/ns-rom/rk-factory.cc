@@ -0,0 +1,131 @@
+#include <deal.II/base/exceptions.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/identity_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <string>
+#include <vector>
+
+#include "parameters.h"
+#include "rk_factory.h"
+
+// Return true if rk_factory rejects the parameters. The mass matrix is the
+// identity times mass_scale.
+bool is_rejected(const POD::NavierStokes::Parameters &parameters,
+                 const double mass_scale = 1.0)
+{
+  using namespace dealii;
+
+  constexpr unsigned int n_pod_dofs {3};
+  FullMatrix<double> mass_matrix(n_pod_dofs);
+  mass_matrix = IdentityMatrix(n_pod_dofs);
+  mass_matrix *= mass_scale;
+  FullMatrix<double> laplace_matrix(mass_matrix);
+  const FullMatrix<double> zero_matrix(n_pod_dofs);
+  const std::vector<FullMatrix<double>> nonlinear_operator
+    (n_pod_dofs, zero_matrix);
+  const Vector<double> mean_contribution(n_pod_dofs);
+  try
+    {
+      POD::NavierStokes::rk_factory
+      (zero_matrix, zero_matrix, laplace_matrix, zero_matrix, mean_contribution,
+       mass_matrix, nonlinear_operator, POD::NavierStokes::ReducedQuadrature(),
+       parameters);
+    }
+  catch (const ExceptionBase &)
+    {
+      return true;
+    }
+  return false;
+}
+
+
+int main()
+{
+  using namespace POD;
+
+  NavierStokes::Parameters parameters {};
+  parameters.reynolds_n = 100.0;
+  parameters.filter_model = FilterModel::ADLavrentiev;
+  parameters.filter_radius = 0.1;
+  parameters.lavrentiev_parameter = 0.01;
+  parameters.filter_mean = true;
+  parameters.time_stepping_method = TimeSteppingMethod::DormandPrince54;
+  parameters.absolute_tolerance = 1.0e-8;
+  parameters.relative_tolerance = 1.0e-8;
+
+  // the adaptive method cannot control the error of a noisy right hand side
+  if (is_rejected(parameters))
+    {
+      return 1;
+    }
+  parameters.noise_multiplier = 1.0e-3;
+  if (!is_rejected(parameters))
+    {
+      return 1;
+    }
+  parameters.time_stepping_method = TimeSteppingMethod::RungeKutta4;
+  if (is_rejected(parameters))
+    {
+      return 1;
+    }
+
+  // the multirate integrator needs an identity mass matrix, which it only
+  // gets for a general mass matrix after folding in the inverse
+  parameters.filter_model = FilterModel::Differential;
+  parameters.noise_multiplier = 0.0;
+  parameters.time_stepping_method = TimeSteppingMethod::Multirate;
+  parameters.multirate_n_slow_modes = 1;
+  parameters.multirate_n_substeps = 2;
+  parameters.pre_invert_mass_matrix = false;
+  if (is_rejected(parameters) or !is_rejected(parameters, 2.0))
+    {
+      return 1;
+    }
+  parameters.pre_invert_mass_matrix = true;
+  if (is_rejected(parameters, 2.0))
+    {
+      return 1;
+    }
+
+  // the implicit integrators need a Jacobian, which the approximate
+  // deconvolution right hand side does not provide
+  parameters.filter_model = FilterModel::ADLavrentiev;
+  parameters.noise_multiplier = 1.0e-3;
+  parameters.time_stepping_method = TimeSteppingMethod::BDF2;
+  parameters.newton_tolerance = 1.0e-10;
+  parameters.max_newton_iterations = 10;
+  if (!is_rejected(parameters))
+    {
+      return 1;
+    }
+  parameters.filter_model = FilterModel::L2Projection;
+  parameters.filter_mean = false;
+  parameters.cutoff_n = 2;
+  if (is_rejected(parameters))
+    {
+      return 1;
+    }
+  parameters.filter_model = FilterModel::ADLavrentiev;
+  parameters.filter_mean = true;
+  parameters.time_stepping_method = TimeSteppingMethod::RungeKutta4;
+
+  // the output name does not depend on the operators
+  if (NavierStokes::get_output_name(parameters, 3)
+      != "pod-ad-lavrentiev-0.01-filter-radius-0.1-noise-multiplier-0.001"
+      "-r-3-Re-100.h5")
+    {
+      return 1;
+    }
+  parameters.filter_model = FilterModel::PostL2ProjectionFilter;
+  parameters.cutoff_n = 2;
+  parameters.filter_mean = false;
+  if (NavierStokes::get_output_name(parameters, 5)
+      != "pod-postfilter-cutoff-n-2-unfiltered-mean-r-5-Re-100.h5")
+    {
+      return 1;
+    }
+
+  return 0;
+}
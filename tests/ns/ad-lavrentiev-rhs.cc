@@ -0,0 +1,111 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/lapack_full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  constexpr double filter_radius {0.2};
+  constexpr double lavrentiev_parameter {0.1};
+  constexpr double reynolds_n {50.0};
+  const ReducedOperators operators(n_pod_dofs);
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const FullMatrix<double> &laplace_matrix = operators.laplace_matrix;
+  const FullMatrix<double> &boundary_matrix = operators.boundary_matrix;
+  const FullMatrix<double> &joint_convection = operators.joint_convection;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  const Vector<double> &solution = operators.solution;
+
+  // compute the right hand side with solves, as it was originally written
+  FullMatrix<double> filter_matrix(mass_matrix);
+  filter_matrix.add(filter_radius*filter_radius, laplace_matrix);
+  filter_matrix.add(-1.0*filter_radius*filter_radius, boundary_matrix);
+  LAPACKFullMatrix<double> factorized_filter_matrix(n_pod_dofs);
+  factorized_filter_matrix = filter_matrix;
+  factorized_filter_matrix.compute_lu_factorization();
+  LAPACKFullMatrix<double> factorized_mass_matrix(n_pod_dofs);
+  factorized_mass_matrix = mass_matrix;
+  factorized_mass_matrix.compute_lu_factorization();
+
+  Vector<double> work0(n_pod_dofs);
+  Vector<double> work1(n_pod_dofs);
+  Vector<double> deconvolved_solution(n_pod_dofs);
+  mass_matrix.vmult(work1, solution);
+  mass_matrix.vmult(deconvolved_solution, work1);
+  filter_matrix.vmult(work0, work1);
+  deconvolved_solution.add(lavrentiev_parameter, work0);
+  factorized_filter_matrix.apply_lu_factorization(deconvolved_solution, false);
+
+  Vector<double> expected(mean_contribution);
+  joint_convection.vmult_add(expected, deconvolved_solution);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      nonlinear_operator[i].vmult(work0, deconvolved_solution);
+      expected[i] -= deconvolved_solution*work0;
+    }
+  factorized_mass_matrix.apply_lu_factorization(expected, false);
+  factorized_filter_matrix.apply_lu_factorization(expected, false);
+  laplace_matrix.vmult(work0, solution);
+  expected.add(-1.0/reynolds_n, work0);
+  boundary_matrix.vmult(work0, solution);
+  expected.add(1.0/reynolds_n, work0);
+  factorized_mass_matrix.apply_lu_factorization(expected, false);
+
+  std::unique_ptr<AD::FilterBase> ad_filter
+  (new AD::LavrentievFilter(mass_matrix, laplace_matrix, boundary_matrix,
+                            filter_radius, 0.0, lavrentiev_parameter));
+  AD::FilterRHS rhs_function
+  (mass_matrix, boundary_matrix, laplace_matrix, joint_convection,
+   nonlinear_operator, mean_contribution, reynolds_n, std::move(ad_filter));
+  Vector<double> result(n_pod_dofs);
+  rhs_function.apply(result, solution);
+  result -= expected;
+  if (result.linfty_norm() > 1e-12*expected.linfty_norm())
+    {
+      return 1;
+    }
+
+  // the noise only depends on the key and the number of evaluations
+  AD::LavrentievFilter filter_0(mass_matrix, laplace_matrix, boundary_matrix,
+                                filter_radius, 1e-2, lavrentiev_parameter, 0);
+  AD::LavrentievFilter filter_1(mass_matrix, laplace_matrix, boundary_matrix,
+                                filter_radius, 1e-2, lavrentiev_parameter, 0);
+  AD::LavrentievFilter filter_2(mass_matrix, laplace_matrix, boundary_matrix,
+                                filter_radius, 1e-2, lavrentiev_parameter, 1);
+  AD::LavrentievFilter filter_3(mass_matrix, laplace_matrix, boundary_matrix,
+                                filter_radius, 1e-2, lavrentiev_parameter, 0, 1);
+  Vector<double> result_0(n_pod_dofs);
+  Vector<double> result_1(n_pod_dofs);
+  Vector<double> result_2(n_pod_dofs);
+  Vector<double> result_3(n_pod_dofs);
+  filter_0.apply_inverse(result_0, solution);
+  filter_0.apply_inverse(result_0, solution);
+  filter_1.apply_inverse(result_1, solution);
+  filter_2.apply_inverse(result_2, solution);
+  filter_3.apply_inverse(result_3, solution);
+  // a different evaluation, stream or substream gives different noise
+  if (result_0 == result_1 or result_1 == result_2 or result_1 == result_3)
+    {
+      return 1;
+    }
+  filter_1.apply_inverse(result_1, solution);
+  if (!(result_0 == result_1))
+    {
+      return 1;
+    }
+
+  return 0;
+}
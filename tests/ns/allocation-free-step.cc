@@ -0,0 +1,170 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/ode/ode.h>
+
+#include "reduced-operators.h"
+
+// Count every heap allocation. deal.II allocates vector storage with
+// posix_memalign rather than operator new, so replace the C allocation
+// functions (which operator new also calls) with counting wrappers around the
+// glibc implementations.
+namespace
+{
+  std::atomic<unsigned long int> n_allocations {0};
+}
+
+extern "C"
+{
+  void *__libc_malloc(std::size_t size);
+  void *__libc_calloc(std::size_t n_elements, std::size_t size);
+  void *__libc_realloc(void *pointer, std::size_t size);
+  void *__libc_memalign(std::size_t alignment, std::size_t size);
+
+  void *malloc(std::size_t size) noexcept
+  {
+    ++n_allocations;
+    return __libc_malloc(size);
+  }
+
+  void *calloc(std::size_t n_elements, std::size_t size) noexcept
+  {
+    ++n_allocations;
+    return __libc_calloc(n_elements, size);
+  }
+
+  void *realloc(void *pointer, std::size_t size) noexcept
+  {
+    ++n_allocations;
+    return __libc_realloc(pointer, size);
+  }
+
+  int posix_memalign(void **pointer, std::size_t alignment,
+                     std::size_t size) noexcept
+  {
+    ++n_allocations;
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer == nullptr ? ENOMEM : 0;
+  }
+
+  void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+  {
+    ++n_allocations;
+    return __libc_memalign(alignment, size);
+  }
+
+  void *memalign(std::size_t alignment, std::size_t size) noexcept
+  {
+    ++n_allocations;
+    return __libc_memalign(alignment, size);
+  }
+}
+
+
+// Take one step to set everything up and then check that the next few steps
+// do not allocate.
+bool is_allocation_free(POD::ODE::RungeKuttaBase<double> &rk_method,
+                        const dealii::Vector<double> &initial_condition)
+{
+  dealii::Vector<double> solution(initial_condition);
+  dealii::Vector<double> old_solution(initial_condition);
+  constexpr double time_step {1.0e-3};
+  rk_method.step(time_step, old_solution, solution);
+
+  const unsigned long int n_initial_allocations = n_allocations;
+  for (unsigned int step_n = 0; step_n < 10; ++step_n)
+    {
+      old_solution = solution;
+      rk_method.step(time_step, old_solution, solution);
+    }
+  return n_allocations == n_initial_allocations;
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  const ReducedOperators operators(n_pod_dofs, 0.1, 1.0, 0.0);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const FullMatrix<double> &laplace_matrix = operators.laplace_matrix;
+  const FullMatrix<double> &boundary_matrix = operators.boundary_matrix;
+  const FullMatrix<double> &joint_convection = operators.joint_convection;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  const Vector<double> &initial_condition = operators.solution;
+
+  // make sure that the allocations made by deal.II are counted
+  {
+    const unsigned long int n_initial_allocations = n_allocations;
+    const Vector<double> vector(100);
+    const std::unique_ptr<double> pointer(new double(vector.size()));
+    if (n_allocations < n_initial_allocations + 2)
+      {
+        return 1;
+      }
+  }
+
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>
+     (new PlainRHS<double>(linear_operator, mass_matrix, nonlinear_operator,
+                           mean_contribution)));
+    if (!is_allocation_free(rk_method, initial_condition))
+      {
+        return 1;
+      }
+  }
+
+  {
+    ODE::RungeKutta4PostFilter<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>
+     (new PlainRHS<double>(linear_operator, mass_matrix, nonlinear_operator,
+                           mean_contribution)),
+     std::unique_ptr<ODE::OperatorBase<double>>
+     (new PostDifferentialFilter<double>(mass_matrix, laplace_matrix,
+                                         boundary_matrix, 0.1)));
+    if (!is_allocation_free(rk_method, initial_condition))
+      {
+        return 1;
+      }
+  }
+
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>
+     (new PODDifferentialFilterRHS(linear_operator, mass_matrix,
+                                   boundary_matrix, laplace_matrix,
+                                   nonlinear_operator, mean_contribution, 0.1)));
+    if (!is_allocation_free(rk_method, initial_condition))
+      {
+        return 1;
+      }
+  }
+
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>
+     (new L2ProjectionFilterRHS(linear_operator, mass_matrix, joint_convection,
+                                nonlinear_operator, mean_contribution, 3)));
+    if (!is_allocation_free(rk_method, initial_condition))
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/ode/ode.h>
+
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  constexpr unsigned int n_members {5};
+  const ReducedOperators operators(n_pod_dofs, 1.0, 4.0);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  FullMatrix<double> ensemble_solution(n_pod_dofs, n_members);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+        {
+          ensemble_solution(i, member_n) = std::cos(double(i + 2*member_n));
+        }
+    }
+
+  // advance the ensemble together and each member on its own
+  constexpr double time_step {1.0e-2};
+  ODE::EnsembleRungeKutta4 ensemble_rk_method
+  (std::unique_ptr<ODE::EnsembleOperatorBase>
+   (new EnsemblePlainRHS(linear_operator, mass_matrix, nonlinear_operator,
+                         mean_contribution)));
+  ODE::RungeKutta4<double> rk_method
+  (std::unique_ptr<ODE::OperatorBase<double>>
+   (new PlainRHS<double>(linear_operator, mass_matrix, nonlinear_operator,
+                         mean_contribution)));
+
+  std::vector<Vector<double>> solutions(n_members, Vector<double>(n_pod_dofs));
+  for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+    {
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          solutions[member_n][i] = ensemble_solution(i, member_n);
+        }
+    }
+
+  FullMatrix<double> ensemble_temp(n_pod_dofs, n_members);
+  Vector<double> temp(n_pod_dofs);
+  for (unsigned int step_n = 0; step_n < 10; ++step_n)
+    {
+      ensemble_rk_method.step(time_step, ensemble_solution, ensemble_temp);
+      ensemble_solution = ensemble_temp;
+      for (auto &solution : solutions)
+        {
+          rk_method.step(time_step, solution, temp);
+          solution = temp;
+        }
+    }
+
+  for (unsigned int member_n = 0; member_n < n_members; ++member_n)
+    {
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          if (std::abs(ensemble_solution(i, member_n) - solutions[member_n][i])
+              > 1e-12*solutions[member_n].linfty_norm())
+            {
+              return 1;
+            }
+        }
+    }
+
+  return 0;
+}
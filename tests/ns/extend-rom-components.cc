@@ -0,0 +1,124 @@
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+
+#include <deal.II/numerics/matrix_tools.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/pod/pod.h>
+
+#include "mesh-fixture.h"
+
+using namespace dealii;
+
+bool are_close(const FullMatrix<double> &a, const FullMatrix<double> &b)
+{
+  FullMatrix<double> difference(a);
+  difference.add(-1.0, b);
+  return difference.linfty_norm() <= 1e-12*std::max(1.0, a.linfty_norm());
+}
+
+
+// Extending ROM components computed with the first few POD vectors must give
+// the components computed with all of them at once.
+int main()
+{
+  using namespace POD;
+
+  constexpr int dim {2};
+  constexpr unsigned int n_pod_dofs {5};
+  constexpr unsigned int n_old_pod_dofs {2};
+  const MeshFixture<dim> mesh;
+  const DoFHandler<dim> &dof_handler = mesh.dof_handler;
+  const Quadrature<dim> &quad = mesh.quad;
+  const SparsityPattern &sparsity_pattern = mesh.sparsity_pattern;
+
+  // the filtered vectors stand in for Leray filtered POD vectors
+  const std::vector<BlockVector<double>> pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 1.0);
+  const std::vector<BlockVector<double>> filtered_pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 2.0);
+  const BlockVector<double> mean_vector = mesh.create_vectors(1, 3.0)[0];
+  const std::vector<BlockVector<double>> old_pod_vectors
+    (pod_vectors.begin(), pod_vectors.begin() + n_old_pod_dofs);
+  const std::vector<BlockVector<double>> old_filtered_pod_vectors
+    (filtered_pod_vectors.begin(),
+     filtered_pod_vectors.begin() + n_old_pod_dofs);
+
+  {
+    SparseMatrix<double> full_mass_matrix(sparsity_pattern);
+    MatrixCreator::create_mass_matrix(dof_handler, quad, full_mass_matrix);
+    FullMatrix<double> expected;
+    create_reduced_matrix(pod_vectors, full_mass_matrix, expected);
+    FullMatrix<double> result;
+    create_reduced_matrix(old_pod_vectors, full_mass_matrix, result);
+    extend_reduced_matrix(pod_vectors, full_mass_matrix, result);
+    if (!are_close(expected, result))
+      {
+        return 1;
+      }
+  }
+
+  {
+    FullMatrix<double> expected;
+    NavierStokes::create_reduced_advective_linearization
+    (dof_handler, sparsity_pattern, quad, mean_vector, pod_vectors, expected);
+    FullMatrix<double> result;
+    NavierStokes::create_reduced_advective_linearization
+    (dof_handler, sparsity_pattern, quad, mean_vector, old_pod_vectors, result);
+    SparseMatrix<double> full_advection(sparsity_pattern);
+    NavierStokes::create_advective_linearization
+    (dof_handler, quad, mean_vector, full_advection);
+    extend_reduced_matrix(pod_vectors, full_advection, result);
+    if (!are_close(expected, result))
+      {
+        return 1;
+      }
+  }
+
+  {
+    FullMatrix<double> expected;
+    NavierStokes::create_reduced_gradient_linearization
+    (dof_handler, quad, mean_vector, pod_vectors, filtered_pod_vectors,
+     expected);
+    FullMatrix<double> result;
+    NavierStokes::create_reduced_gradient_linearization
+    (dof_handler, quad, mean_vector, old_pod_vectors, old_filtered_pod_vectors,
+     result);
+    NavierStokes::extend_reduced_gradient_linearization
+    (dof_handler, quad, mean_vector, pod_vectors, filtered_pod_vectors, result);
+    if (!are_close(expected, result))
+      {
+        return 1;
+      }
+  }
+
+  {
+    std::vector<FullMatrix<double>> expected;
+    NavierStokes::create_reduced_nonlinearity
+    (dof_handler, sparsity_pattern, quad, pod_vectors, filtered_pod_vectors,
+     expected);
+    std::vector<FullMatrix<double>> result;
+    NavierStokes::create_reduced_nonlinearity
+    (dof_handler, sparsity_pattern, quad, old_pod_vectors,
+     old_filtered_pod_vectors, result);
+    NavierStokes::extend_reduced_nonlinearity
+    (dof_handler, quad, pod_vectors, filtered_pod_vectors, result);
+    if (result.size() != n_pod_dofs)
+      {
+        return 1;
+      }
+    for (unsigned int i = 0; i < n_pod_dofs; ++i)
+      {
+        if (!are_close(expected[i], result[i]))
+          {
+            return 1;
+          }
+      }
+  }
+
+  return 0;
+}
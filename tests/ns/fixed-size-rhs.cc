@@ -0,0 +1,74 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/fixed_size.h>
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/ode/ode.h>
+
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  const ReducedOperators operators(n_pod_dofs, 1.0, 4.0);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  Vector<double> solution(operators.solution);
+
+  PlainRHS<double> plain_rhs(linear_operator, mass_matrix, nonlinear_operator,
+                             mean_contribution);
+  PlainRHSFixed<n_pod_dofs> fixed_rhs(linear_operator, mass_matrix,
+                                      nonlinear_operator, mean_contribution);
+
+  Vector<double> expected(n_pod_dofs);
+  Vector<double> result(n_pod_dofs);
+  plain_rhs.apply(expected, solution);
+  fixed_rhs.apply(result, solution);
+  result -= expected;
+  if (result.linfty_norm() > 1e-13*expected.linfty_norm())
+    {
+      return 1;
+    }
+
+  constexpr double time_step {1.0e-2};
+  ODE::RungeKutta4<double> rk_method
+  (std::unique_ptr<ODE::OperatorBase<double>>
+   (new PlainRHS<double>(linear_operator, mass_matrix, nonlinear_operator,
+                         mean_contribution)));
+  std::unique_ptr<ODE::RungeKuttaBase<double>> fixed_rk_method
+    = create_fixed_size_runge_kutta_4(linear_operator, mass_matrix,
+                                      nonlinear_operator, mean_contribution);
+
+  Vector<double> fixed_solution(solution);
+  Vector<double> temp(n_pod_dofs);
+  for (unsigned int step_n = 0; step_n < 10; ++step_n)
+    {
+      rk_method.step(time_step, solution, temp);
+      solution = temp;
+      fixed_rk_method->step(time_step, fixed_solution, temp);
+      fixed_solution = temp;
+    }
+  fixed_solution -= solution;
+  if (fixed_solution.linfty_norm() > 1e-12*solution.linfty_norm())
+    {
+      return 1;
+    }
+
+  if (has_fixed_size_kernels(7) or not has_fixed_size_kernels(n_pod_dofs))
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {5};
+  ReducedOperators operators(n_pod_dofs);
+  FullMatrix<double> &linear_operator = operators.linear_operator;
+  FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  FullMatrix<double> &joint_convection = operators.joint_convection;
+  std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  Vector<double> &mean_contribution = operators.mean_contribution;
+  Vector<double> &solution = operators.solution;
+
+  PlainRHS<double> plain_rhs(linear_operator, mass_matrix, nonlinear_operator,
+                             mean_contribution);
+
+  FullMatrix<double> folded_mass_matrix(mass_matrix);
+  FullMatrix<double> folded_linear_operator(linear_operator);
+  FullMatrix<double> folded_joint_convection(joint_convection);
+  Vector<double> folded_mean_contribution(mean_contribution);
+  std::vector<FullMatrix<double>> folded_nonlinear_operator(nonlinear_operator);
+  fold_inverse_mass_matrix(folded_mass_matrix, folded_linear_operator,
+                           folded_joint_convection, folded_mean_contribution,
+                           folded_nonlinear_operator);
+  if (!is_identity(folded_mass_matrix))
+    {
+      return 1;
+    }
+
+  // M (M^{-1} J) = J
+  FullMatrix<double> product(n_pod_dofs);
+  mass_matrix.mmult(product, folded_joint_convection);
+  product.add(-1.0, joint_convection);
+  if (product.linfty_norm() > 1e-13)
+    {
+      return 1;
+    }
+
+  PlainRHS<double> folded_rhs(folded_linear_operator, folded_mass_matrix,
+                              folded_nonlinear_operator,
+                              folded_mean_contribution);
+  Vector<double> expected(n_pod_dofs);
+  Vector<double> result(n_pod_dofs);
+  plain_rhs.apply(expected, solution);
+  folded_rhs.apply(result, solution);
+  result -= expected;
+  if (result.linfty_norm() > 1e-13*expected.linfty_norm())
+    {
+      return 1;
+    }
+
+  // a mass matrix that is nearly the identity is replaced, and nothing else
+  // changes.
+  FullMatrix<double> near_identity(n_pod_dofs);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      near_identity(i, i) = 1.0 + 1e-14;
+    }
+  const FullMatrix<double> original_linear_operator(linear_operator);
+  fold_inverse_mass_matrix(near_identity, linear_operator, joint_convection,
+                           mean_contribution, nonlinear_operator);
+  linear_operator.add(-1.0, original_linear_operator);
+  if (!is_identity(near_identity) or linear_operator.linfty_norm() != 0.0)
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+
+#include <deal.II-pod/ns/hyper_reduction.h>
+#include <deal.II-pod/ns/ns.h>
+
+#include "mesh-fixture.h"
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD::NavierStokes;
+
+  constexpr int dim {2};
+  constexpr unsigned int n_pod_dofs {4};
+  const MeshFixture<dim> mesh;
+  const std::vector<BlockVector<double>> pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 1.0);
+
+  std::vector<FullMatrix<double>> nonlinear_operator;
+  create_reduced_nonlinearity_block(mesh.dof_handler, mesh.quad, pod_vectors,
+                                    pod_vectors, pod_vectors,
+                                    nonlinear_operator);
+
+  // with every cell weight equal to one the reduced quadrature rule is the
+  // full quadrature rule, so the two right hand sides must agree.
+  Vector<double> cell_weights(mesh.triangulation.n_active_cells());
+  cell_weights = 1.0;
+  ReducedQuadrature reduced_quadrature;
+  create_reduced_quadrature(mesh.dof_handler, mesh.quad, pod_vectors,
+                            cell_weights, reduced_quadrature);
+  if (reduced_quadrature.n_points()
+      != mesh.triangulation.n_active_cells()*mesh.quad.size())
+    {
+      return 1;
+    }
+
+  const ReducedOperators operators(n_pod_dofs);
+  PlainRHS<double> plain_rhs(operators.linear_operator, operators.mass_matrix,
+                             nonlinear_operator, operators.mean_contribution);
+  HyperReducedRHS hyper_reduced_rhs(operators.linear_operator,
+                                    operators.mass_matrix, reduced_quadrature,
+                                    operators.mean_contribution);
+
+  Vector<double> expected(n_pod_dofs);
+  Vector<double> result(n_pod_dofs);
+  plain_rhs.apply(expected, operators.solution);
+  hyper_reduced_rhs.apply(result, operators.solution);
+  result -= expected;
+  if (result.linfty_norm() > 1e-12*expected.linfty_norm())
+    {
+      return 1;
+    }
+
+  return 0;
+}
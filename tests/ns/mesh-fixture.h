@@ -0,0 +1,70 @@
+#ifndef dealii__rom_tests_ns_mesh_fixture_h
+#define dealii__rom_tests_ns_mesh_fixture_h
+#include <deal.II/base/quadrature_lib.h>
+
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/fe/fe_q.h>
+
+#include <deal.II/grid/grid_generator.h>
+#include <deal.II/grid/tria.h>
+
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+#include <cmath>
+#include <vector>
+
+// A small mesh of the unit square with a scalar quadratic element, for the
+// tests of the functions that assemble reduced operators.
+template<int dim>
+struct MeshFixture
+{
+  MeshFixture()
+    : fe(2),
+      dof_handler(triangulation),
+      quad(4)
+  {
+    dealii::GridGenerator::hyper_cube(triangulation);
+    triangulation.refine_global(2);
+    dof_handler.distribute_dofs(fe);
+
+    dealii::DynamicSparsityPattern d_sparsity(dof_handler.n_dofs());
+    dealii::DoFTools::make_sparsity_pattern(dof_handler, d_sparsity);
+    sparsity_pattern.copy_from(d_sparsity);
+  }
+
+  /*
+   * Smooth, linearly independent velocity fields, with one block per
+   * component (like the POD vectors). Different offsets give different
+   * fields.
+   */
+  std::vector<dealii::BlockVector<double>>
+  create_vectors(const unsigned int n_vectors, const double offset) const
+  {
+    const unsigned int n_dofs = dof_handler.n_dofs();
+    std::vector<dealii::BlockVector<double>> vectors;
+    for (unsigned int vector_n = 0; vector_n < n_vectors; ++vector_n)
+      {
+        vectors.emplace_back(dim, n_dofs);
+        for (unsigned int dim_n = 0; dim_n < dim; ++dim_n)
+          {
+            for (unsigned int i = 0; i < n_dofs; ++i)
+              {
+                vectors[vector_n].block(dim_n)[i]
+                  = std::sin(offset + (vector_n + 1.0)*(i + 1.0)/(dim_n + 2.0));
+              }
+          }
+      }
+    return vectors;
+  }
+
+  dealii::Triangulation<dim> triangulation;
+  dealii::FE_Q<dim> fe;
+  dealii::DoFHandler<dim> dof_handler;
+  dealii::QGauss<dim> quad;
+  dealii::SparsityPattern sparsity_pattern;
+};
+#endif
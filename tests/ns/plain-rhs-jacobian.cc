@@ -0,0 +1,116 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <vector>
+
+#include <deal.II-pod/ns/hyper_reduction.h>
+#include <deal.II-pod/ns/ns.h>
+
+#include "reduced-operators.h"
+
+using namespace dealii;
+
+// Compare the Jacobian against centered differences, which are exact (up to
+// roundoff) for a quadratic right hand side.
+template<typename RHS>
+bool is_jacobian(RHS &rhs_function, const Vector<double> &solution)
+{
+  const unsigned int n_pod_dofs = solution.size();
+  FullMatrix<double> jacobian;
+  rhs_function.compute_jacobian(jacobian, solution);
+
+  constexpr double h {1.0e-3};
+  Vector<double> perturbed_solution(solution);
+  Vector<double> forward(n_pod_dofs);
+  Vector<double> backward(n_pod_dofs);
+  for (unsigned int j = 0; j < n_pod_dofs; ++j)
+    {
+      perturbed_solution[j] = solution[j] + h;
+      rhs_function.apply(forward, perturbed_solution);
+      perturbed_solution[j] = solution[j] - h;
+      rhs_function.apply(backward, perturbed_solution);
+      perturbed_solution[j] = solution[j];
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          const double difference = (forward[i] - backward[i])/(2.0*h);
+          if (std::abs(jacobian(i, j) - difference)
+              > 1.0e-8*(1.0 + std::abs(difference)))
+            {
+              return false;
+            }
+        }
+    }
+  return true;
+}
+
+
+int main()
+{
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {5};
+  const ReducedOperators operators(n_pod_dofs);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  const Vector<double> &solution = operators.solution;
+
+  for (const bool symmetric_nonlinearity : {false, true})
+    {
+      PlainRHS<double> rhs_function(linear_operator, mass_matrix,
+                                    nonlinear_operator, mean_contribution,
+                                    symmetric_nonlinearity);
+      if (!is_jacobian(rhs_function, solution))
+        {
+          return 1;
+        }
+    }
+
+  PODDifferentialFilterRHS differential_rhs
+  (linear_operator, mass_matrix, operators.boundary_matrix,
+   operators.laplace_matrix, nonlinear_operator, mean_contribution, 0.2);
+  if (!is_jacobian(differential_rhs, solution))
+    {
+      return 1;
+    }
+
+  L2ProjectionFilterRHS l2_projection_rhs
+  (linear_operator, mass_matrix, operators.joint_convection,
+   nonlinear_operator, mean_contribution, 2);
+  if (!is_jacobian(l2_projection_rhs, solution))
+    {
+      return 1;
+    }
+
+  // the Jacobian only depends on the layout of the reduced quadrature rule,
+  // so any values will do
+  constexpr unsigned int dim {2};
+  constexpr unsigned int n_points {3};
+  ReducedQuadrature reduced_quadrature(dim, n_pod_dofs, n_points);
+  for (unsigned int j = 0; j < n_pod_dofs; ++j)
+    {
+      for (unsigned int i = 0; i < n_points*dim; ++i)
+        {
+          reduced_quadrature.values(i, j) = std::sin(1.0 + 2.0*i + j);
+        }
+      for (unsigned int i = 0; i < n_points*dim*dim; ++i)
+        {
+          reduced_quadrature.gradients(i, j) = std::cos(2.0 + i + 3.0*j);
+        }
+    }
+  for (unsigned int point_n = 0; point_n < n_points; ++point_n)
+    {
+      reduced_quadrature.weights[point_n] = 1.0 + point_n;
+    }
+  HyperReducedRHS hyper_reduced_rhs(linear_operator, mass_matrix,
+                                    reduced_quadrature, mean_contribution);
+  if (!is_jacobian(hyper_reduced_rhs, solution))
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <deal.II/base/exceptions.h>
+
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/ode/ode.h>
+
+#include "reduced-operators.h"
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  constexpr unsigned int n_slow {2};
+  const ReducedOperators operators(n_pod_dofs, 1.0, 1.0, 0.0);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  const Vector<double> &slow_solution = operators.solution;
+  Vector<double> fast_solution(n_pod_dofs);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      fast_solution[i] = std::sin(3.0*i);
+    }
+
+  // the fast rows of f at (slow coefficients of slow_solution, fast
+  // coefficients of fast_solution)
+  Vector<double> combined_solution(fast_solution);
+  for (unsigned int i = 0; i < n_slow; ++i)
+    {
+      combined_solution[i] = slow_solution[i];
+    }
+
+  for (const bool symmetric_nonlinearity : {false, true})
+    {
+      PartitionedPlainRHS rhs_function(linear_operator, mass_matrix,
+                                       nonlinear_operator, mean_contribution,
+                                       symmetric_nonlinearity);
+      Vector<double> expected(n_pod_dofs);
+      rhs_function.apply(expected, combined_solution);
+
+      rhs_function.freeze_slow_part(slow_solution, n_slow);
+      Vector<double> result(n_pod_dofs);
+      rhs_function.apply_fast_part(result, fast_solution);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          // the slow rows are not written
+          const double difference
+            = i < n_slow ? result[i] : result[i] - expected[i];
+          if (std::abs(difference) > 1.0e-12*(1.0 + std::abs(expected[i])))
+            {
+              return 1;
+            }
+        }
+    }
+
+  // the partitioned right hand side needs an identity mass matrix and the
+  // multirate integrator needs a partitioned right hand side, so both fail
+  // when they are built rather than on the first step
+  {
+    const ReducedOperators general_operators(n_pod_dofs);
+    bool rejected = false;
+    try
+      {
+        PartitionedPlainRHS
+        (general_operators.linear_operator, general_operators.mass_matrix,
+         general_operators.nonlinear_operator,
+         general_operators.mean_contribution);
+      }
+    catch (const ExceptionBase &)
+      {
+        rejected = true;
+      }
+    if (!rejected)
+      {
+        return 1;
+      }
+  }
+  {
+    bool rejected = false;
+    try
+      {
+        POD::ODE::MultirateRungeKutta
+        (std::unique_ptr<POD::ODE::OperatorBase<double>>
+         (new PlainRHS<double>(linear_operator, mass_matrix,
+                               nonlinear_operator, mean_contribution)),
+         n_slow, 2);
+      }
+    catch (const ExceptionBase &)
+      {
+        rejected = true;
+      }
+    if (!rejected)
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <deal.II-pod/ns/ns.h>
+
+#include "reduced-operators.h"
+
+using namespace dealii;
+
+bool are_close(const Vector<double> &a, const Vector<double> &b,
+               const double tolerance)
+{
+  Vector<double> difference(a);
+  difference -= b;
+  return difference.l2_norm() <= tolerance*a.l2_norm();
+}
+
+
+int main()
+{
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  constexpr double filter_radius {0.5};
+  constexpr double relaxation_parameter {0.25};
+  const ReducedOperators operators(n_pod_dofs);
+  const Vector<double> &src = operators.solution;
+
+  // the differential filter solves (M + r^2 (L - B)) dst = M src
+  Vector<double> filtered(n_pod_dofs);
+  PostDifferentialFilter<double> differential_filter
+  (operators.mass_matrix, operators.laplace_matrix, operators.boundary_matrix,
+   filter_radius);
+  differential_filter.apply(filtered, src);
+  {
+    FullMatrix<double> filter_matrix(operators.mass_matrix);
+    filter_matrix.add(filter_radius*filter_radius, operators.laplace_matrix);
+    filter_matrix.add(-filter_radius*filter_radius, operators.boundary_matrix);
+    Vector<double> residual(n_pod_dofs);
+    Vector<double> expected(n_pod_dofs);
+    filter_matrix.vmult(residual, filtered);
+    operators.mass_matrix.vmult(expected, src);
+    if (!are_close(expected, residual, 1e-12))
+      {
+        return 1;
+      }
+  }
+
+  // a zero radius does not filter
+  {
+    Vector<double> result(n_pod_dofs);
+    PostDifferentialFilter<double>
+    (operators.mass_matrix, operators.laplace_matrix, operators.boundary_matrix,
+     0.0).apply(result, src);
+    if (!are_close(src, result, 1e-12))
+      {
+        return 1;
+      }
+  }
+
+  // the relaxed filter mixes the filtered and unfiltered solutions
+  Vector<double> relaxed(n_pod_dofs);
+  PostDifferentialFilterRelax<double> relax_filter
+  (operators.mass_matrix, operators.laplace_matrix, operators.boundary_matrix,
+   filter_radius, relaxation_parameter);
+  relax_filter.apply(relaxed, src);
+  {
+    Vector<double> expected(n_pod_dofs);
+    expected.equ(1.0 - relaxation_parameter, filtered,
+                 relaxation_parameter, src);
+    if (!are_close(expected, relaxed, 1e-12))
+      {
+        return 1;
+      }
+  }
+
+  // the L2 projection filter drops the modes past the cutoff
+  constexpr unsigned int cutoff_n {4};
+  Vector<double> projected(n_pod_dofs);
+  PostL2ProjectionFilter<double>(cutoff_n).apply(projected, src);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      if (projected[i] != (i < cutoff_n ? src[i] : 0.0))
+        {
+          return 1;
+        }
+    }
+
+  // the single precision filters agree with the double precision ones to
+  // single precision
+  const Vector<float> float_src(src);
+  Vector<float> float_result(n_pod_dofs);
+  PostDifferentialFilter<float>
+  (operators.mass_matrix, operators.laplace_matrix, operators.boundary_matrix,
+   filter_radius).apply(float_result, float_src);
+  if (!are_close(filtered, Vector<double>(float_result), 1e-5))
+    {
+      return 1;
+    }
+  PostDifferentialFilterRelax<float>
+  (operators.mass_matrix, operators.laplace_matrix, operators.boundary_matrix,
+   filter_radius, relaxation_parameter).apply(float_result, float_src);
+  if (!are_close(relaxed, Vector<double>(float_result), 1e-5))
+    {
+      return 1;
+    }
+  PostL2ProjectionFilter<float>(cutoff_n).apply(float_result, float_src);
+  if (!are_close(projected, Vector<double>(float_result), 1e-7))
+    {
+      return 1;
+    }
+
+  return 0;
+}
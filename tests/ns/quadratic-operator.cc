@@ -0,0 +1,116 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <vector>
+
+#include <deal.II-pod/ns/quadratic_operator.h>
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {7};
+  std::vector<FullMatrix<double>> nonlinear_operator;
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      nonlinear_operator.emplace_back(n_pod_dofs);
+      for (unsigned int j = 0; j < n_pod_dofs; ++j)
+        {
+          for (unsigned int k = 0; k < n_pod_dofs; ++k)
+            {
+              nonlinear_operator[i](j, k) = std::sin(1.0 + i + 2.0*j + 3.0*k*k);
+            }
+        }
+    }
+
+  Vector<double> a(n_pod_dofs);
+  Vector<double> b(n_pod_dofs);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      a[i] = std::cos(double(i));
+      b[i] = 1.0/(1.0 + i);
+    }
+
+  // reference values computed slice by slice
+  Vector<double> expected_ab(n_pod_dofs);
+  Vector<double> expected_aa(n_pod_dofs);
+  Vector<double> temp(n_pod_dofs);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      nonlinear_operator[i].vmult(temp, b);
+      expected_ab[i] = temp*a;
+      nonlinear_operator[i].vmult(temp, a);
+      expected_aa[i] = temp*a;
+    }
+
+  const QuadraticOperator<double> full(nonlinear_operator);
+  const QuadraticOperator<double> symmetric
+  (nonlinear_operator, QuadraticOperator<double>::Storage::symmetric);
+
+  Vector<double> result(n_pod_dofs);
+  full.vmult_add(result, a, b);
+  result -= expected_ab;
+  if (result.linfty_norm() > 1e-13)
+    {
+      return 1;
+    }
+
+  result = 0.0;
+  full.vmult_add(result, a, -2.0);
+  result.add(2.0, expected_aa);
+  if (result.linfty_norm() > 1e-13)
+    {
+      return 1;
+    }
+
+  result = 0.0;
+  symmetric.vmult_add(result, a);
+  result -= expected_aa;
+  if (result.linfty_norm() > 1e-13)
+    {
+      return 1;
+    }
+
+  // only use the leading entries of a
+  constexpr unsigned int n_leading {3};
+  Vector<double> leading_a(a);
+  for (unsigned int i = n_leading; i < n_pod_dofs; ++i)
+    {
+      leading_a[i] = 0.0;
+    }
+  Vector<double> expected_leading(n_pod_dofs);
+  full.vmult_add(expected_leading, leading_a, b);
+  result = 0.0;
+  full.vmult_add_leading(result, a, b, n_leading);
+  result -= expected_leading;
+  if (result.linfty_norm() > 1e-13)
+    {
+      return 1;
+    }
+
+  // only use (and write) the trailing entries
+  Vector<double> trailing_a(a);
+  for (unsigned int i = 0; i < n_leading; ++i)
+    {
+      trailing_a[i] = 0.0;
+    }
+  Vector<double> expected_trailing(n_pod_dofs);
+  full.vmult_add(expected_trailing, trailing_a);
+  for (const QuadraticOperator<double> *nonlinearity : {&full, &symmetric})
+    {
+      result = 0.0;
+      nonlinearity->vmult_add_trailing(result, a, n_leading);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          if (std::abs(result[i] - (i < n_leading ? 0.0 : expected_trailing[i]))
+              > 1e-13)
+            {
+              return 1;
+            }
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef dealii__rom_tests_ns_reduced_operators_h
+#define dealii__rom_tests_ns_reduced_operators_h
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <vector>
+
+// Dense, deterministic stand-ins for the reduced Navier-Stokes operators. The
+// mass matrix is mass_diagonal times the identity plus a nonsymmetric
+// perturbation of size mass_perturbation; every other operator (but the
+// Laplace and boundary matrices) is multiplied by scale.
+struct ReducedOperators
+{
+  ReducedOperators(const unsigned int n_pod_dofs,
+                   const double scale = 1.0,
+                   const double mass_diagonal = 3.0,
+                   const double mass_perturbation = 0.25)
+    : linear_operator(n_pod_dofs),
+      mass_matrix(n_pod_dofs),
+      laplace_matrix(n_pod_dofs),
+      boundary_matrix(n_pod_dofs),
+      joint_convection(n_pod_dofs),
+      nonlinear_operator(n_pod_dofs, dealii::FullMatrix<double>(n_pod_dofs)),
+      mean_contribution(n_pod_dofs),
+      solution(n_pod_dofs)
+  {
+    for (unsigned int i = 0; i < n_pod_dofs; ++i)
+      {
+        mean_contribution[i] = scale*std::sin(2.0 + i);
+        solution[i] = std::cos(double(i));
+        mass_matrix(i, i) = mass_diagonal;
+        laplace_matrix(i, i) = 1.0 + i;
+        boundary_matrix(i, i) = 0.1;
+        for (unsigned int j = 0; j < n_pod_dofs; ++j)
+          {
+            linear_operator(i, j) = scale*std::cos(1.0 + 3.0*i + j);
+            mass_matrix(i, j) += mass_perturbation*std::sin(1.0 + i*j + j);
+            joint_convection(i, j) = scale*std::sin(2.0*i + j);
+            for (unsigned int k = 0; k < n_pod_dofs; ++k)
+              {
+                nonlinear_operator[i](j, k)
+                  = scale*std::sin(1.0 + i + 2.0*j + 3.0*k*k);
+              }
+          }
+      }
+  }
+
+  dealii::FullMatrix<double> linear_operator;
+  dealii::FullMatrix<double> mass_matrix;
+  dealii::FullMatrix<double> laplace_matrix;
+  dealii::FullMatrix<double> boundary_matrix;
+  dealii::FullMatrix<double> joint_convection;
+  std::vector<dealii::FullMatrix<double>> nonlinear_operator;
+  dealii::Vector<double> mean_contribution;
+  dealii::Vector<double> solution;
+};
+#endif
@@ -0,0 +1,137 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+#include <deal.II-pod/ode/ode.h>
+
+#include "reduced-operators.h"
+
+using namespace dealii;
+
+// Round every entry of a matrix to single precision.
+FullMatrix<double> round_to_float(const FullMatrix<double> &matrix)
+{
+  FullMatrix<float> float_matrix;
+  float_matrix = matrix;
+  FullMatrix<double> result;
+  result = float_matrix;
+  return result;
+}
+
+
+int main()
+{
+  using namespace POD;
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {6};
+  const ReducedOperators operators(n_pod_dofs, 0.1, 2.0, 0.1);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  Vector<double> solution(operators.solution);
+
+  // integrate in double, single and mixed precision
+  constexpr double time_step {1.0e-2};
+  constexpr unsigned int n_steps {100};
+  ODE::RungeKutta4<double> rk_method
+  (std::unique_ptr<ODE::OperatorBase<double>>
+   (new PlainRHS<double>(linear_operator, mass_matrix, nonlinear_operator,
+                         mean_contribution)));
+  ODE::RungeKutta4<float> single_rk_method
+  (std::unique_ptr<ODE::OperatorBase<float>>
+   (new PlainRHS<float>(linear_operator, mass_matrix, nonlinear_operator,
+                        mean_contribution)));
+  ODE::RungeKutta4<float> mixed_rk_method
+  (std::unique_ptr<ODE::OperatorBase<float>>
+   (new PlainRHS<float, double>(linear_operator, mass_matrix,
+                                nonlinear_operator, mean_contribution)));
+
+  Vector<float> single_solution(solution);
+  Vector<float> mixed_solution(solution);
+  Vector<double> temp(n_pod_dofs);
+  Vector<float> float_temp(n_pod_dofs);
+  for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+    {
+      rk_method.step(time_step, solution, temp);
+      solution = temp;
+      single_rk_method.step(time_step, single_solution, float_temp);
+      single_solution = float_temp;
+      mixed_rk_method.step(time_step, mixed_solution, float_temp);
+      mixed_solution = float_temp;
+    }
+
+  const double norm = solution.l2_norm();
+  Vector<double> difference(single_solution);
+  difference -= solution;
+  const double single_error = difference.l2_norm()/norm;
+  difference = mixed_solution;
+  difference -= solution;
+  const double mixed_error = difference.l2_norm()/norm;
+  if (single_error > 1e-4 or mixed_error > 1e-4)
+    {
+      return 1;
+    }
+
+  // Evaluate a right hand side whose terms are about 1e5 times larger than
+  // their sum. The single precision operators are exact on float-rounded
+  // operators and inputs, so the mixed precision result may only differ from
+  // the double precision one by the final rounding to float while the single
+  // precision one loses most of its digits to cancellation.
+  const ReducedOperators cancelling(n_pod_dofs, 1.0, 1.0, 0.0);
+  std::vector<FullMatrix<double>> rounded_nonlinear_operator;
+  for (const FullMatrix<double> &matrix : cancelling.nonlinear_operator)
+    {
+      rounded_nonlinear_operator.push_back(round_to_float(matrix));
+    }
+  const FullMatrix<double> rounded_linear_operator
+    = round_to_float(cancelling.linear_operator);
+  Vector<float> float_src(n_pod_dofs);
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      float_src[i] = 100.0*cancelling.solution[i];
+    }
+  const Vector<double> src(float_src);
+
+  Vector<double> cancelled_mean(n_pod_dofs);
+  PlainRHS<double>(rounded_linear_operator, cancelling.mass_matrix,
+                   rounded_nonlinear_operator, Vector<double>(n_pod_dofs))
+  .apply(cancelled_mean, src);
+  cancelled_mean *= -1.0;
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      cancelled_mean[i] += std::sin(0.5 + i);
+    }
+
+  Vector<double> expected(n_pod_dofs);
+  PlainRHS<double>(rounded_linear_operator, cancelling.mass_matrix,
+                   rounded_nonlinear_operator, cancelled_mean)
+  .apply(expected, src);
+  Vector<float> single_result(n_pod_dofs);
+  PlainRHS<float>(rounded_linear_operator, cancelling.mass_matrix,
+                  rounded_nonlinear_operator, cancelled_mean)
+  .apply(single_result, float_src);
+  Vector<float> mixed_result(n_pod_dofs);
+  PlainRHS<float, double>(rounded_linear_operator, cancelling.mass_matrix,
+                          rounded_nonlinear_operator, cancelled_mean)
+  .apply(mixed_result, float_src);
+
+  difference = single_result;
+  difference -= expected;
+  const double single_rhs_error = difference.l2_norm()/expected.l2_norm();
+  difference = mixed_result;
+  difference -= expected;
+  const double mixed_rhs_error = difference.l2_norm()/expected.l2_norm();
+  if (mixed_rhs_error > 1e-6 or mixed_rhs_error*100.0 > single_rhs_error)
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ns/hyper_reduction.h>
+#include <deal.II-pod/ns/ns.h>
+
+#include "mesh-fixture.h"
+#include "reduced-operators.h"
+
+using namespace dealii;
+
+// The implicit-explicit and exponential integrators assume that the right
+// hand side is the sum of its linear and nonlinear parts:
+//
+// apply(src) = get_linear_part()*src + apply_nonlinear_part(src).
+template<typename RHS>
+bool is_split(RHS &rhs_function, const Vector<double> &src)
+{
+  Vector<double> expected(src.size());
+  rhs_function.apply(expected, src);
+
+  Vector<double> result(src.size());
+  Vector<double> nonlinear_part(src.size());
+  rhs_function.get_linear_part().vmult(result, src);
+  rhs_function.apply_nonlinear_part(nonlinear_part, src);
+  result += nonlinear_part;
+
+  result -= expected;
+  return result.l2_norm() <= 1e-12*expected.l2_norm();
+}
+
+
+int main()
+{
+  using namespace POD::NavierStokes;
+
+  constexpr unsigned int n_pod_dofs {4};
+  constexpr double filter_radius {0.2};
+  const ReducedOperators operators(n_pod_dofs);
+  const FullMatrix<double> &linear_operator = operators.linear_operator;
+  const FullMatrix<double> &mass_matrix = operators.mass_matrix;
+  const FullMatrix<double> &laplace_matrix = operators.laplace_matrix;
+  const FullMatrix<double> &boundary_matrix = operators.boundary_matrix;
+  const FullMatrix<double> &joint_convection = operators.joint_convection;
+  const std::vector<FullMatrix<double>> &nonlinear_operator
+    = operators.nonlinear_operator;
+  const Vector<double> &mean_contribution = operators.mean_contribution;
+  const Vector<double> &solution = operators.solution;
+
+  for (const bool symmetric_nonlinearity : {false, true})
+    {
+      PlainRHS<double> plain_rhs(linear_operator, mass_matrix,
+                                 nonlinear_operator, mean_contribution,
+                                 symmetric_nonlinearity);
+      if (!is_split(plain_rhs, solution))
+        {
+          return 1;
+        }
+    }
+
+  L2ProjectionFilterRHS l2_projection_rhs
+  (linear_operator, mass_matrix, joint_convection, nonlinear_operator,
+   mean_contribution, 2);
+  if (!is_split(l2_projection_rhs, solution))
+    {
+      return 1;
+    }
+
+  PODDifferentialFilterRHS differential_rhs
+  (linear_operator, mass_matrix, boundary_matrix, laplace_matrix,
+   nonlinear_operator, mean_contribution, filter_radius);
+  if (!is_split(differential_rhs, solution))
+    {
+      return 1;
+    }
+
+  // without noise the approximate deconvolution right hand side is
+  // deterministic, so the two evaluations see the same filter
+  AD::FilterRHS ad_rhs
+  (mass_matrix, boundary_matrix, laplace_matrix, joint_convection,
+   nonlinear_operator, mean_contribution, 50.0,
+   std::unique_ptr<AD::FilterBase>
+   (new AD::LavrentievFilter(mass_matrix, laplace_matrix, boundary_matrix,
+                             filter_radius, 0.0, 0.1)),
+   false);
+  if (!is_split(ad_rhs, solution))
+    {
+      return 1;
+    }
+
+  // as in hyper-reduced-rhs, weight every cell by one so that the reduced
+  // quadrature rule is the full one
+  constexpr int dim {2};
+  const MeshFixture<dim> mesh;
+  const std::vector<BlockVector<double>> pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 1.0);
+  Vector<double> cell_weights(mesh.triangulation.n_active_cells());
+  cell_weights = 1.0;
+  ReducedQuadrature reduced_quadrature;
+  create_reduced_quadrature(mesh.dof_handler, mesh.quad, pod_vectors,
+                            cell_weights, reduced_quadrature);
+  HyperReducedRHS hyper_reduced_rhs(linear_operator, mass_matrix,
+                                    reduced_quadrature, mean_contribution);
+  if (!is_split(hyper_reduced_rhs, solution))
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,136 @@
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/dofs/dof_tools.h>
+
+#include <deal.II/lac/block_vector.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+#include <deal.II/lac/vector.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <deal.II-pod/ns/ns.h>
+
+#include "mesh-fixture.h"
+
+using namespace dealii;
+
+bool are_close(const FullMatrix<double> &a, const FullMatrix<double> &b)
+{
+  FullMatrix<double> difference(a);
+  difference.add(-1.0, b);
+  return difference.linfty_norm() <= 1e-12*std::max(1.0, a.linfty_norm());
+}
+
+
+// Summing the cell integrals assembled on each subdomain (as every process of
+// compute-pod-matrices does) must give the serial assembly.
+int main()
+{
+  using namespace POD::NavierStokes;
+
+  constexpr int dim {2};
+  constexpr unsigned int n_pod_dofs {4};
+  constexpr unsigned int n_subdomains {3};
+  MeshFixture<dim> mesh;
+  const DoFHandler<dim> &dof_handler = mesh.dof_handler;
+
+  // interleave the subdomains so that every subdomain boundary is interior
+  typename DoFHandler<dim>::active_cell_iterator
+  cell = mesh.dof_handler.begin_active(),
+  endc = mesh.dof_handler.end();
+  for (; cell != endc; ++cell)
+    {
+      cell->set_subdomain_id(cell->active_cell_index() % n_subdomains);
+    }
+
+  std::vector<BlockVector<double>> pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 1.0);
+  const std::vector<BlockVector<double>> filtered_pod_vectors
+    = mesh.create_vectors(n_pod_dofs, 2.0);
+  BlockVector<double> mean_vector = mesh.create_vectors(1, 3.0)[0];
+
+  FullMatrix<double> serial_advection;
+  create_reduced_advective_linearization
+  (dof_handler, mesh.sparsity_pattern, mesh.quad, mean_vector, pod_vectors,
+   serial_advection);
+  FullMatrix<double> serial_gradient;
+  create_reduced_gradient_linearization
+  (dof_handler, mesh.quad, mean_vector, pod_vectors, filtered_pod_vectors,
+   serial_gradient);
+  std::vector<FullMatrix<double>> serial_nonlinearity;
+  create_reduced_nonlinearity
+  (dof_handler, mesh.sparsity_pattern, mesh.quad, pod_vectors,
+   filtered_pod_vectors, serial_nonlinearity);
+  Vector<double> serial_contribution;
+  create_nonlinear_centered_contribution
+  (dof_handler, mesh.sparsity_pattern, mesh.quad, mean_vector, mean_vector,
+   pod_vectors, serial_contribution);
+
+  FullMatrix<double> advection(n_pod_dofs);
+  FullMatrix<double> gradient(n_pod_dofs);
+  std::vector<FullMatrix<double>> nonlinearity
+    (n_pod_dofs, FullMatrix<double>(n_pod_dofs));
+  Vector<double> contribution(n_pod_dofs);
+  for (types::subdomain_id subdomain_id = 0; subdomain_id < n_subdomains;
+       ++subdomain_id)
+    {
+      // the coupling between the degrees of freedom on the subdomain, as in
+      // compute-pod-matrices
+      DynamicSparsityPattern d_sparsity(dof_handler.n_dofs());
+      DoFTools::make_sparsity_pattern(dof_handler, d_sparsity, ConstraintMatrix(),
+                                      true, subdomain_id);
+      SparsityPattern owned_sparsity_pattern;
+      owned_sparsity_pattern.copy_from(d_sparsity);
+
+      FullMatrix<double> partial_advection;
+      create_reduced_advective_linearization
+      (dof_handler, owned_sparsity_pattern, mesh.quad, mean_vector, pod_vectors,
+       partial_advection, subdomain_id);
+      advection.add(1.0, partial_advection);
+
+      FullMatrix<double> partial_gradient;
+      create_reduced_gradient_linearization
+      (dof_handler, mesh.quad, mean_vector, pod_vectors, filtered_pod_vectors,
+       partial_gradient, subdomain_id);
+      gradient.add(1.0, partial_gradient);
+
+      std::vector<FullMatrix<double>> partial_nonlinearity;
+      create_reduced_nonlinearity
+      (dof_handler, owned_sparsity_pattern, mesh.quad, pod_vectors,
+       filtered_pod_vectors, partial_nonlinearity, subdomain_id);
+      for (unsigned int i = 0; i < n_pod_dofs; ++i)
+        {
+          nonlinearity[i].add(1.0, partial_nonlinearity[i]);
+        }
+
+      Vector<double> partial_contribution;
+      create_nonlinear_centered_contribution
+      (dof_handler, owned_sparsity_pattern, mesh.quad, mean_vector, mean_vector,
+       pod_vectors, partial_contribution, subdomain_id);
+      contribution += partial_contribution;
+    }
+
+  if (!are_close(serial_advection, advection)
+      or !are_close(serial_gradient, gradient))
+    {
+      return 1;
+    }
+  for (unsigned int i = 0; i < n_pod_dofs; ++i)
+    {
+      if (!are_close(serial_nonlinearity[i], nonlinearity[i]))
+        {
+          return 1;
+        }
+    }
+  contribution -= serial_contribution;
+  if (contribution.linfty_norm()
+      > 1e-12*std::max(1.0, serial_contribution.linfty_norm()))
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,40 @@
+# Run ns-rom three times with noisy approximate deconvolution: once without
+# interruption, once stopping at a checkpoint, and once resuming from that
+# checkpoint. The resumed run compares its output with the uninterrupted one.
+FILE(REMOVE_RECURSE ${WORK_DIR})
+FILE(MAKE_DIRECTORY ${WORK_DIR})
+FILE(GLOB _DATA "${DATA_DIR}/rom-*.h5")
+FILE(COPY ${_DATA} DESTINATION ${WORK_DIR})
+
+MACRO(RUN_NS_ROM _CHECKPOINT_INTERVAL _CHECKPOINT_STOP_STEP _TEST_OUTPUT
+    _EXPECTED_STATUS)
+  SET(CHECKPOINT_INTERVAL ${_CHECKPOINT_INTERVAL})
+  SET(CHECKPOINT_STOP_STEP ${_CHECKPOINT_STOP_STEP})
+  SET(TEST_OUTPUT ${_TEST_OUTPUT})
+  CONFIGURE_FILE(${SOURCE_DIR}/parameters.prm.in ${WORK_DIR}/parameters.prm
+    @ONLY)
+  EXECUTE_PROCESS(COMMAND ${NS_ROM}
+    WORKING_DIRECTORY ${WORK_DIR}
+    RESULT_VARIABLE _STATUS)
+  IF(NOT "${_STATUS}" STREQUAL "${_EXPECTED_STATUS}")
+    MESSAGE(FATAL_ERROR
+      "ns-rom exited with status ${_STATUS} instead of ${_EXPECTED_STATUS}.")
+  ENDIF()
+ENDMACRO()
+
+RUN_NS_ROM(0 0 false 0)
+FILE(GLOB _OUTPUT "${WORK_DIR}/pod-*.h5")
+LIST(LENGTH _OUTPUT _N_OUTPUTS)
+IF(NOT _N_OUTPUTS EQUAL 1)
+  MESSAGE(FATAL_ERROR "Expected one output file, found: ${_OUTPUT}")
+ENDIF()
+FILE(RENAME ${_OUTPUT} ${WORK_DIR}/test-output.h5)
+
+# ns-rom exits with status 3 when it stops at a checkpoint
+RUN_NS_ROM(100 250 false 3)
+FILE(GLOB _CHECKPOINT "${WORK_DIR}/checkpoint-*.h5")
+IF(NOT _CHECKPOINT)
+  MESSAGE(FATAL_ERROR "The stopped run did not leave a checkpoint.")
+ENDIF()
+
+RUN_NS_ROM(100 0 true 0)
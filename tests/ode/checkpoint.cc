@@ -0,0 +1,122 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "problems.h"
+
+// a problem with a forcing term that depends on the number of previous
+// evaluations (like the noise of the approximate deconvolution models):
+// u' = v + f_n, v' = -u.
+class CountingProblem : public POD::ODE::OperatorBase<double>,
+  public POD::ODE::StatefulOperator
+{
+public:
+  CountingProblem()
+    : n_evaluations {0}
+  {}
+
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = src[1] + 0.1*std::sin(double(n_evaluations));
+    dst[1] = -src[0];
+    ++n_evaluations;
+  }
+
+  virtual void save_state(dealii::Vector<double> &state) const override
+  {
+    state.reinit(1);
+    state[0] = n_evaluations;
+  }
+
+  virtual void load_state(const dealii::Vector<double> &state) override
+  {
+    n_evaluations = static_cast<unsigned int>(state[0]);
+  }
+
+  unsigned int n_evaluations;
+};
+
+
+template<typename Integrator, typename Problem>
+std::unique_ptr<POD::ODE::RungeKuttaBase<double>> create_integrator()
+{
+  return std::unique_ptr<POD::ODE::RungeKuttaBase<double>>
+    (new Integrator(std::unique_ptr<Problem>(new Problem())));
+}
+
+
+// Take n_steps steps, then restart with a new integrator from the saved state
+// and take n_steps more. Return the difference from an uninterrupted run.
+template<typename Integrator, typename Problem>
+double restart_error(const unsigned int n_steps, const double time_step)
+{
+  using namespace dealii;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+
+  Vector<double> solution(initial_condition);
+  Vector<double> temp(2);
+  {
+    std::unique_ptr<POD::ODE::RungeKuttaBase<double>> rk_method
+      = create_integrator<Integrator, Problem>();
+    for (unsigned int step_n = 0; step_n < 2*n_steps; ++step_n)
+      {
+        rk_method->step(time_step, solution, temp);
+        solution = temp;
+      }
+  }
+
+  Vector<double> restarted_solution(initial_condition);
+  Vector<double> state;
+  {
+    std::unique_ptr<POD::ODE::RungeKuttaBase<double>> rk_method
+      = create_integrator<Integrator, Problem>();
+    for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+      {
+        rk_method->step(time_step, restarted_solution, temp);
+        restarted_solution = temp;
+      }
+    rk_method->save_state(state);
+  }
+  {
+    std::unique_ptr<POD::ODE::RungeKuttaBase<double>> rk_method
+      = create_integrator<Integrator, Problem>();
+    rk_method->load_state(state);
+    for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+      {
+        rk_method->step(time_step, restarted_solution, temp);
+        restarted_solution = temp;
+      }
+  }
+
+  restarted_solution -= solution;
+  return restarted_solution.linfty_norm();
+}
+
+
+int main()
+{
+  using namespace POD;
+
+  // explicit methods only carry the state of the right hand side, so the
+  // restarted run must agree exactly.
+  if (restart_error<ODE::RungeKutta4<double>, CountingProblem>(50, 1.0e-2) != 0.0)
+    {
+      return 1;
+    }
+
+  // BDF2 carries its previous solution. The Jacobian is not part of the
+  // state, so the results only agree up to the Newton tolerance.
+  if (restart_error<ODE::BDF2, StiffProblem>(50, 1.0e-2) > 1.0e-9)
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+// a damped oscillator: u' = -u/10 + v, v' = -u - v/10.
+class DampedOscillator : public POD::ODE::OperatorBase<double>
+{
+public:
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = -0.1*src[0] + src[1];
+    dst[1] = -src[0] - 0.1*src[1];
+  }
+};
+
+
+// the solution with u(0) = 1, v(0) = 0.
+double error(const double time, const dealii::Vector<double> &solution)
+{
+  const double decay = std::exp(-0.1*time);
+  return std::max(std::abs(solution[0] - decay*std::cos(time)),
+                  std::abs(solution[1] + decay*std::sin(time)));
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+  constexpr double final_time {10.0};
+  constexpr double tolerance {1.0e-8};
+
+  // advance freely and sample the dense output on a fixed grid.
+  {
+    ODE::DormandPrince54 rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new DampedOscillator()),
+     tolerance, tolerance);
+    rk_method.initialize(0.0, initial_condition, 1.0e-3);
+    Vector<double> output_solution(2);
+    constexpr unsigned int n_outputs {100};
+    for (unsigned int output_n = 1; output_n <= n_outputs; ++output_n)
+      {
+        const double output_time = output_n*final_time/n_outputs;
+        while (rk_method.get_time() < output_time)
+          {
+            rk_method.advance();
+          }
+        rk_method.interpolate(output_time, output_solution);
+        if (error(output_time, output_solution) > 1.0e-6)
+          {
+            return 1;
+          }
+      }
+    // fewer than one step per output
+    if (rk_method.n_accepted_steps() > n_outputs)
+      {
+        return 1;
+      }
+  }
+
+  // step lands exactly on each requested time and gives the same accuracy as
+  // fixed step RK4 with many more steps.
+  {
+    ODE::DormandPrince54 rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new DampedOscillator()),
+     tolerance, tolerance);
+    ODE::RungeKutta4<double> rk4_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new DampedOscillator()));
+    Vector<double> solution(initial_condition);
+    Vector<double> rk4_solution(initial_condition);
+    Vector<double> temp(2);
+    constexpr unsigned int n_rk4_steps {100};
+    for (unsigned int step_n = 1; step_n <= 20; ++step_n)
+      {
+        rk_method.step(0.5, solution, temp);
+        solution = temp;
+        for (unsigned int i = 0; i < n_rk4_steps; ++i)
+          {
+            rk4_method.step(0.5/n_rk4_steps, rk4_solution, temp);
+            rk4_solution = temp;
+          }
+        rk4_solution -= solution;
+        if (error(0.5*step_n, solution) > 1.0e-6
+            or rk4_solution.linfty_norm() > 1.0e-6)
+          {
+            return 1;
+          }
+        rk4_solution += solution;
+      }
+    if (rk_method.n_accepted_steps() > 20*n_rk4_steps/10)
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "split-problem.h"
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+  // y_1(0) = 0 is near the slow manifold of the stiff problem: the order of
+  // ETDRK4 is reduced in a stiff initial layer.
+
+  for (const double stiffness : {3.0, 1.0e4})
+    {
+      Vector<double> reference_solution(initial_condition);
+      {
+        ODE::RungeKutta4<double> rk_method
+        (std::unique_ptr<ODE::OperatorBase<double>>(new SplitProblem(stiffness)));
+        Vector<double> temp(2);
+        for (unsigned int step_n = 0; step_n < 100000; ++step_n)
+          {
+            rk_method.step(1.0e-5, reference_solution, temp);
+            reference_solution = temp;
+          }
+      }
+
+      double errors[2];
+      for (unsigned int refinement_n = 0; refinement_n < 2; ++refinement_n)
+        {
+          ODE::ETDRungeKutta4 rk_method
+          (std::unique_ptr<ODE::OperatorBase<double>>(new SplitProblem(stiffness)));
+          errors[refinement_n] = error(rk_method, 10*(refinement_n + 1),
+                                       initial_condition, reference_solution);
+        }
+
+      if (stiffness == 3.0)
+        {
+          // fourth order convergence
+          if (errors[0]/errors[1] < 12.0)
+            {
+              return 1;
+            }
+        }
+      // the time steps are far beyond the explicit stability limit, but the
+      // linear part is integrated exactly
+      else if (errors[0] > 1.0e-6)
+        {
+          return 1;
+        }
+    }
+
+  return 0;
+}
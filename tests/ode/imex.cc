@@ -0,0 +1,66 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "split-problem.h"
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+  initial_condition[1] = 0.5;
+
+  for (const double stiffness : {3.0, 1000.0})
+    {
+      Vector<double> reference_solution(initial_condition);
+      {
+        ODE::RungeKutta4<double> rk_method
+        (std::unique_ptr<ODE::OperatorBase<double>>(new SplitProblem(stiffness)));
+        Vector<double> temp(2);
+        for (unsigned int step_n = 0; step_n < 10000; ++step_n)
+          {
+            rk_method.step(1.0e-4, reference_solution, temp);
+            reference_solution = temp;
+          }
+      }
+
+      for (const ODE::IMEXScheme scheme :
+           {ODE::IMEXScheme::ARS222, ODE::IMEXScheme::ARS443})
+        {
+          double errors[2];
+          for (unsigned int refinement_n = 0; refinement_n < 2; ++refinement_n)
+            {
+              ODE::IMEXRungeKutta rk_method
+              (std::unique_ptr<ODE::OperatorBase<double>>(new SplitProblem(stiffness)),
+               scheme);
+              errors[refinement_n] = error(rk_method, 20*(refinement_n + 1),
+                                           initial_condition, reference_solution);
+            }
+
+          if (stiffness == 3.0)
+            {
+              // the expected orders of convergence
+              const double expected_ratio
+                = scheme == ODE::IMEXScheme::ARS222 ? 4.0 : 8.0;
+              if (errors[0]/errors[1] < 0.75*expected_ratio)
+                {
+                  return 1;
+                }
+            }
+          // the time steps are far beyond the explicit stability limit
+          else if (errors[1] > 5.0e-3)
+            {
+              return 1;
+            }
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "problems.h"
+
+// Integrate to t = 1 and return the error.
+double error(POD::ODE::RungeKuttaBase<double> &rk_method, const unsigned int n_steps,
+             const dealii::Vector<double> &initial_condition,
+             const dealii::Vector<double> &reference_solution)
+{
+  dealii::Vector<double> solution(initial_condition);
+  dealii::Vector<double> temp(solution.size());
+  for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+    {
+      rk_method.step(1.0/n_steps, solution, temp);
+      solution = temp;
+    }
+  solution -= reference_solution;
+  return solution.linfty_norm();
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+  initial_condition[1] = 2.0;
+
+  // RK4 is only stable for time steps below about 2.8e-3.
+  Vector<double> reference_solution(initial_condition);
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new StiffProblem()));
+    Vector<double> temp(2);
+    for (unsigned int step_n = 0; step_n < 10000; ++step_n)
+      {
+        rk_method.step(1.0e-4, reference_solution, temp);
+        reference_solution = temp;
+      }
+  }
+
+  for (unsigned int method_n = 0; method_n < 2; ++method_n)
+    {
+      double errors[2];
+      for (unsigned int refinement_n = 0; refinement_n < 2; ++refinement_n)
+        {
+          std::unique_ptr<ODE::ImplicitIntegratorBase> rk_method;
+          if (method_n == 0)
+            {
+              rk_method.reset(new ODE::CrankNicolson
+                              (std::unique_ptr<ODE::JacobianOperator<double>>
+                               (new StiffProblem())));
+            }
+          else
+            {
+              rk_method.reset(new ODE::BDF2
+                              (std::unique_ptr<ODE::JacobianOperator<double>>
+                               (new StiffProblem())));
+            }
+          // time steps of 0.02 and 0.01
+          const unsigned int n_steps = 50*(refinement_n + 1);
+          errors[refinement_n] = error(*rk_method, n_steps, initial_condition,
+                                       reference_solution);
+          // the Jacobian is reused between steps
+          if (rk_method->n_jacobian_evaluations() >= n_steps/2)
+            {
+              return 1;
+            }
+        }
+      // second order convergence
+      if (errors[1] > 1.0e-3 or errors[0]/errors[1] < 3.0)
+        {
+          return 1;
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "problems.h"
+
+// an undamped oscillator with frequency omega.
+class Oscillator : public POD::ODE::OperatorBase<double>
+{
+public:
+  Oscillator(const double omega)
+    : omega {omega}
+  {}
+
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = omega*src[1];
+    dst[1] = -omega*src[0];
+  }
+
+private:
+  const double omega;
+};
+
+
+// Integrate to t = end_time and return the solution.
+dealii::Vector<double> integrate(POD::ODE::RungeKuttaBase<double> &rk_method,
+                                 const double end_time,
+                                 const unsigned int n_steps,
+                                 const dealii::Vector<double> &initial_condition)
+{
+  dealii::Vector<double> solution(initial_condition);
+  for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+    {
+      rk_method.step(end_time/n_steps, solution, solution);
+    }
+  return solution;
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 1.0;
+
+  Vector<double> reference_solution;
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new Pendulum()));
+    reference_solution = integrate(rk_method, 2.0, 20000, initial_condition);
+  }
+
+  for (const ODE::LowStorageScheme scheme :
+       {ODE::LowStorageScheme::Williamson3,
+        ODE::LowStorageScheme::CarpenterKennedy4})
+    {
+      double errors[2];
+      for (unsigned int refinement_n = 0; refinement_n < 2; ++refinement_n)
+        {
+          ODE::LowStorageRungeKutta rk_method
+          (std::unique_ptr<ODE::OperatorBase<double>>(new Pendulum()), scheme);
+          Vector<double> solution = integrate
+            (rk_method, 2.0, 20*(refinement_n + 1), initial_condition);
+          solution -= reference_solution;
+          errors[refinement_n] = solution.linfty_norm();
+        }
+      const double expected_ratio
+        = scheme == ODE::LowStorageScheme::Williamson3 ? 8.0 : 16.0;
+      if (errors[0]/errors[1] < 0.75*expected_ratio)
+        {
+          return 1;
+        }
+    }
+
+  // h omega = 3 is outside the stability region of RK4 but inside that of the
+  // five stage scheme.
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new Oscillator(3.0)));
+    ODE::LowStorageRungeKutta low_storage_rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new Oscillator(3.0)),
+     ODE::LowStorageScheme::CarpenterKennedy4);
+    if (integrate(rk_method, 100.0, 100, initial_condition).linfty_norm() < 1.0
+        or integrate(low_storage_rk_method, 100.0, 100,
+                     initial_condition).linfty_norm() > 1.0)
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <deal.II/base/exceptions.h>
+
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+
+#include <deal.II-pod/ode/ode.h>
+
+#include "problems.h"
+
+// one slow and two fast components:
+//
+// y_0' = -y_0/2 + y_1 y_2/10
+// y_1' = -100 y_1 + 20 y_2 + sin(y_0)
+// y_2' = -20 y_1 - 100 y_2 + y_0^2
+class SlowFastProblem : public POD::ODE::OperatorBase<double>,
+  public POD::ODE::PartitionedOperator<double>
+{
+public:
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = -0.5*src[0] + 0.1*src[1]*src[2];
+    freeze_slow_part(src, 1);
+    apply_fast_part(dst, src);
+  }
+
+  virtual void freeze_slow_part(const dealii::Vector<double> &src,
+                                const unsigned int n_slow) override
+  {
+    (void)n_slow;
+    forcing_1 = std::sin(src[0]);
+    forcing_2 = src[0]*src[0];
+  }
+
+  virtual void apply_fast_part(dealii::Vector<double> &dst,
+                               const dealii::Vector<double> &src) override
+  {
+    dst[1] = -100.0*src[1] + 20.0*src[2] + forcing_1;
+    dst[2] = -20.0*src[1] - 100.0*src[2] + forcing_2;
+  }
+
+private:
+  double forcing_1;
+  double forcing_2;
+};
+
+
+// Integrate to t = 1 and return the error.
+double error(POD::ODE::RungeKuttaBase<double> &rk_method, const unsigned int n_steps,
+             const dealii::Vector<double> &initial_condition,
+             const dealii::Vector<double> &reference_solution)
+{
+  dealii::Vector<double> solution(initial_condition);
+  for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+    {
+      rk_method.step(1.0/n_steps, solution, solution);
+    }
+  solution -= reference_solution;
+  return solution.linfty_norm();
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  // a right hand side that cannot be partitioned is rejected when the
+  // integrator is built
+  {
+    bool rejected = false;
+    try
+      {
+        ODE::MultirateRungeKutta
+        (std::unique_ptr<ODE::OperatorBase<double>>(new Pendulum()), 1, 10);
+      }
+    catch (const ExceptionBase &)
+      {
+        rejected = true;
+      }
+    if (!rejected)
+      {
+        return 1;
+      }
+  }
+
+  Vector<double> initial_condition(3);
+  initial_condition[0] = 1.0;
+  initial_condition[1] = 0.01;
+
+  Vector<double> reference_solution(initial_condition);
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new SlowFastProblem()));
+    Vector<double> temp(3);
+    for (unsigned int step_n = 0; step_n < 100000; ++step_n)
+      {
+        rk_method.step(1.0e-5, reference_solution, temp);
+        reference_solution = temp;
+      }
+  }
+
+  // RK4 is unstable with a time step of 1/20 (the fast eigenvalues are
+  // -100 +- 20i) but the multirate method is not, since it takes ten
+  // substeps for the fast components.
+  {
+    ODE::RungeKutta4<double> rk_method
+    (std::unique_ptr<ODE::OperatorBase<double>>(new SlowFastProblem()));
+    Vector<double> solution(initial_condition);
+    for (unsigned int step_n = 0; step_n < 20; ++step_n)
+      {
+        rk_method.step(1.0/20, solution, solution);
+      }
+    // the solution either overflows or is very large
+    if (std::isfinite(solution.l2_norm()) and solution.l2_norm() < 1.0e3)
+      {
+        return 1;
+      }
+  }
+  double errors[2];
+  for (unsigned int refinement_n = 0; refinement_n < 2; ++refinement_n)
+    {
+      ODE::MultirateRungeKutta rk_method
+      (std::unique_ptr<ODE::OperatorBase<double>>(new SlowFastProblem()), 1, 10);
+      errors[refinement_n] = error(rk_method, 20*(refinement_n + 1),
+                                   initial_condition, reference_solution);
+    }
+  // at least first order convergence
+  if (errors[0] > 1.0e-3 or errors[0]/errors[1] < 1.8)
+    {
+      return 1;
+    }
+
+  return 0;
+}
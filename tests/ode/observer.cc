@@ -0,0 +1,180 @@
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <deal.II-pod/ode/observer.h>
+
+// an observer that records what it sees and asks to stop once the first
+// entry of the solution reaches a threshold.
+class Recorder : public POD::ODE::StepObserver
+{
+public:
+  Recorder(const unsigned int interval, const bool asynchronous,
+           const double threshold)
+    : POD::ODE::StepObserver(interval, asynchronous),
+      threshold {threshold},
+      stop {false}
+  {}
+
+  virtual void observe(const unsigned int step_n, const double,
+                       const dealii::Vector<double> &solution) override
+  {
+    steps.push_back(step_n);
+    values.push_back(solution[0]);
+    stop = solution[0] >= threshold;
+  }
+
+  virtual bool stop_requested() const override
+  {
+    return stop;
+  }
+
+  const double threshold;
+  bool stop;
+  std::vector<unsigned int> steps;
+  std::vector<double> values;
+};
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  constexpr unsigned int n_steps {100};
+  for (const bool asynchronous : {false, true})
+    {
+      Recorder every_step(1, asynchronous, 1.0e10);
+      Recorder every_seventh_step(7, asynchronous, 1.0e10);
+      unsigned int n_function_calls = 0;
+      ODE::FunctionStepObserver counter
+      ([&](const unsigned int, const double, const Vector<double> &)
+      {
+        ++n_function_calls;
+      }, 10);
+
+      ODE::StepObserverList observers;
+      observers.add(every_step);
+      observers.add(every_seventh_step);
+      observers.add(counter);
+
+      Vector<double> solution(1);
+      for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+        {
+          solution[0] = step_n;
+          if (observers.notify(step_n, step_n, solution))
+            {
+              return 1;
+            }
+        }
+      if (observers.finish())
+        {
+          return 1;
+        }
+
+      // every observation must be made in order and see the solution as it
+      // was when notify was called.
+      if (every_step.steps.size() != n_steps
+          or every_seventh_step.steps.size() != (n_steps + 6)/7
+          or n_function_calls != n_steps/10)
+        {
+          return 1;
+        }
+      for (unsigned int i = 0; i < every_step.steps.size(); ++i)
+        {
+          if (every_step.steps[i] != i or every_step.values[i] != i)
+            {
+              return 1;
+            }
+        }
+      for (unsigned int i = 0; i < every_seventh_step.steps.size(); ++i)
+        {
+          if (every_seventh_step.steps[i] != 7*i
+              or every_seventh_step.values[i] != 7*i)
+            {
+              return 1;
+            }
+        }
+    }
+
+  // a synchronous observer stops the loop right away; an asynchronous one may
+  // only be heard at its next observation.
+  for (const bool asynchronous : {false, true})
+    {
+      Recorder monitor(5, asynchronous, 42.0);
+      ODE::StepObserverList observers;
+      observers.add(monitor);
+
+      Vector<double> solution(1);
+      unsigned int step_n = 0;
+      for (; step_n < n_steps; ++step_n)
+        {
+          solution[0] = step_n;
+          if (observers.notify(step_n, step_n, solution))
+            {
+              break;
+            }
+        }
+      observers.finish();
+      if (step_n != (asynchronous ? 50 : 45))
+        {
+          return 1;
+        }
+    }
+
+  // the divergence monitor, with the energy 2 a_0^2 + a_1^2.
+  FullMatrix<double> mass_matrix(2, 2);
+  mass_matrix(0, 0) = 2.0;
+  mass_matrix(1, 1) = 1.0;
+  Vector<double> solution(2);
+  solution[0] = 3.0;
+  solution[1] = -4.0;
+  {
+    // with both thresholds disabled only a non-finite entry stops the run
+    ODE::DivergenceMonitor monitor(mass_matrix, 0.0, 0.0);
+    monitor.observe(0, 0.0, solution);
+    if (monitor.stop_requested())
+      {
+        return 1;
+      }
+    solution[1] = std::numeric_limits<double>::quiet_NaN();
+    monitor.observe(1, 0.1, solution);
+    if (!monitor.stop_requested())
+      {
+        return 1;
+      }
+    solution[1] = -4.0;
+  }
+  {
+    ODE::DivergenceMonitor monitor(mass_matrix, 30.0, 0.0);
+    monitor.observe(3, 0.3, solution);
+    std::ostringstream diagnostics;
+    monitor.print_diagnostics(diagnostics);
+    if (!monitor.stop_requested()
+        or diagnostics.str().find("energy above threshold") == std::string::npos
+        or diagnostics.str().find("step: 3") == std::string::npos)
+      {
+        return 1;
+      }
+  }
+  {
+    ODE::DivergenceMonitor monitor(mass_matrix, 100.0, 4.5);
+    monitor.observe(0, 0.0, solution);
+    if (monitor.stop_requested())
+      {
+        return 1;
+      }
+    solution[1] = -5.0;
+    monitor.observe(1, 0.1, solution);
+    if (!monitor.stop_requested())
+      {
+        return 1;
+      }
+  }
+
+  return 0;
+}
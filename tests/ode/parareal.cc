@@ -0,0 +1,86 @@
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <deal.II-pod/ode/ode.h>
+#include <deal.II-pod/ode/parareal.h>
+
+#include "problems.h"
+
+
+std::unique_ptr<POD::ODE::RungeKuttaBase<double>> create_integrator()
+{
+  return std::unique_ptr<POD::ODE::RungeKuttaBase<double>>
+    (new POD::ODE::RungeKutta4<double>
+     (std::unique_ptr<POD::ODE::OperatorBase<double>>(new Pendulum())));
+}
+
+
+int main()
+{
+  using namespace dealii;
+  using namespace POD;
+
+  Vector<double> initial_condition(2);
+  initial_condition[0] = 2.0;
+  constexpr double time_step {1.0e-3};
+  constexpr unsigned int n_steps {10000};
+  constexpr unsigned int output_interval {100};
+
+  // the serial fine solution
+  std::vector<Vector<double>> serial_outputs;
+  Vector<double> serial_solution(initial_condition);
+  {
+    std::unique_ptr<ODE::RungeKuttaBase<double>> rk_method = create_integrator();
+    Vector<double> temp(2);
+    for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+      {
+        rk_method->step(time_step, serial_solution, temp);
+        serial_solution = temp;
+        if (step_n % output_interval == 0)
+          {
+            serial_outputs.push_back(serial_solution);
+          }
+      }
+  }
+
+  constexpr unsigned int n_slices {10};
+  for (const double tolerance : {1.0e-10, 0.0})
+    {
+      ODE::Parareal parareal(create_integrator, 0.1, create_integrator,
+                             n_slices, tolerance);
+      Vector<double> solution;
+      std::vector<Vector<double>> outputs;
+      parareal.run(time_step, n_steps, output_interval, initial_condition,
+                   solution, outputs);
+
+      // with a zero tolerance every slice is corrected, which reproduces the
+      // serial solution; otherwise it should converge early.
+      if ((tolerance == 0.0 and parareal.n_iterations() != n_slices)
+          or (tolerance != 0.0 and parareal.n_iterations() >= n_slices/2))
+        {
+          return 1;
+        }
+      if (outputs.size() != serial_outputs.size())
+        {
+          return 1;
+        }
+      solution -= serial_solution;
+      if (solution.linfty_norm() > 1.0e-8)
+        {
+          return 1;
+        }
+      for (unsigned int output_n = 0; output_n < outputs.size(); ++output_n)
+        {
+          outputs[output_n] -= serial_outputs[output_n];
+          if (outputs[output_n].linfty_norm() > 1.0e-8)
+            {
+              return 1;
+            }
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef dealii__rom_tests_ode_problems_h
+#define dealii__rom_tests_ode_problems_h
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+
+#include <deal.II-pod/ode/ode.h>
+
+// a stiff problem: u' = -u, v' = -1000 (v - u^2).
+class StiffProblem : public POD::ODE::JacobianOperator<double>
+{
+public:
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = -src[0];
+    dst[1] = -1000.0*(src[1] - src[0]*src[0]);
+  }
+
+  virtual void compute_jacobian(dealii::FullMatrix<double> &jacobian,
+                                const dealii::Vector<double> &src) override
+  {
+    jacobian.reinit(2, 2);
+    jacobian(0, 0) = -1.0;
+    jacobian(1, 0) = 2000.0*src[0];
+    jacobian(1, 1) = -1000.0;
+  }
+};
+
+
+// a nonlinear pendulum: u' = v, v' = -sin(u).
+class Pendulum : public POD::ODE::OperatorBase<double>
+{
+public:
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    dst[0] = src[1];
+    dst[1] = -std::sin(src[0]);
+  }
+};
+#endif
@@ -0,0 +1,64 @@
+#ifndef dealii__rom_tests_ode_split_problem_h
+#define dealii__rom_tests_ode_split_problem_h
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <cmath>
+
+#include <deal.II-pod/ode/ode.h>
+
+// y' = A y + g(y) with g(y) = (sin(y_1), y_0^2/2).
+class SplitProblem : public POD::ODE::OperatorBase<double>,
+  public POD::ODE::SplitOperator<double>
+{
+public:
+  SplitProblem(const double stiffness)
+    : linear_part(2, 2)
+  {
+    linear_part(0, 0) = -2.0;
+    linear_part(0, 1) = 1.0;
+    linear_part(1, 0) = 0.5;
+    linear_part(1, 1) = -stiffness;
+  }
+
+  virtual void apply(dealii::Vector<double> &dst,
+                     const dealii::Vector<double> &src) override
+  {
+    apply_nonlinear_part(dst, src);
+    linear_part.vmult_add(dst, src);
+  }
+
+  virtual const dealii::FullMatrix<double> &get_linear_part() const override
+  {
+    return linear_part;
+  }
+
+  virtual void apply_nonlinear_part(dealii::Vector<double> &dst,
+                                    const dealii::Vector<double> &src) override
+  {
+    dst[0] = std::sin(src[1]);
+    dst[1] = 0.5*src[0]*src[0];
+  }
+
+private:
+  dealii::FullMatrix<double> linear_part;
+};
+
+
+// Integrate to t = 1 and return the error.
+inline double error(POD::ODE::RungeKuttaBase<double> &rk_method,
+                    const unsigned int n_steps,
+                    const dealii::Vector<double> &initial_condition,
+                    const dealii::Vector<double> &reference_solution)
+{
+  dealii::Vector<double> solution(initial_condition);
+  dealii::Vector<double> temp(solution.size());
+  for (unsigned int step_n = 0; step_n < n_steps; ++step_n)
+    {
+      rk_method.step(1.0/n_steps, solution, temp);
+      solution = temp;
+    }
+  solution -= reference_solution;
+  return solution.linfty_norm();
+}
+#endif
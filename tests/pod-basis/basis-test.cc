@@ -171,8 +171,7 @@ void test_reduced_gradient_linearization
 
   FullMatrix<double> gradient;
   create_reduced_gradient_linearization
-  (dof_handler, sparsity_pattern, quad, pod_vectors.at(0),
-   pod_vectors, gradient);
+  (dof_handler, quad, pod_vectors.at(0), pod_vectors, gradient);
 
   FullMatrix<double> gradient2(n_pod_vectors, n_pod_vectors);
   for (unsigned int i = 0; i < n_pod_vectors; ++i)